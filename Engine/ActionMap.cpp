@@ -0,0 +1,288 @@
+#include "ActionMap.h"
+
+// Assertions
+#include "AssertionManager.h"
+
+// Lowest set bit of the trigger masks
+#include "BitScan.h"
+
+// memset
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+const float ActionMap::DEFAULT_AXIS_THRESHOLD = 0.5f;
+
+/**********************************************************************************************************************/
+
+ActionMap::ActionMap( void )
+  : mDown(0), mPreviousDown(0), mAxisThreshold(DEFAULT_AXIS_THRESHOLD)
+{
+  memset( mValues, 0, sizeof( mValues ) );
+  Compile();
+  Reset();
+}
+
+/**********************************************************************************************************************/
+
+ActionMap::ActionId ActionMap::AddAction( const char *name )
+{
+  const ActionId existing = FindAction( name );
+  if( existing != INVALID_ACTION ){
+    return existing;
+  }
+
+  AssertMessage( mNames.size() < MAX_ACTIONS, "Too many actions" );
+  if( mNames.size() >= MAX_ACTIONS ){
+    return INVALID_ACTION;
+  }
+  mNames.push_back( name );
+  return static_cast<ActionId>( mNames.size() - 1 );
+}
+
+/**********************************************************************************************************************/
+
+ActionMap::ActionId ActionMap::FindAction( const char *name ) const
+{
+  for( size_t i = 0; i < mNames.size(); ++i ){
+    if( mNames[i] == name ){
+      return static_cast<ActionId>( i );
+    }
+  }
+  return INVALID_ACTION;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::BindKey( SDL_Scancode scancode, ActionId action )
+{
+  AssertMessage( scancode >= 0 && scancode < SDL_NUM_SCANCODES, "Invalid scancode" );
+  Bind( DEVICE_KEY, static_cast<Uint16>( scancode ), 1, action );
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::BindMouseButton( Uint8 button, ActionId action )
+{
+  AssertMessage( button < 64, "Invalid mouse button" );
+  Bind( DEVICE_MOUSE_BUTTON, button, 1, action );
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::BindControllerButton( SDL_GameControllerButton button, ActionId action )
+{
+  AssertMessage( button >= 0 && button < SDL_CONTROLLER_BUTTON_MAX, "Invalid controller button" );
+  Bind( DEVICE_CONTROLLER_BUTTON, static_cast<Uint16>( button ), 1, action );
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::BindControllerAxis( SDL_GameControllerAxis axis, bool positive, ActionId action )
+{
+  AssertMessage( axis >= 0 && axis < SDL_CONTROLLER_AXIS_MAX, "Invalid controller axis" );
+  Bind( DEVICE_CONTROLLER_AXIS, static_cast<Uint16>( axis ), positive ? 1 : -1, action );
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Unbind( ActionId action )
+{
+  size_t kept = 0;
+  for( size_t i = 0; i < mBindings.size(); ++i ){
+    if( action != INVALID_ACTION && mBindings[i].mAction != action ){
+      mBindings[kept++] = mBindings[i];
+    }
+  }
+  mBindings.resize( kept );
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Compile( void )
+{
+  memset( mKeyMasks, 0, sizeof( mKeyMasks ) );
+  memset( mMouseMasks, 0, sizeof( mMouseMasks ) );
+  memset( mButtonMasks, 0, sizeof( mButtonMasks ) );
+  mAxes.clear();
+
+  for( size_t i = 0; i < mBindings.size(); ++i ){
+    const Binding &binding  = mBindings[i];
+    const Uint64   mask     = static_cast<Uint64>( 1 ) << binding.mAction;
+    switch( binding.mDevice ){
+    case DEVICE_KEY:
+      mKeyMasks[binding.mInput] |= mask;
+      break;
+    case DEVICE_MOUSE_BUTTON:
+      mMouseMasks[binding.mInput] |= mask;
+      break;
+    case DEVICE_CONTROLLER_BUTTON:
+      mButtonMasks[binding.mInput] |= mask;
+      break;
+    case DEVICE_CONTROLLER_AXIS:
+      {
+        AxisEntry entry;
+        entry.mMask   = mask;
+        entry.mAction = binding.mAction;
+        entry.mAxis   = binding.mInput;
+        entry.mSign   = binding.mSign;
+        mAxes.push_back( entry );
+      }
+      break;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+bool ActionMap::HandleEvent( const SDL_Event &event )
+{
+  switch( event.type ){
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    SetKey( event.key.keysym.scancode, event.type == SDL_KEYDOWN );
+    return true;
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    SetMouseButton( event.button.button, event.type == SDL_MOUSEBUTTONDOWN );
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::SetKey( SDL_Scancode scancode, bool down )
+{
+  if( scancode < 0 || scancode >= SDL_NUM_SCANCODES ){
+    return;
+  }
+  const Uint64 bit = static_cast<Uint64>( 1 ) << ( scancode & 63 );
+  mKeysDown[scancode >> 6] = down ? mKeysDown[scancode >> 6] | bit : mKeysDown[scancode >> 6] & ~bit;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::SetMouseButton( Uint8 button, bool down )
+{
+  if( button >= 64 ){
+    return;
+  }
+  const Uint64 bit = static_cast<Uint64>( 1 ) << button;
+  mMouseDown = down ? mMouseDown | bit : mMouseDown & ~bit;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::SetControllerButton( SDL_GameControllerButton button, bool down )
+{
+  if( button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX ){
+    return;
+  }
+  const Uint64 bit = static_cast<Uint64>( 1 ) << button;
+  mButtonsDown = down ? mButtonsDown | bit : mButtonsDown & ~bit;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::SetControllerAxis( SDL_GameControllerAxis axis, float value )
+{
+  if( axis < 0 || axis >= SDL_CONTROLLER_AXIS_MAX ){
+    return;
+  }
+  mAxisValues[axis] = value;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Update( void )
+{
+  // Only the inputs held down are visited, whatever the number of bindings
+  Uint64 down = GatherMasks( mKeysDown, KEY_WORDS, mKeyMasks ) | GatherMasks( &mMouseDown, 1, mMouseMasks ) |
+                GatherMasks( &mButtonsDown, 1, mButtonMasks );
+
+  const Uint32 actionCount = static_cast<Uint32>( mNames.size() );
+  for( Uint32 i = 0; i < actionCount; ++i ){
+    mValues[i] = static_cast<float>( down >> i & 1 );
+  }
+
+  // Half axes raise the value of their action to the deflection, selects rather than branches
+  for( size_t i = 0; i < mAxes.size(); ++i ){
+    const AxisEntry &axis   = mAxes[i];
+    const float      value  = mAxisValues[axis.mAxis] * axis.mSign;
+    float           &target = mValues[axis.mAction];
+    target  = value > target ? value : target;
+    down   |= value > mAxisThreshold ? axis.mMask : 0;
+  }
+  QuantizeValues();
+
+  mPreviousDown = mDown;
+  mDown         = down;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Reset( void )
+{
+  // Actions keep their state until the next Update, which then reports them released
+  memset( mKeysDown, 0, sizeof( mKeysDown ) );
+  memset( mAxisValues, 0, sizeof( mAxisValues ) );
+  mMouseDown    = 0;
+  mButtonsDown  = 0;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Apply( Uint64 down, const float *values, Uint32 count )
+{
+  AssertMessage( count <= MAX_ACTIONS, "Too many action values" );
+  memcpy( mValues, values, count * sizeof( float ) );
+  QuantizeValues();
+  mPreviousDown = mDown;
+  mDown         = down;
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::QuantizeValues( void )
+{
+  // Values are in [-1, 1], where 16.16 fixed point numbers are exact floats: quantizing twice changes nothing
+  const Uint32 actionCount = static_cast<Uint32>( mNames.size() );
+  for( Uint32 i = 0; i < actionCount; ++i ){
+    mFixedValues[i] = Fixed::FromFloat( mValues[i] );
+    mValues[i]      = mFixedValues[i].ToFloat();
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ActionMap::Bind( Device device, Uint16 input, Sint8 sign, ActionId action )
+{
+  AssertMessage( action < mNames.size(), "Binding an unknown action" );
+  if( action >= mNames.size() ){
+    return;
+  }
+
+  Binding binding;
+  binding.mAction = action;
+  binding.mInput  = input;
+  binding.mDevice = static_cast<Uint8>( device );
+  binding.mSign   = sign;
+  mBindings.push_back( binding );
+}
+
+/**********************************************************************************************************************/
+
+Uint64 ActionMap::GatherMasks( const Uint64 *bits, Uint32 wordCount, const Uint64 *masks )
+{
+  Uint64 result = 0;
+  for( Uint32 w = 0; w < wordCount; ++w ){
+    for( Uint64 word = bits[w]; word != 0; word &= word - 1 ){
+      result |= masks[w * 64 + LowestBit( word )];
+    }
+  }
+  return result;
+}
+
+/**********************************************************************************************************************/
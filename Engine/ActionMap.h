@@ -0,0 +1,251 @@
+#ifndef ACTIONMAP_H
+#define ACTIONMAP_H
+
+// Events, scancodes and controller enums
+#include <SDL.h>
+
+// Quantized action values
+#include "FixedPoint.h"
+
+// Action names and bindings
+#include <string>
+#include <vector>
+
+/**
+Action map class
+Maps keys, mouse buttons and game controller buttons and axes to named actions, so gameplay asks for "MoveLeft"
+instead of a key and rebinding never touches gameplay code. Bindings are edited freely and then compiled into dense
+tables with one entry per input: the mask of the actions it drives. Events only set bits in the raw input state, and
+Update turns the state into actions once per frame by OR-ing the masks of the inputs held down, without branching on
+bindings or allocating. Every action has a digital state and a value in [0, 1]: 1 while a button is held, the deflection
+for controller half axes. Values are quantized to 16.16 fixed point as soon as they are computed: deterministic
+simulations read GetFixedValue and never convert floats themselves, and the float value is the same number, so a
+replay applying recorded values gets the same fixed values back
+*/
+class ActionMap
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  typedef Uint32 ActionId;
+
+  static const Uint32   MAX_ACTIONS           = 64;           ///< Actions fit in one mask
+  static const ActionId INVALID_ACTION        = 0xFFFFFFFF;   ///< Id that never references an action
+  static const float    DEFAULT_AXIS_THRESHOLD;               ///< Half axis value above which the action is down
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Input device of a binding
+  */
+  enum Device
+  {
+    DEVICE_KEY,
+    DEVICE_MOUSE_BUTTON,
+    DEVICE_CONTROLLER_BUTTON,
+    DEVICE_CONTROLLER_AXIS
+  };
+
+  /**
+  Editable binding, compiled into the tables
+  */
+  struct Binding
+  {
+    ActionId  mAction;    ///< Driven action
+    Uint16    mInput;     ///< Scancode, mouse button, controller button or controller axis
+    Uint8     mDevice;    ///< Device
+    Sint8     mSign;      ///< Half of a controller axis: 1 positive, -1 negative
+  };
+
+  /**
+  Compiled controller half axis
+  */
+  struct AxisEntry
+  {
+    Uint64    mMask;      ///< Bit of the driven action
+    ActionId  mAction;    ///< Driven action
+    Uint32    mAxis;      ///< SDL_GameControllerAxis
+    float     mSign;      ///< 1 for the positive half, -1 for the negative one
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  ActionMap( void );
+
+  /**
+  Adds an action, or returns the existing one with that name
+  @param name Action name
+  @return Action id, INVALID_ACTION when MAX_ACTIONS are defined
+  */
+  ActionId AddAction( const char *name );
+
+  /**
+  Returns the action with a name, or INVALID_ACTION
+  */
+  ActionId FindAction( const char *name ) const;
+
+  /**
+  Bindings. An input may drive several actions and an action may have several inputs. Take effect on Compile
+  */
+  void BindKey( SDL_Scancode scancode, ActionId action );
+  void BindMouseButton( Uint8 button, ActionId action );
+  void BindControllerButton( SDL_GameControllerButton button, ActionId action );
+
+  /**
+  Binds half of a controller axis
+  @param axis Controller axis
+  @param positive True for the half from the center to the maximum, false for the other one
+  @param action Action whose value follows the deflection
+  */
+  void BindControllerAxis( SDL_GameControllerAxis axis, bool positive, ActionId action );
+
+  /**
+  Removes every binding of an action, or every binding with INVALID_ACTION. Takes effect on Compile
+  */
+  void Unbind( ActionId action = INVALID_ACTION );
+
+  /**
+  Builds the lookup tables from the bindings
+  */
+  void Compile( void );
+
+  /**
+  Updates the raw input state from a keyboard or mouse event. Events of other kinds are ignored, controller events
+  are filtered by ControllerManager, which writes them through the controller setters
+  @param event Any SDL event
+  @return True if the event was a keyboard or mouse input event
+  */
+  bool HandleEvent( const SDL_Event &event );
+
+  /**
+  Raw state setters, for input sources other than events. Controller axis values range from -1 to 1, after any dead
+  zone or response curve
+  */
+  void SetKey( SDL_Scancode scancode, bool down );
+  void SetMouseButton( Uint8 button, bool down );
+  void SetControllerButton( SDL_GameControllerButton button, bool down );
+  void SetControllerAxis( SDL_GameControllerAxis axis, float value );
+
+  /**
+  Computes the actions from the raw input state. Call once per frame after the events
+  */
+  void Update( void );
+
+  /**
+  Releases every input, for example when the window loses the focus. The next Update reports the releases
+  */
+  void Reset( void );
+
+  /**
+  Sets the actions directly instead of computing them from the input, for replays. Counts as an Update
+  @param down Bit per action down
+  @param values Value per action
+  @param count Number of values
+  */
+  void Apply( Uint64 down, const float *values, Uint32 count );
+
+  /**
+  Action queries, from the last Update. WasPressed and WasReleased compare with the Update before
+  */
+  inline bool IsDown( ActionId action ) const {
+    return ( mDown >> action & 1 ) != 0;
+  }
+  inline bool WasPressed( ActionId action ) const {
+    return ( ( mDown & ~mPreviousDown ) >> action & 1 ) != 0;
+  }
+  inline bool WasReleased( ActionId action ) const {
+    return ( ( mPreviousDown & ~mDown ) >> action & 1 ) != 0;
+  }
+  inline float GetValue( ActionId action ) const {
+    return mValues[action];
+  }
+  inline Fixed GetFixedValue( ActionId action ) const {
+    return mFixedValues[action];
+  }
+  inline Uint64 GetDownMask( void ) const {
+    return mDown;
+  }
+
+  /**
+  Getters
+  */
+  inline Uint32 GetActionCount( void ) const {
+    return static_cast<Uint32>( mNames.size() );
+  }
+  inline const std::string &GetActionName( ActionId action ) const {
+    return mNames[action];
+  }
+
+  /**
+  Threshold setter, for digital actions bound to axes
+  */
+  inline void SetAxisThreshold( float threshold ){
+    mAxisThreshold = threshold;
+  }
+
+private:
+
+  /**
+  Adds a binding
+  */
+  void Bind( Device device, Uint16 input, Sint8 sign, ActionId action );
+
+  /**
+  Quantizes the action values to fixed point, and the float values to match
+  */
+  void QuantizeValues( void );
+
+  /**
+  OR of the masks of the set bits
+  @param bits Bitset of pressed inputs
+  @param wordCount Words in the bitset
+  @param masks Mask of every input
+  */
+  static Uint64 GatherMasks( const Uint64 *bits, Uint32 wordCount, const Uint64 *masks );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  static const Uint32 KEY_WORDS = ( SDL_NUM_SCANCODES + 63 ) / 64;
+
+  // Compiled tables, indexed by scancode, mouse button and controller button
+  Uint64                    mKeyMasks[KEY_WORDS * 64];              ///< Actions of every scancode
+  Uint64                    mMouseMasks[64];                        ///< Actions of every mouse button
+  Uint64                    mButtonMasks[64];                       ///< Actions of every controller button
+  std::vector<AxisEntry>    mAxes;                                  ///< Bound half axes
+
+  // Raw input state
+  Uint64                    mKeysDown[KEY_WORDS];                   ///< Bit per scancode
+  Uint64                    mMouseDown;                             ///< Bit per mouse button
+  Uint64                    mButtonsDown;                           ///< Bit per controller button
+  float                     mAxisValues[SDL_CONTROLLER_AXIS_MAX];   ///< -1..1 per controller axis
+
+  // Actions
+  Uint64                    mDown;                                  ///< Bit per action down
+  Uint64                    mPreviousDown;                          ///< mDown of the Update before
+  float                     mValues[MAX_ACTIONS];                   ///< Value per action
+  Fixed                     mFixedValues[MAX_ACTIONS];              ///< mValues in fixed point
+  float                     mAxisThreshold;                         ///< Half axis value making an action down
+
+  std::vector<std::string>  mNames;                                 ///< Action names by id
+  std::vector<Binding>      mBindings;                              ///< Editable bindings
+};
+
+/**********************************************************************************************************************/
+
+#endif
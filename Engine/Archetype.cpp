@@ -0,0 +1,190 @@
+#include "Archetype.h"
+
+// Layout checks
+#include "AssertionManager.h"
+
+// memcpy, memset
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+// Rounds an offset up to an alignment (power of two)
+static inline size_t AlignUp( size_t offset, size_t alignment )
+{
+  return ( offset + alignment - 1 ) & ~( alignment - 1 );
+}
+
+/**********************************************************************************************************************/
+
+Archetype::Archetype( ComponentMask mask )
+  : mMask(mask), mCapacity(0), mEntityCount(0)
+{
+  memset( mTypeToIndex, -1, sizeof(mTypeToIndex) );
+  mSpareChunk.mData       = NULL;
+  mSpareChunk.mAllocation = NULL;
+  mSpareChunk.mCount      = 0;
+
+  size_t rowSize = sizeof(Entity);
+  for( ComponentTypeId type = 0; type < ComponentRegistry::MAX_COMPONENT_TYPES; ++type ){
+    if( mask & ( static_cast<ComponentMask>( 1 ) << type ) ){
+      mTypeToIndex[type] = static_cast<signed char>( mTypes.size() );
+      mTypes.push_back( type );
+      mSizes.push_back( ComponentRegistry::GetInfo( type ).mSize );
+      rowSize += ComponentRegistry::GetInfo( type ).mSize;
+    }
+  }
+  mOffsets.resize( mTypes.size() );
+
+  // Start from the unpadded estimate and shrink until the aligned arrays fit in a chunk
+  for( mCapacity = static_cast<Uint32>( CHUNK_SIZE / rowSize ); mCapacity > 0; --mCapacity ){
+    size_t offset = sizeof(Entity) * mCapacity;
+    for( size_t i = 0; i < mTypes.size(); ++i ){
+      offset      = AlignUp( offset, ComponentRegistry::GetInfo( mTypes[i] ).mAlignment );
+      mOffsets[i] = offset;
+      offset     += mSizes[i] * mCapacity;
+    }
+    if( offset <= CHUNK_SIZE ){
+      break;
+    }
+  }
+  AssertMessage( mCapacity > 0, "Archetype components do not fit in a chunk" );
+}
+
+/**********************************************************************************************************************/
+
+Archetype::~Archetype( void )
+{
+  for( size_t i = 0; i < mChunks.size(); ++i ){
+    delete[] mChunks[i].mAllocation;
+  }
+  delete[] mSpareChunk.mAllocation;
+}
+
+/**********************************************************************************************************************/
+
+void Archetype::AddRow( Entity entity, Uint32 &chunk, Uint32 &row )
+{
+  if( mChunks.empty() || mChunks.back().mCount == mCapacity ){
+    AllocateChunk();
+  }
+
+  chunk = static_cast<Uint32>( mChunks.size() - 1 );
+  row   = mChunks[chunk].mCount++;
+  ++mEntityCount;
+
+  Uint8 *data = mChunks[chunk].mData;
+  reinterpret_cast<Entity*>( data )[row] = entity;
+  for( size_t i = 0; i < mTypes.size(); ++i ){
+    memset( data + mOffsets[i] + row * mSizes[i], 0, mSizes[i] );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void Archetype::AddRows( const Entity *entities, Uint32 count, const void *const *values, Uint32 &chunk, Uint32 &row )
+{
+  if( mChunks.empty() || mChunks.back().mCount == mCapacity ){
+    AllocateChunk();
+  }
+  chunk = static_cast<Uint32>( mChunks.size() - 1 );
+  row   = mChunks[chunk].mCount;
+
+  for( Uint32 added = 0; added < count; ){
+    if( mChunks.back().mCount == mCapacity ){
+      AllocateChunk();
+    }
+
+    Chunk        &target  = mChunks.back();
+    const Uint32  first   = target.mCount;
+    const Uint32  rows    = count - added < mCapacity - first ? count - added : mCapacity - first;
+
+    memcpy( reinterpret_cast<Entity*>( target.mData ) + first, entities + added, rows * sizeof(Entity) );
+    for( size_t i = 0; i < mTypes.size(); ++i ){
+      Uint8        *array = target.mData + mOffsets[i] + first * mSizes[i];
+      const void   *value = values != NULL ? values[mTypes[i]] : NULL;
+      if( value == NULL ){
+        memset( array, 0, rows * mSizes[i] );
+        continue;
+      }
+
+      // Copy one value, then keep doubling the initialized part
+      memcpy( array, value, mSizes[i] );
+      for( Uint32 filled = 1; filled < rows; ){
+        const Uint32 copy = filled < rows - filled ? filled : rows - filled;
+        memcpy( array + filled * mSizes[i], array, copy * mSizes[i] );
+        filled += copy;
+      }
+    }
+
+    target.mCount += rows;
+    mEntityCount  += rows;
+    added         += rows;
+  }
+}
+
+/**********************************************************************************************************************/
+
+Entity Archetype::RemoveRow( Uint32 chunk, Uint32 row )
+{
+  AssertCondition( chunk < mChunks.size() && row < mChunks[chunk].mCount );
+
+  const Uint32  lastChunk = static_cast<Uint32>( mChunks.size() - 1 );
+  const Uint32  lastRow   = mChunks[lastChunk].mCount - 1;
+  Entity        moved     = INVALID_ENTITY;
+
+  // Fill the hole with the last row so chunks stay packed
+  if( chunk != lastChunk || row != lastRow ){
+    Uint8 *destination  = mChunks[chunk].mData;
+    Uint8 *source       = mChunks[lastChunk].mData;
+
+    moved = reinterpret_cast<Entity*>( source )[lastRow];
+    reinterpret_cast<Entity*>( destination )[row] = moved;
+    for( size_t i = 0; i < mTypes.size(); ++i ){
+      memcpy( destination + mOffsets[i] + row * mSizes[i], source + mOffsets[i] + lastRow * mSizes[i], mSizes[i] );
+    }
+  }
+
+  --mEntityCount;
+  if( --mChunks[lastChunk].mCount == 0 ){
+    // Keep one empty chunk: the next AddRow would allocate it again
+    delete[] mSpareChunk.mAllocation;
+    mSpareChunk = mChunks[lastChunk];
+    mChunks.pop_back();
+  }
+  return moved;
+}
+
+/**********************************************************************************************************************/
+
+void Archetype::CopySharedComponents( const Archetype &source, Uint32 sourceChunk, Uint32 sourceRow,
+                                      Uint32 chunk, Uint32 row )
+{
+  for( size_t i = 0; i < mTypes.size(); ++i ){
+    int sourceIndex = source.GetComponentIndex( mTypes[i] );
+    if( sourceIndex >= 0 ){
+      memcpy( static_cast<Uint8*>( GetComponentArray( chunk, static_cast<int>( i ) ) ) + row * mSizes[i],
+              static_cast<Uint8*>( source.GetComponentArray( sourceChunk, sourceIndex ) ) + sourceRow * mSizes[i],
+              mSizes[i] );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void Archetype::AllocateChunk( void )
+{
+  if( mSpareChunk.mAllocation != NULL ){
+    mChunks.push_back( mSpareChunk );
+    mSpareChunk.mData       = NULL;
+    mSpareChunk.mAllocation = NULL;
+    return;
+  }
+
+  Chunk chunk;
+  chunk.mAllocation = new Uint8[CHUNK_SIZE + CHUNK_ALIGNMENT];
+  chunk.mData       = reinterpret_cast<Uint8*>( AlignUp( reinterpret_cast<size_t>( chunk.mAllocation ), CHUNK_ALIGNMENT ) );
+  chunk.mCount      = 0;
+  mChunks.push_back( chunk );
+}
+
+/**********************************************************************************************************************/
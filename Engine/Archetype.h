@@ -0,0 +1,200 @@
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+// Component types
+#include "ComponentRegistry.h"
+
+// Entity ids stored per row
+#include "Entity.h"
+
+// Chunk list
+#include <vector>
+
+/**
+Archetype class
+Stores every entity that has exactly the same set of components. Entities live in fixed-size chunks where each
+component is a contiguous array, so iterating a component over a chunk is a linear walk through memory.
+All chunks except the last one are always full. The last chunk freed is kept as a spare, so an entity count going
+back and forth across a chunk boundary does not allocate and free a chunk every time
+*/
+class Archetype
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const size_t CHUNK_SIZE      = 16 * 1024;  ///< Bytes of component data per chunk
+  static const size_t CHUNK_ALIGNMENT = 64;         ///< Chunks start on a cache line
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Fixed-size block of entities
+  */
+  struct Chunk
+  {
+    Uint8    *mData;        ///< CHUNK_SIZE bytes aligned to CHUNK_ALIGNMENT
+    Uint8    *mAllocation;  ///< Allocation holding mData
+    Uint32    mCount;       ///< Rows in use
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+  /**
+  Constructor. Computes the chunk layout for the component set
+  @param mask Components of the entities stored
+  */
+  explicit Archetype( ComponentMask mask );
+
+  /**
+  Destructor. Frees every chunk and the spare one
+  */
+  ~Archetype( void );
+
+  /**
+  Appends a row with zeroed components for an entity
+  @param entity Entity stored in the row
+  @param chunk Returns the chunk index of the new row
+  @param row Returns the row index inside the chunk
+  */
+  void AddRow( Entity entity, Uint32 &chunk, Uint32 &row );
+
+  /**
+  Appends rows for consecutive entities. Rows stay consecutive across chunks: after the last row of a chunk comes row 0
+  of the next one. Every component value is replicated with doubling memcpy calls instead of row by row
+  @param entities Entities stored in the new rows
+  @param count Number of rows
+  @param values Component values indexed by component type id, NULL entries (or a NULL array) give zeroed components
+  @param chunk Returns the chunk index of the first new row
+  @param row Returns the row index of the first new row inside its chunk
+  */
+  void AddRows( const Entity *entities, Uint32 count, const void *const *values, Uint32 &chunk, Uint32 &row );
+
+  /**
+  Removes a row by moving the last row of the archetype into it
+  @param chunk Chunk index of the row
+  @param row Row index inside the chunk
+  @return Entity moved into the removed row or INVALID_ENTITY if the removed row was the last one
+  */
+  Entity RemoveRow( Uint32 chunk, Uint32 row );
+
+  /**
+  Copies the components shared with another archetype from one row to another
+  @param source Archetype of the source row
+  @param sourceChunk Chunk of the source row
+  @param sourceRow Source row
+  @param chunk Chunk of the destination row in this archetype
+  @param row Destination row in this archetype
+  */
+  void CopySharedComponents( const Archetype &source, Uint32 sourceChunk, Uint32 sourceRow, Uint32 chunk, Uint32 row );
+
+  /**
+  Returns the index of a component inside this archetype
+  @param type Component type
+  @return Component index or -1 if the archetype does not have it
+  */
+  inline int GetComponentIndex( ComponentTypeId type ) const {
+    return mTypeToIndex[type];
+  }
+
+  /**
+  Returns the array of a component in a chunk
+  @param chunk Chunk index
+  @param componentIndex Component index as returned by GetComponentIndex
+  @return First element of the array
+  */
+  inline void *GetComponentArray( Uint32 chunk, int componentIndex ) const {
+    return mChunks[chunk].mData + mOffsets[componentIndex];
+  }
+
+  /**
+  Typed component array of a chunk. The archetype must have the component
+  */
+  template < class T >
+  inline T *GetArray( Uint32 chunk ) const {
+    typedef typename std::remove_const<T>::type ComponentT;
+    return static_cast<T*>( GetComponentArray( chunk, GetComponentIndex( ComponentType<ComponentT>::GetId() ) ) );
+  }
+
+  /**
+  Returns a single component
+  @param chunk Chunk index
+  @param row Row inside the chunk
+  @param type Component type. The archetype must have it
+  @return Component
+  */
+  inline void *GetComponent( Uint32 chunk, Uint32 row, ComponentTypeId type ) const {
+    int index = GetComponentIndex( type );
+    return static_cast<Uint8*>( GetComponentArray( chunk, index ) ) + row * mSizes[index];
+  }
+
+  /**
+  Returns the entity ids of a chunk
+  @param chunk Chunk index
+  @return Array of GetChunk(chunk).mCount entities
+  */
+  inline const Entity *GetEntities( Uint32 chunk ) const {
+    return reinterpret_cast<const Entity*>( mChunks[chunk].mData );
+  }
+
+  /**
+  Getters
+  */
+  inline ComponentMask GetMask( void ) const {
+    return mMask;
+  }
+  inline Uint32 GetChunkCapacity( void ) const {
+    return mCapacity;
+  }
+  inline Uint32 GetChunkCount( void ) const {
+    return static_cast<Uint32>( mChunks.size() );
+  }
+  inline const Chunk &GetChunk( Uint32 chunk ) const {
+    return mChunks[chunk];
+  }
+  inline size_t GetEntityCount( void ) const {
+    return mEntityCount;
+  }
+  inline const std::vector<ComponentTypeId> &GetComponentTypes( void ) const {
+    return mTypes;
+  }
+
+private:
+
+  // Non copyable: owns chunks
+  Archetype( const Archetype & );
+  Archetype &operator=( const Archetype & );
+
+  /**
+  Appends an empty chunk at the end of the chunk list, the spare one if there is one
+  */
+  void AllocateChunk( void );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  ComponentMask                 mMask;                                              ///< Components of the archetype
+  std::vector<ComponentTypeId>  mTypes;                                             ///< Component types in id order
+  std::vector<size_t>           mSizes;                                             ///< Component sizes by index
+  std::vector<size_t>           mOffsets;                                           ///< Component array offsets by index
+  signed char                   mTypeToIndex[ComponentRegistry::MAX_COMPONENT_TYPES]; ///< Component index by type or -1
+  Uint32                        mCapacity;                                          ///< Rows per chunk
+  std::vector<Chunk>            mChunks;                                            ///< Chunks, all full but the last
+  Chunk                         mSpareChunk;                                        ///< Emptied chunk kept for reuse
+  size_t                        mEntityCount;                                       ///< Rows in use
+};
+
+/**********************************************************************************************************************/
+
+#endif
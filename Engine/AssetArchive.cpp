@@ -0,0 +1,343 @@
+#include "AssetArchive.h"
+
+// Path hashing and comparison shared with the asset lookup
+#include "AssetManager.h"
+
+// Packing order
+#include <algorithm>
+
+// Largest asset SDL_RWFromConstMem can serve
+#include <climits>
+
+// File mapping
+#if defined(_WIN32)
+  #include "TypesWindows.h"
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+/**********************************************************************************************************************/
+
+static inline Uint64 AlignUp( Uint64 offset, Uint64 alignment )
+{
+  return ( offset + alignment - 1 ) & ~( alignment - 1 );
+}
+
+/**********************************************************************************************************************/
+
+/**
+Maps a whole file read only
+@param path File to map
+@param size Set to the file size
+@return Mapping, NULL on failure
+*/
+static const Uint8 *MapFile( const std::string &path, size_t &size )
+{
+#if defined(_WIN32)
+  HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                             NULL );
+  if( file == INVALID_HANDLE_VALUE ){
+    return NULL;
+  }
+
+  // The view keeps the mapping and the file open, both handles can go right away
+  LARGE_INTEGER fileSize;
+  HANDLE        mapping = NULL;
+  if( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart > 0 ){
+    mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+  }
+  CloseHandle( file );
+  if( mapping == NULL ){
+    return NULL;
+  }
+
+  const void *view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  CloseHandle( mapping );
+  size = static_cast<size_t>( fileSize.QuadPart );
+  return static_cast<const Uint8*>( view );
+#else
+  const int file = open( path.c_str(), O_RDONLY );
+  if( file < 0 ){
+    return NULL;
+  }
+
+  struct stat status;
+  void *view = MAP_FAILED;
+  if( fstat( file, &status ) == 0 && status.st_size > 0 ){
+    view = mmap( NULL, static_cast<size_t>( status.st_size ), PROT_READ, MAP_PRIVATE, file, 0 );
+  }
+  close( file );
+  if( view == MAP_FAILED ){
+    return NULL;
+  }
+
+  size = static_cast<size_t>( status.st_size );
+  return static_cast<const Uint8*>( view );
+#endif
+}
+
+/**********************************************************************************************************************/
+
+/**
+Unmaps a file mapped by MapFile
+*/
+static void UnmapFile( const Uint8 *mapping, size_t size )
+{
+#if defined(_WIN32)
+  (void)size;
+  UnmapViewOfFile( mapping );
+#else
+  munmap( const_cast<Uint8*>( mapping ), size );
+#endif
+}
+
+/**********************************************************************************************************************/
+
+AssetArchive::AssetArchive( void )
+  : mMapping(NULL), mMappingSize(0), mEntries(NULL), mEntryCount(0), mPaths(NULL)
+{
+  static_assert( sizeof( Header ) == 32 && sizeof( TocEntry ) == 32, "Archive structures are read in place" );
+}
+
+/**********************************************************************************************************************/
+
+AssetArchive::~AssetArchive( void )
+{
+  Close();
+}
+
+/**********************************************************************************************************************/
+
+bool AssetArchive::Open( const std::string &path )
+{
+  Close();
+
+  mMapping = MapFile( path, mMappingSize );
+  if( mMapping == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to map asset archive %s", path.c_str() );
+    return false;
+  }
+
+  // The TOC is used in place, which the header size keeps aligned in the page aligned mapping. A big endian host sees
+  // a wrong magic and rejects the file
+  const Header *header = reinterpret_cast<const Header*>( mMapping );
+  mEntries    = reinterpret_cast<const TocEntry*>( mMapping + sizeof( Header ) );
+  mEntryCount = mMappingSize >= sizeof( Header ) ? header->mEntryCount : 0;
+  mPaths      = mMappingSize >= sizeof( Header ) && header->mPathsOffset <= mMappingSize ?
+                reinterpret_cast<const char*>( mMapping + header->mPathsOffset ) : NULL;
+
+  if( !Validate() ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Invalid asset archive %s", path.c_str() );
+    Close();
+    return false;
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void AssetArchive::Close( void )
+{
+  if( mMapping != NULL ){
+    UnmapFile( mMapping, mMappingSize );
+  }
+  mMapping      = NULL;
+  mMappingSize  = 0;
+  mEntries      = NULL;
+  mEntryCount   = 0;
+  mPaths        = NULL;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetArchive::Find( const std::string &path, const Uint8 *&data, size_t &size ) const
+{
+  const Uint64 pathHash = AssetManager::HashPath( path );
+
+  // Binary search for the first entry with the hash, then the path tells apart the rare entries sharing it
+  Uint32 first = 0;
+  Uint32 count = mEntryCount;
+  while( count > 0 ){
+    const Uint32 half = count / 2;
+    if( mEntries[first + half].mPathHash < pathHash ){
+      first += half + 1;
+      count -= half + 1;
+    }
+    else{
+      count = half;
+    }
+  }
+
+  for( Uint32 i = first; i < mEntryCount && mEntries[i].mPathHash == pathHash; ++i ){
+    const TocEntry &entry = mEntries[i];
+    if( AssetManager::IsSamePath( std::string( mPaths + entry.mPathOffset, entry.mPathLength ), path ) ){
+      data = mMapping + entry.mOffset;
+      size = static_cast<size_t>( entry.mSize );
+      return true;
+    }
+  }
+  return false;
+}
+
+/**********************************************************************************************************************/
+
+SDL_RWops *AssetArchive::OpenAsset( const std::string &path ) const
+{
+  const Uint8  *data;
+  size_t        size;
+  if( !Find( path, data, size ) ){
+    return NULL;
+  }
+  return SDL_RWFromConstMem( data, static_cast<int>( size ) );
+}
+
+/**********************************************************************************************************************/
+
+std::string AssetArchive::GetEntryPath( Uint32 index ) const
+{
+  if( index >= mEntryCount ){
+    return std::string();
+  }
+  return std::string( mPaths + mEntries[index].mPathOffset, mEntries[index].mPathLength );
+}
+
+/**********************************************************************************************************************/
+
+bool AssetArchive::Pack( const std::string &archivePath, const std::string &root,
+                         const std::vector<std::string> &paths )
+{
+  // Read every file first: nothing is written unless all of them are there
+  std::vector< std::vector<Uint8> > contents( paths.size() );
+  for( size_t i = 0; i < paths.size(); ++i ){
+    SDL_RWops *file = SDL_RWFromFile( ( root + paths[i] ).c_str(), "rb" );
+    const Sint64 size = file != NULL ? SDL_RWsize( file ) : -1;
+    contents[i].resize( size > 0 ? static_cast<size_t>( size ) : 0 );
+    const bool read = size >= 0 && ( size == 0 || SDL_RWread( file, &contents[i][0], contents[i].size(), 1 ) == 1 );
+    if( file != NULL ){
+      SDL_RWclose( file );
+    }
+    if( !read ){
+      SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to read %s: %s", ( root + paths[i] ).c_str(),
+                    SDL_GetError() );
+      return false;
+    }
+    if( size > INT_MAX ){
+      SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "%s is too large to archive", ( root + paths[i] ).c_str() );
+      return false;
+    }
+  }
+
+  // TOC sorted by hash. Paths sharing a hash are allowed, the same path twice is not
+  std::vector<size_t> order( paths.size() );
+  std::vector<Uint64> hashes( paths.size() );
+  for( size_t i = 0; i < paths.size(); ++i ){
+    order[i]  = i;
+    hashes[i] = AssetManager::HashPath( paths[i] );
+  }
+  std::sort( order.begin(), order.end(), [&hashes]( size_t a, size_t b ){
+    return hashes[a] < hashes[b];
+  } );
+  for( size_t i = 1; i < order.size(); ++i ){
+    for( size_t j = i; j > 0 && hashes[order[j - 1]] == hashes[order[i]]; --j ){
+      if( AssetManager::IsSamePath( paths[order[j - 1]], paths[order[i]] ) ){
+        SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "%s is packed twice", paths[order[i]].c_str() );
+        return false;
+      }
+    }
+  }
+
+  // Layout: header, TOC, paths, then aligned data
+  std::vector<TocEntry> entries( paths.size() );
+  std::string           pathTable;
+  for( size_t i = 0; i < order.size(); ++i ){
+    entries[i].mPathHash    = hashes[order[i]];
+    entries[i].mPathOffset  = static_cast<Uint32>( pathTable.size() );
+    entries[i].mPathLength  = static_cast<Uint32>( paths[order[i]].size() );
+    pathTable += paths[order[i]];
+  }
+
+  Header header;
+  header.mMagic         = FILE_MAGIC;
+  header.mVersion       = FILE_VERSION;
+  header.mEntryCount    = static_cast<Uint32>( entries.size() );
+  header.mDataAlignment = DATA_ALIGNMENT;
+  header.mPathsOffset   = sizeof( Header ) + entries.size() * sizeof( TocEntry );
+  header.mDataOffset    = AlignUp( header.mPathsOffset + pathTable.size(), DATA_ALIGNMENT );
+
+  Uint64 offset = header.mDataOffset;
+  for( size_t i = 0; i < order.size(); ++i ){
+    entries[i].mOffset  = offset;
+    entries[i].mSize    = contents[order[i]].size();
+    offset             += AlignUp( entries[i].mSize, DATA_ALIGNMENT );
+  }
+
+  SDL_RWops *archive = SDL_RWFromFile( archivePath.c_str(), "wb" );
+  if( archive == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to write asset archive %s: %s", archivePath.c_str(),
+                  SDL_GetError() );
+    return false;
+  }
+
+  static const Uint8 PADDING[DATA_ALIGNMENT] = { 0 };
+  bool success = SDL_RWwrite( archive, &header, sizeof( header ), 1 ) == 1 &&
+                 ( entries.empty() || SDL_RWwrite( archive, &entries[0], sizeof( TocEntry ), entries.size() ) ==
+                                      entries.size() ) &&
+                 ( pathTable.empty() || SDL_RWwrite( archive, pathTable.data(), pathTable.size(), 1 ) == 1 );
+  Uint64 written = header.mPathsOffset + pathTable.size();
+  for( size_t i = 0; success && i < order.size(); ++i ){
+    const std::vector<Uint8> &data = contents[order[i]];
+    const size_t padding = static_cast<size_t>( entries[i].mOffset - written );
+    success = ( padding == 0 || SDL_RWwrite( archive, PADDING, padding, 1 ) == 1 ) &&
+              ( data.empty() || SDL_RWwrite( archive, &data[0], data.size(), 1 ) == 1 );
+    written = entries[i].mOffset + data.size();
+  }
+  SDL_RWclose( archive );
+
+  if( !success ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to write asset archive %s: %s", archivePath.c_str(),
+                  SDL_GetError() );
+    return false;
+  }
+  SDL_Log( "Packed %u assets into %s, %u KB", header.mEntryCount, archivePath.c_str(),
+           static_cast<Uint32>( written / 1024 ) );
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetArchive::Validate( void ) const
+{
+  if( mMappingSize < sizeof( Header ) ){
+    return false;
+  }
+
+  // The alignment the TOC claims is checked on every offset, so readers of the data can rely on it
+  const Header *header    = reinterpret_cast<const Header*>( mMapping );
+  const Uint64  tocEnd    = sizeof( Header ) + static_cast<Uint64>( header->mEntryCount ) * sizeof( TocEntry );
+  const Uint64  alignment = header->mDataAlignment;
+  if( header->mMagic != FILE_MAGIC || header->mVersion != FILE_VERSION || tocEnd > mMappingSize ||
+      header->mPathsOffset < tocEnd || header->mPathsOffset > header->mDataOffset ||
+      header->mDataOffset > mMappingSize || alignment == 0 || ( alignment & ( alignment - 1 ) ) != 0 ||
+      ( header->mDataOffset & ( alignment - 1 ) ) != 0 ){
+    return false;
+  }
+
+  // OpenAsset hands sizes to SDL_RWFromConstMem as an int
+  const Uint64 pathsSize = header->mDataOffset - header->mPathsOffset;
+  for( Uint32 i = 0; i < mEntryCount; ++i ){
+    const TocEntry &entry = mEntries[i];
+    if( ( i > 0 && mEntries[i - 1].mPathHash > entry.mPathHash ) ||
+        static_cast<Uint64>( entry.mPathOffset ) + entry.mPathLength > pathsSize ||
+        entry.mOffset < header->mDataOffset || entry.mOffset > mMappingSize ||
+        ( entry.mOffset & ( alignment - 1 ) ) != 0 || entry.mSize > mMappingSize - entry.mOffset ||
+        entry.mSize > static_cast<Uint64>( INT_MAX ) ){
+      return false;
+    }
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,152 @@
+#ifndef ASSETARCHIVE_H
+#define ASSETARCHIVE_H
+
+// RWops over archived files
+#include <SDL.h>
+
+// Paths and packing lists
+#include <string>
+#include <vector>
+
+/**
+Asset archive class
+Single file holding many assets, memory-mapped at runtime so opening an asset is a lookup instead of an open, read and
+close, and assets packed together are read with the locality of one file. Assets are served zero-copy: Find returns
+a pointer into the mapping and Open an SDL_RWFromConstMem over it, valid until the archive is closed.
+Layout, little endian:
+  Header    32 bytes, see Header
+  TOC       Header::mEntryCount 32 byte entries sorted by path hash, searched in place in the mapping
+  Paths     Archived paths, not terminated, to tell apart paths sharing a hash and to list the archive
+  Data      Each asset starts at a multiple of DATA_ALIGNMENT
+Paths are hashed with AssetManager::HashPath, relative to the folder the archive was packed from
+*/
+class AssetArchive
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32 FILE_MAGIC      = 0x4B415041;   ///< "APAK" little endian
+  static const Uint32 FILE_VERSION    = 1;
+  static const Uint32 DATA_ALIGNMENT  = 64;           ///< Cache line, also keeps pixel data aligned for SIMD reads
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  File header
+  */
+  struct Header
+  {
+    Uint32 mMagic;          ///< FILE_MAGIC
+    Uint32 mVersion;        ///< FILE_VERSION
+    Uint32 mEntryCount;     ///< Entries in the TOC, which follows the header
+    Uint32 mDataAlignment;  ///< Alignment of asset data offsets
+    Uint64 mPathsOffset;    ///< Offset of the path table
+    Uint64 mDataOffset;     ///< Offset of the first asset
+  };
+
+  /**
+  Table of contents entry
+  */
+  struct TocEntry
+  {
+    Uint64 mPathHash;       ///< AssetManager::HashPath of the path
+    Uint64 mOffset;         ///< Offset of the data in the file
+    Uint64 mSize;           ///< Size of the data
+    Uint32 mPathOffset;     ///< Offset of the path in the path table
+    Uint32 mPathLength;     ///< Length of the path
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  AssetArchive( void );
+
+  /**
+  Destructor. Closes the archive
+  */
+  ~AssetArchive( void );
+
+  /**
+  Maps and validates an archive, closing any archive already open
+  @param path Archive file
+  @return False if the file could not be mapped or is not a valid archive
+  */
+  bool Open( const std::string &path );
+
+  /**
+  Unmaps the archive. Pointers and RWops given out become invalid
+  */
+  void Close( void );
+
+  /**
+  Looks an asset up
+  @param path Path relative to the packed folder, case and separators do not matter
+  @param data Set to the asset in the mapping
+  @param size Set to the asset size
+  @return False if the asset is not in the archive
+  */
+  bool Find( const std::string &path, const Uint8 *&data, size_t &size ) const;
+
+  /**
+  Returns a read only RWops over an asset, to free with SDL_RWclose, or NULL if the asset is not in the archive
+  */
+  SDL_RWops *OpenAsset( const std::string &path ) const;
+
+  /**
+  Getters. Entries are in TOC order
+  */
+  inline bool IsOpen( void ) const {
+    return mMapping != NULL;
+  }
+  inline Uint32 GetEntryCount( void ) const {
+    return mEntryCount;
+  }
+  std::string GetEntryPath( Uint32 index ) const;
+
+  /**
+  Packs files into an archive
+  @param archivePath Archive file to write
+  @param root Folder the paths are relative to, with its trailing separator
+  @param paths Files to pack
+  @return False if a file could not be read or is over 2 GB, two paths collide or the archive could not be written
+  */
+  static bool Pack( const std::string &archivePath, const std::string &root, const std::vector<std::string> &paths );
+
+private:
+
+  // Not copyable: the mapping is owned
+  AssetArchive( const AssetArchive & );
+  AssetArchive &operator=( const AssetArchive & );
+
+  /**
+  Returns true if the mapped file is a valid archive. Entries are checked once here so lookups trust them
+  */
+  bool Validate( void ) const;
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  const Uint8      *mMapping;       ///< Mapped file, NULL when closed
+  size_t            mMappingSize;   ///< Size of the file
+  const TocEntry   *mEntries;       ///< TOC in the mapping
+  Uint32            mEntryCount;    ///< Entries in the TOC
+  const char       *mPaths;         ///< Path table in the mapping
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,355 @@
+#include "AssetManager.h"
+
+/**********************************************************************************************************************/
+
+static const Uint64 FNV_PRIME = 1099511628211ull;
+
+/**
+Folds a path character: ASCII upper case to lower case and backslashes to slashes
+*/
+static inline unsigned char FoldPathCharacter( char c )
+{
+  const unsigned char folded = static_cast<unsigned char>( c );
+  return folded == '\\' ? '/' : folded >= 'A' && folded <= 'Z' ? folded + ( 'a' - 'A' ) : folded;
+}
+
+/**********************************************************************************************************************/
+
+AssetManager::AssetManager( void )
+{
+}
+
+/**********************************************************************************************************************/
+
+AssetManager::~AssetManager( void )
+{
+  // Textures belong to the texture manager, which frees whatever is left when it is released
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::LoadTexture( const std::string &path, Uint32 flags )
+{
+  const Uint64  pathHash  = HashPath( path );
+  bool          shared;
+  TextureHandle handle    = FindTexture( path, pathHash, flags, shared );
+  if( handle != TextureHandle() ){
+    // Waiting in the streamer: requested now, so it should be read next
+    TextureAsset *asset = mTextures.Get( handle.mSlot );
+    if( asset->mStream != AssetStreamer::INVALID_REQUEST ){
+      AssetStreamer::GetInstance().SetPriority( asset->mStream, AssetStreamer::PRIORITY_IMMEDIATE );
+      asset->mPriority = AssetStreamer::PRIORITY_IMMEDIATE;
+    }
+    return handle;
+  }
+
+  TextureManager::TextureId texture;
+  if( !LoadFromArchive( path, flags, texture ) ){
+    texture = TextureManager::GetInstance().LoadTextureAsync( mMediaPath + path,
+                                                              ( flags & TEXTURE_FLAG_KEEP_SURFACE ) != 0,
+                                                              ( flags & TEXTURE_FLAG_BUILD_MASK ) != 0 );
+  }
+  return AddTexture( path, pathHash, flags, shared, texture );
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::StreamTexture( const std::string &path, Uint32 flags, AssetStreamer::Priority priority )
+{
+  return StreamTexture( path, flags, priority, false, 0.0f, 0.0f );
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::StreamTextureAt( const std::string &path, Uint32 flags, AssetStreamer::Priority priority,
+                                             float x, float y )
+{
+  return StreamTexture( path, flags, priority, true, x, y );
+}
+
+/**********************************************************************************************************************/
+
+bool AssetManager::MountArchive( const std::string &path )
+{
+  return mArchive.Open( path );
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::UnmountArchive( void )
+{
+  mArchive.Close();
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::AddReference( TextureHandle handle )
+{
+  TextureAsset *asset = mTextures.Get( handle.mSlot );
+  if( asset ){
+    ++asset->mRefCount;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::Release( TextureHandle handle )
+{
+  TextureAsset *asset = mTextures.Get( handle.mSlot );
+  if( asset == NULL || --asset->mRefCount != 0 ){
+    return;
+  }
+
+  if( asset->mStream != AssetStreamer::INVALID_REQUEST ){
+    AssetStreamer::GetInstance().Cancel( asset->mStream );
+  }
+  TextureManager::GetInstance().ReleaseTexture( asset->mTexture );
+  if( asset->mShared ){
+    mTextureLookup.erase( asset->mPathHash );
+  }
+  mTextures.Destroy( handle.mSlot );
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::Reload( TextureHandle handle )
+{
+  const TextureAsset *asset = mTextures.Get( handle.mSlot );
+  if( asset ){
+    TextureManager::GetInstance().ReloadTextureAsync( asset->mTexture );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::ReleaseAll( void )
+{
+  for( size_t i = 0; i < mTextures.GetSize(); ++i ){
+    if( mTextures[i].mStream != AssetStreamer::INVALID_REQUEST ){
+      AssetStreamer::GetInstance().Cancel( mTextures[i].mStream );
+    }
+    TextureManager::GetInstance().ReleaseTexture( mTextures[i].mTexture );
+  }
+  mTextures.Clear();
+  mTextureLookup.clear();
+}
+
+/**********************************************************************************************************************/
+
+AssetManager::AssetState AssetManager::GetState( TextureHandle handle ) const
+{
+  if( !mTextures.IsValid( handle.mSlot ) ){
+    return ASSET_STATE_INVALID;
+  }
+
+  // Streamed textures have no texture slot until read, and none at all if the read failed
+  const TextureAsset *asset = mTextures.Get( handle.mSlot );
+  if( asset->mStream != AssetStreamer::INVALID_REQUEST ){
+    return ASSET_STATE_LOADING;
+  }
+  if( asset->mTexture == TextureManager::INVALID_TEXTURE_ID ){
+    return ASSET_STATE_FAILED;
+  }
+
+  switch( TextureManager::GetInstance().GetState( asset->mTexture ) ){
+  case TextureManager::TEXTURE_STATE_READY:
+    return ASSET_STATE_READY;
+  case TextureManager::TEXTURE_STATE_FAILED:
+    return ASSET_STATE_FAILED;
+  case TextureManager::TEXTURE_STATE_LOADING:
+    return ASSET_STATE_LOADING;
+  default:
+    return ASSET_STATE_INVALID;
+  }
+}
+
+/**********************************************************************************************************************/
+
+SDL_Texture *AssetManager::GetTexture( TextureHandle handle ) const
+{
+  return TextureManager::GetInstance().GetTexture( GetTextureId( handle ) );
+}
+
+/**********************************************************************************************************************/
+
+SDL_Surface *AssetManager::GetSurface( TextureHandle handle ) const
+{
+  return TextureManager::GetInstance().GetSurface( GetTextureId( handle ) );
+}
+
+/**********************************************************************************************************************/
+
+const CollisionMask *AssetManager::GetCollisionMask( TextureHandle handle ) const
+{
+  return TextureManager::GetInstance().GetCollisionMask( GetTextureId( handle ) );
+}
+
+/**********************************************************************************************************************/
+
+Uint32 AssetManager::GetReferenceCount( TextureHandle handle ) const
+{
+  return mTextures.IsValid( handle.mSlot ) ? mTextures.Get( handle.mSlot )->mRefCount : 0;
+}
+
+/**********************************************************************************************************************/
+
+Uint64 AssetManager::HashPath( const std::string &path, Uint64 hash )
+{
+  for( size_t i = 0; i < path.size(); ++i ){
+    hash ^= FoldPathCharacter( path[i] );
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::FindTexture( const std::string &path, Uint64 pathHash, Uint32 flags, bool &shared )
+{
+  TextureHandle handle;
+  shared = true;
+
+  std::unordered_map<Uint64, SlotMapHandle>::const_iterator found = mTextureLookup.find( pathHash );
+  if( found == mTextureLookup.end() ){
+    return handle;
+  }
+
+  TextureAsset *asset = mTextures.Get( found->second );
+  if( !IsSamePath( asset->mPath, path ) ){
+    AssertMessage( false, ( "Path hash collision between " + asset->mPath + " and " + path ).c_str() );
+    shared = false;
+    return handle;
+  }
+
+  AssertMessage( ( flags & ~asset->mFlags ) == 0, ( "Texture " + path + " already loaded without some of the "
+                                                    "requested flags" ).c_str() );
+  ++asset->mRefCount;
+  handle.mSlot = found->second;
+  return handle;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetManager::LoadFromArchive( const std::string &path, Uint32 flags, TextureManager::TextureId &texture )
+{
+  const Uint8  *data;
+  size_t        size;
+  if( !mArchive.IsOpen() || !mArchive.Find( path, data, size ) ){
+    return false;
+  }
+
+  texture = TextureManager::GetInstance().LoadTextureFromMemoryAsync( mMediaPath + path, data, size,
+                                                                      ( flags & TEXTURE_FLAG_KEEP_SURFACE ) != 0,
+                                                                      ( flags & TEXTURE_FLAG_BUILD_MASK ) != 0 );
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::AddTexture( const std::string &path, Uint64 pathHash, Uint32 flags, bool shared,
+                                        TextureManager::TextureId texture )
+{
+  TextureAsset asset;
+  asset.mPathHash = pathHash;
+  asset.mPath     = path;
+  asset.mTexture  = texture;
+  asset.mStream   = AssetStreamer::INVALID_REQUEST;
+  asset.mPriority = AssetStreamer::PRIORITY_IMMEDIATE;
+  asset.mRefCount = 1;
+  asset.mFlags    = flags;
+  asset.mShared   = shared;
+
+  TextureHandle handle;
+  handle.mSlot = mTextures.Create( asset );
+  if( shared ){
+    mTextureLookup[pathHash] = handle.mSlot;
+  }
+  return handle;
+}
+
+/**********************************************************************************************************************/
+
+TextureHandle AssetManager::StreamTexture( const std::string &path, Uint32 flags, AssetStreamer::Priority priority,
+                                           bool placed, float x, float y )
+{
+  const Uint64  pathHash  = HashPath( path );
+  bool          shared;
+  TextureHandle handle    = FindTexture( path, pathHash, flags, shared );
+  if( handle != TextureHandle() ){
+    // Only ever moved to a more urgent band, the first owner may need it sooner than this one
+    TextureAsset *asset = mTextures.Get( handle.mSlot );
+    if( asset->mStream != AssetStreamer::INVALID_REQUEST && priority < asset->mPriority ){
+      AssetStreamer::GetInstance().SetPriority( asset->mStream, priority );
+      asset->mPriority = priority;
+    }
+    return handle;
+  }
+
+  // Archived files are already in memory, there is nothing to read
+  TextureManager::TextureId texture;
+  if( LoadFromArchive( path, flags, texture ) ){
+    return AddTexture( path, pathHash, flags, shared, texture );
+  }
+
+  handle = AddTexture( path, pathHash, flags, shared, TextureManager::INVALID_TEXTURE_ID );
+
+  // The slot handle is captured: the asset may be released, and its slot reused, before the read finishes
+  const SlotMapHandle slot = handle.mSlot;
+  AssetStreamer::Callback callback = [this, slot]( AssetStreamer::RequestId, AssetStreamer::StreamResult result,
+                                                   std::vector<Uint8> &data ){
+    OnTextureStreamed( slot, result, data );
+  };
+
+  AssetStreamer &streamer = AssetStreamer::GetInstance();
+  TextureAsset  *asset    = mTextures.Get( slot );
+  asset->mStream          = placed ? streamer.RequestAt( mMediaPath + path, priority, x, y, callback ) :
+                                     streamer.Request( mMediaPath + path, priority, callback );
+  asset->mPriority        = priority;
+  return handle;
+}
+
+/**********************************************************************************************************************/
+
+void AssetManager::OnTextureStreamed( SlotMapHandle slot, AssetStreamer::StreamResult result,
+                                      std::vector<Uint8> &data )
+{
+  if( !mTextures.IsValid( slot ) ){
+    return;
+  }
+
+  // A failed read leaves the asset without texture slot, which GetState reports as failed
+  TextureAsset *asset = mTextures.Get( slot );
+  asset->mStream      = AssetStreamer::INVALID_REQUEST;
+  if( result == AssetStreamer::STREAM_RESULT_LOADED ){
+    asset->mTexture = TextureManager::GetInstance().LoadTextureFromMemoryAsync( mMediaPath + asset->mPath, data,
+                                                        ( asset->mFlags & TEXTURE_FLAG_KEEP_SURFACE ) != 0,
+                                                        ( asset->mFlags & TEXTURE_FLAG_BUILD_MASK ) != 0 );
+  }
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureId AssetManager::GetTextureId( TextureHandle handle ) const
+{
+  if( !mTextures.IsValid( handle.mSlot ) ){
+    return TextureManager::INVALID_TEXTURE_ID;
+  }
+  return mTextures.Get( handle.mSlot )->mTexture;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetManager::IsSamePath( const std::string &a, const std::string &b )
+{
+  if( a.size() != b.size() ){
+    return false;
+  }
+  for( size_t i = 0; i < a.size(); ++i ){
+    if( FoldPathCharacter( a[i] ) != FoldPathCharacter( b[i] ) ){
+      return false;
+    }
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
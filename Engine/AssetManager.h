@@ -0,0 +1,291 @@
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include "Singleton.h"
+
+// Generational handles
+#include "SlotMap.h"
+
+// Packed assets
+#include "AssetArchive.h"
+
+// Files can be streamed before decoding
+#include "AssetStreamer.h"
+
+// Textures are loaded and owned by the texture manager
+#include "TextureManager.h"
+
+// Path lookup
+#include <string>
+#include <unordered_map>
+
+/**********************************************************************************************************************/
+
+/**
+Asset handle
+Generational handle typed by the asset it references, so a texture handle cannot be passed where another kind of asset
+or a slot map element is expected. Default constructed handles reference nothing
+*/
+template < class T >
+struct AssetHandle
+{
+  SlotMapHandle mSlot;   ///< Slot in the asset manager
+
+  AssetHandle( void )
+    : mSlot(INVALID_SLOT_MAP_HANDLE) { }
+
+  inline bool operator==( const AssetHandle &other ) const {
+    return mSlot == other.mSlot;
+  }
+  inline bool operator!=( const AssetHandle &other ) const {
+    return mSlot != other.mSlot;
+  }
+};
+
+typedef AssetHandle<SDL_Texture> TextureHandle;
+
+/**********************************************************************************************************************/
+
+/**
+Asset manager class
+Gives gameplay reference counted handles to assets instead of raw SDL pointers. Paths are looked up by a 64 bit hash of
+the path relative to the media folder, after folding case and separators, so requesting a file already loaded or
+loading only takes a reference on it: one file, one decode, one texture. The full path is only built on a miss.
+Assets are freed when their last reference is released, which makes every outstanding copy of the handle stale.
+Streamed textures are read by the AssetStreamer by priority and decoded once read; releasing one still streaming
+cancels its read. When an archive is mounted, the files it holds are decoded straight from its mapping, streamed or
+not, and only the others are read from the media folder
+*/
+class AssetManager : public Singleton <AssetManager>
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  // Allow constructor calling only from Singleton
+  friend class Singleton <AssetManager>;
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint64 PATH_HASH_SEED = 14695981039346656037ull;   ///< FNV-1a 64 bit offset basis
+
+  /**
+  Load options. The options of the first load of a file apply to every later request of it
+  */
+  enum TextureFlags
+  {
+    TEXTURE_FLAG_KEEP_SURFACE = 1 << 0,   ///< Keep the decoded surface, see TextureManager::GetSurface
+    TEXTURE_FLAG_BUILD_MASK   = 1 << 1    ///< Build a collision mask, see TextureManager::GetCollisionMask
+  };
+
+  /**
+  Load state of an asset
+  */
+  enum AssetState
+  {
+    ASSET_STATE_INVALID,    ///< Stale or default constructed handle
+    ASSET_STATE_LOADING,    ///< Requested, not usable yet
+    ASSET_STATE_READY,      ///< Usable
+    ASSET_STATE_FAILED      ///< Could not be loaded. Stays referenced until released
+  };
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Texture asset
+  */
+  struct TextureAsset
+  {
+    Uint64                      mPathHash;    ///< Lookup key
+    std::string                 mPath;        ///< Path relative to the media folder, to resolve hash collisions
+    TextureManager::TextureId   mTexture;     ///< Texture manager slot, INVALID_TEXTURE_ID while streaming
+    AssetStreamer::RequestId    mStream;      ///< Read in progress, INVALID_REQUEST once read or if not streamed
+    AssetStreamer::Priority     mPriority;    ///< Band of the read in progress
+    Uint32                      mRefCount;    ///< Handles given out and not released
+    Uint32                      mFlags;       ///< TextureFlags of the first load
+    bool                        mShared;      ///< False for the rare file whose hash collides, it is not in the lookup
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Requests a texture. Returns a new reference to the texture if the file is already loaded or loading
+  @param path Path of the BMP file, relative to the media folder
+  @param flags TextureFlags combination
+  @return Handle to release with Release. Check its state before use
+  */
+  TextureHandle LoadTexture( const std::string &path, Uint32 flags = 0 );
+
+  /**
+  Requests a texture through the asset streamer. A file already requested only gets a reference, and its read is moved
+  to a more urgent band if it is still waiting
+  @param path Path of the BMP file, relative to the media folder
+  @param flags TextureFlags combination
+  @param priority Band of the read
+  @return Handle to release with Release. Check its state before use
+  */
+  TextureHandle StreamTexture( const std::string &path, Uint32 flags, AssetStreamer::Priority priority );
+
+  /**
+  Requests a texture used at a world position through the asset streamer. Within its band, textures nearer to the
+  streamer focus are read first
+  */
+  TextureHandle StreamTextureAt( const std::string &path, Uint32 flags, AssetStreamer::Priority priority, float x,
+                                 float y );
+
+  /**
+  Serves the files packed in an archive from its mapping instead of the media folder. Replaces the archive mounted,
+  which is unmapped first: as for UnmountArchive, no decode from it may be running, see JobManager::WaitForAll
+  @param path Archive file
+  @return False if the archive could not be opened, files are then read from the media folder
+  */
+  bool MountArchive( const std::string &path );
+
+  /**
+  Unmounts the archive. Textures decoded from it stay, but no decode from it may be running, see
+  JobManager::WaitForAll
+  */
+  void UnmountArchive( void );
+
+  /**
+  Takes another reference on an asset, for a second owner of the handle
+  */
+  void AddReference( TextureHandle handle );
+
+  /**
+  Releases a reference. The texture is freed with the last one
+  */
+  void Release( TextureHandle handle );
+
+  /**
+  Reloads the file of a texture in place. Handles stay valid
+  */
+  void Reload( TextureHandle handle );
+
+  /**
+  Frees every asset regardless of references. Outstanding handles become stale. Call before the renderer is destroyed
+  */
+  void ReleaseAll( void );
+
+  /**
+  Returns the load state of an asset. Never asserts, stale handles are ASSET_STATE_INVALID
+  */
+  AssetState GetState( TextureHandle handle ) const;
+
+  /**
+  Resources of a texture. NULL until the texture is ready, or if not requested in the load flags
+  */
+  SDL_Texture           *GetTexture( TextureHandle handle ) const;
+  SDL_Surface           *GetSurface( TextureHandle handle ) const;
+  const CollisionMask   *GetCollisionMask( TextureHandle handle ) const;
+
+  /**
+  Getters
+  */
+  inline const std::string &GetMediaPath( void ) const {
+    return mMediaPath;
+  }
+  inline size_t GetTextureCount( void ) const {
+    return mTextures.GetSize();
+  }
+  inline const AssetArchive &GetArchive( void ) const {
+    return mArchive;
+  }
+  Uint32 GetReferenceCount( TextureHandle handle ) const;
+
+  /**
+  Sets the folder paths are relative to, with its trailing separator. Applies to the next loads
+  */
+  inline void SetMediaPath( const std::string &mediaPath ){
+    mMediaPath = mediaPath;
+  }
+
+  /**
+  FNV-1a 64 bit hash of a path with case and separators folded, so "Sprites\Hero.bmp" and "sprites/hero.bmp" match
+  @param path Path to hash
+  @param hash Running hash to continue
+  @return Path hash
+  */
+  static Uint64 HashPath( const std::string &path, Uint64 hash = PATH_HASH_SEED );
+
+  /**
+  Returns true if two paths are the same file once case and separators are folded
+  */
+  static bool IsSamePath( const std::string &a, const std::string &b );
+
+private:
+
+  // Constructor and destructor private for singleton (only one instance can be created)
+  /**
+  Private constructor for AssetManager singleton
+  */
+  AssetManager( void );
+
+  /**
+  Private destructor for AssetManager singleton
+  */
+  /*virtual*/ ~AssetManager( void ); // Avoid virtual if not strictly necessary (Singletons don't use inheritance)
+
+  /**
+  Returns a new reference to the texture of a path, or a null handle if it has not been requested
+  @param path Path relative to the media folder
+  @param pathHash HashPath of the path
+  @param flags Flags of the request, checked against those of the first load
+  @param shared Set to false if another path has the same hash, the asset must not go into the lookup
+  */
+  TextureHandle FindTexture( const std::string &path, Uint64 pathHash, Uint32 flags, bool &shared );
+
+  /**
+  Starts decoding a texture from the mounted archive
+  @param texture Set to the texture manager slot
+  @return False if the file is not in the archive
+  */
+  bool LoadFromArchive( const std::string &path, Uint32 flags, TextureManager::TextureId &texture );
+
+  /**
+  Adds a texture asset and its lookup entry
+  */
+  TextureHandle AddTexture( const std::string &path, Uint64 pathHash, Uint32 flags, bool shared,
+                            TextureManager::TextureId texture );
+
+  /**
+  Requests a texture through the asset streamer, placed in the world or not
+  */
+  TextureHandle StreamTexture( const std::string &path, Uint32 flags, AssetStreamer::Priority priority, bool placed,
+                               float x, float y );
+
+  /**
+  Streamer callback. Starts decoding the read file
+  */
+  void OnTextureStreamed( SlotMapHandle slot, AssetStreamer::StreamResult result, std::vector<Uint8> &data );
+
+  /**
+  Returns the texture manager slot of a handle, INVALID_TEXTURE_ID if stale. Never asserts
+  */
+  TextureManager::TextureId GetTextureId( TextureHandle handle ) const;
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  SlotMap<TextureAsset>                     mTextures;        ///< Texture assets
+  std::unordered_map<Uint64, SlotMapHandle> mTextureLookup;   ///< Shared texture assets by path hash
+  std::string                               mMediaPath;       ///< Prefix of every loaded path
+  AssetArchive                              mArchive;         ///< Mounted archive, closed if none
+};
+
+/**********************************************************************************************************************/
+
+#endif
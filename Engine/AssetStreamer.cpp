@@ -0,0 +1,314 @@
+#include "AssetStreamer.h"
+
+/**********************************************************************************************************************/
+
+const float AssetStreamer::DEFAULT_CALLBACK_BUDGET = 1.0f;
+
+/**********************************************************************************************************************/
+
+AssetStreamer::AssetStreamer( void )
+  : mNextId(INVALID_REQUEST + 1), mFocusX(0.0f), mFocusY(0.0f), mCallbackBudget(DEFAULT_CALLBACK_BUDGET), mQuit(false)
+{
+  for( Uint32 i = 0; i < IO_THREAD_COUNT; ++i ){
+    mIoThreads.push_back( std::thread( &AssetStreamer::IoLoop, this ) );
+  }
+}
+
+/**********************************************************************************************************************/
+
+AssetStreamer::~AssetStreamer( void )
+{
+  CancelAll();
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    mQuit = true;
+  }
+  mRequestAdded.notify_all();
+
+  for( size_t i = 0; i < mIoThreads.size(); ++i ){
+    mIoThreads[i].join();
+  }
+}
+
+/**********************************************************************************************************************/
+
+AssetStreamer::RequestId AssetStreamer::Request( const std::string &path, Priority priority, const Callback &callback )
+{
+  PendingRequest request;
+  request.mPath     = path;
+  request.mCallback = callback;
+  request.mPriority = priority;
+  request.mX        = 0.0f;
+  request.mY        = 0.0f;
+  request.mPlaced   = false;
+  return AddRequest( request );
+}
+
+/**********************************************************************************************************************/
+
+AssetStreamer::RequestId AssetStreamer::RequestAt( const std::string &path, Priority priority, float x, float y,
+                                                   const Callback &callback )
+{
+  PendingRequest request;
+  request.mPath     = path;
+  request.mCallback = callback;
+  request.mPriority = priority;
+  request.mX        = x;
+  request.mY        = y;
+  request.mPlaced   = true;
+  return AddRequest( request );
+}
+
+/**********************************************************************************************************************/
+
+bool AssetStreamer::SetPriority( RequestId id, Priority priority )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  for( size_t i = 0; i < mPending.size(); ++i ){
+    if( mPending[i].mId == id ){
+      mPending[i].mPriority = priority;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetStreamer::Cancel( RequestId id )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  for( size_t i = 0; i < mPending.size(); ++i ){
+    if( mPending[i].mId == id ){
+      mPending[i] = mPending.back();
+      mPending.pop_back();
+      return true;
+    }
+  }
+  for( size_t i = 0; i < mReading.size(); ++i ){
+    if( mReading[i].mId == id ){
+      mReading[i].mCancelled = true;
+      return true;
+    }
+  }
+  for( std::deque<Completed>::iterator it = mCompleted.begin(); it != mCompleted.end(); ++it ){
+    if( it->mId == id ){
+      mCompleted.erase( it );
+      return true;
+    }
+  }
+  return false;
+}
+
+/**********************************************************************************************************************/
+
+void AssetStreamer::CancelAll( void )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  mPending.clear();
+  for( size_t i = 0; i < mReading.size(); ++i ){
+    mReading[i].mCancelled = true;
+  }
+  mCompleted.clear();
+}
+
+/**********************************************************************************************************************/
+
+void AssetStreamer::DispatchCompleted( void )
+{
+  const Uint64 start  = SDL_GetPerformanceCounter();
+  const Uint64 budget = static_cast<Uint64>( mCallbackBudget * 0.001 * SDL_GetPerformanceFrequency() );
+
+  do{
+    Completed completed;
+    {
+      std::lock_guard<std::mutex> lock( mMutex );
+      if( mCompleted.empty() ){
+        return;
+      }
+      completed.mId       = mCompleted.front().mId;
+      completed.mResult   = mCompleted.front().mResult;
+      completed.mData.swap( mCompleted.front().mData );
+      completed.mCallback.swap( mCompleted.front().mCallback );
+      mCompleted.pop_front();
+    }
+
+    // Run without the lock, callbacks may request or cancel
+    if( completed.mCallback ){
+      completed.mCallback( completed.mId, completed.mResult, completed.mData );
+    }
+  }while( SDL_GetPerformanceCounter() - start < budget );
+}
+
+/**********************************************************************************************************************/
+
+void AssetStreamer::SetFocus( float x, float y )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  mFocusX = x;
+  mFocusY = y;
+}
+
+/**********************************************************************************************************************/
+
+size_t AssetStreamer::GetOutstandingCount( void )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  size_t reading = 0;
+  for( size_t i = 0; i < mReading.size(); ++i ){
+    reading += mReading[i].mCancelled ? 0 : 1;
+  }
+  return mPending.size() + reading + mCompleted.size();
+}
+
+/**********************************************************************************************************************/
+
+AssetStreamer::RequestId AssetStreamer::AddRequest( PendingRequest &request )
+{
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    request.mId = mNextId++;
+    if( mNextId == INVALID_REQUEST ){
+      ++mNextId;
+    }
+    mPending.push_back( request );
+  }
+  mRequestAdded.notify_one();
+  return request.mId;
+}
+
+/**********************************************************************************************************************/
+
+void AssetStreamer::IoLoop( void )
+{
+  std::unique_lock<std::mutex> lock( mMutex );
+  for( ;; ){
+    while( !mQuit && mPending.empty() ){
+      mRequestAdded.wait( lock );
+    }
+    if( mQuit ){
+      return;
+    }
+
+    const size_t    next    = FindNext();
+    PendingRequest  request = mPending[next];
+    mPending[next]          = mPending.back();
+    mPending.pop_back();
+
+    Reading reading;
+    reading.mId         = request.mId;
+    reading.mCancelled  = false;
+    mReading.push_back( reading );
+
+    lock.unlock();
+    Completed completed;
+    completed.mId       = request.mId;
+    completed.mResult   = ReadFile( request.mId, request.mPath, completed.mData ) ? STREAM_RESULT_LOADED :
+                                                                                   STREAM_RESULT_FAILED;
+    completed.mCallback.swap( request.mCallback );
+    lock.lock();
+
+    bool cancelled = false;
+    for( size_t i = 0; i < mReading.size(); ++i ){
+      if( mReading[i].mId == request.mId ){
+        cancelled     = mReading[i].mCancelled;
+        mReading[i]   = mReading.back();
+        mReading.pop_back();
+        break;
+      }
+    }
+    if( !cancelled ){
+      if( completed.mResult == STREAM_RESULT_FAILED ){
+        SDL_LogWarn( SDL_LOG_CATEGORY_APPLICATION, "Unable to stream %s: %s", request.mPath.c_str(), SDL_GetError() );
+        completed.mData.clear();
+      }
+      mCompleted.push_back( Completed() );
+      mCompleted.back().mId     = completed.mId;
+      mCompleted.back().mResult = completed.mResult;
+      mCompleted.back().mData.swap( completed.mData );
+      mCompleted.back().mCallback.swap( completed.mCallback );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+size_t AssetStreamer::FindNext( void ) const
+{
+  // A scan per read: a file read costs far more than the scan, and neither focus moves nor priority changes have to
+  // rebuild an ordered structure
+  size_t  best          = 0;
+  float   bestDistance  = 0.0f;
+  for( size_t i = 0; i < mPending.size(); ++i ){
+    const PendingRequest &request  = mPending[i];
+    const PendingRequest &current  = mPending[best];
+    const float           dx       = request.mX - mFocusX;
+    const float           dy       = request.mY - mFocusY;
+    const float           distance = request.mPlaced ? dx * dx + dy * dy : -1.0f;
+
+    if( i == 0 || request.mPriority < current.mPriority ||
+        ( request.mPriority == current.mPriority && ( distance < bestDistance ||
+                                                      ( distance == bestDistance && request.mId < current.mId ) ) ) ){
+      best          = i;
+      bestDistance  = distance;
+    }
+  }
+  return best;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetStreamer::ReadFile( RequestId id, const std::string &path, std::vector<Uint8> &data )
+{
+  SDL_RWops *file = SDL_RWFromFile( path.c_str(), "rb" );
+  if( file == NULL ){
+    return false;
+  }
+
+  // Sized files are read in place, others (pipes, some archives) grow by a chunk at a time
+  const Sint64 size = SDL_RWsize( file );
+  data.resize( size > 0 ? static_cast<size_t>( size ) : 0 );
+
+  size_t  filled  = 0;
+  bool    success = true;
+  for( ;; ){
+    if( IsReadCancelled( id ) ){
+      success = false;
+      break;
+    }
+    if( filled == data.size() ){
+      if( size > 0 ){
+        break;
+      }
+      data.resize( filled + READ_CHUNK_SIZE );
+    }
+
+    const size_t chunk = data.size() - filled < READ_CHUNK_SIZE ? data.size() - filled : READ_CHUNK_SIZE;
+    const size_t read  = SDL_RWread( file, &data[filled], 1, chunk );
+    filled += read;
+    if( read < chunk ){
+      // End of an unsized file, or a failed read of a sized one
+      success = size <= 0 || filled == static_cast<size_t>( size );
+      break;
+    }
+  }
+
+  SDL_RWclose( file );
+  data.resize( success ? filled : 0 );
+  return success;
+}
+
+/**********************************************************************************************************************/
+
+bool AssetStreamer::IsReadCancelled( RequestId id )
+{
+  std::lock_guard<std::mutex> lock( mMutex );
+  for( size_t i = 0; i < mReading.size(); ++i ){
+    if( mReading[i].mId == id ){
+      return mReading[i].mCancelled;
+    }
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,239 @@
+#ifndef ASSETSTREAMER_H
+#define ASSETSTREAMER_H
+
+#include "Singleton.h"
+
+// File access
+#include <SDL.h>
+
+// Requests and results
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+// I/O threads
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+Asset streamer class
+Reads files on dedicated I/O threads, so blocking reads never hold a JobManager worker, and hands their bytes to
+callbacks run on the main thread. Pending requests are served by priority band, then by distance to the focus point
+(usually the camera) for requests placed in the world, then in request order. Distance is evaluated when an I/O thread
+picks its next request, so moving the focus reorders the queue without touching it. Files are read in chunks and a
+cancelled request stops at the next chunk. Cancelled requests never call back
+*/
+class AssetStreamer : public Singleton <AssetStreamer>
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  // Allow constructor calling only from Singleton
+  friend class Singleton <AssetStreamer>;
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   INVALID_REQUEST         = 0;            ///< Id never given to a request
+  static const Uint32   IO_THREAD_COUNT         = 2;            ///< Reads in flight at once
+  static const size_t   READ_CHUNK_SIZE         = 64 * 1024;    ///< Bytes read between cancellation checks
+  static const float    DEFAULT_CALLBACK_BUDGET;                ///< Default milliseconds per frame spent in callbacks
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  typedef Uint32 RequestId;
+
+  /**
+  Priority bands, served in order
+  */
+  enum Priority
+  {
+    PRIORITY_IMMEDIATE,     ///< Needed now, such as what the player is looking at
+    PRIORITY_HIGH,          ///< Needed soon
+    PRIORITY_NORMAL,        ///< Level content, ordered by distance to the focus
+    PRIORITY_BACKGROUND     ///< Prefetch
+  };
+
+  /**
+  Outcome of a finished request
+  */
+  enum StreamResult
+  {
+    STREAM_RESULT_LOADED,   ///< Data holds the whole file
+    STREAM_RESULT_FAILED    ///< File could not be opened or read. Data is empty
+  };
+
+  /**
+  Completion callback, run on the main thread. The data may be swapped out by the callback
+  */
+  typedef std::function<void( RequestId id, StreamResult result, std::vector<Uint8> &data )> Callback;
+
+private:
+
+  /**
+  Pending request
+  */
+  struct PendingRequest
+  {
+    RequestId   mId;          ///< Request id, increasing with request order
+    std::string mPath;        ///< File to read
+    Callback    mCallback;    ///< Run on the main thread when read
+    Priority    mPriority;    ///< Band
+    float       mX;           ///< World position, for requests placed in the world
+    float       mY;
+    bool        mPlaced;      ///< False for requests without position, served first in their band
+  };
+
+  /**
+  Read in progress on an I/O thread
+  */
+  struct Reading
+  {
+    RequestId   mId;          ///< Request being read
+    bool        mCancelled;   ///< Stop at the next chunk and drop the result
+  };
+
+  /**
+  Finished request waiting for its callback
+  */
+  struct Completed
+  {
+    RequestId           mId;        ///< Request id
+    StreamResult        mResult;    ///< Outcome
+    std::vector<Uint8>  mData;      ///< File contents
+    Callback            mCallback;  ///< Callback to run
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Requests a file
+  @param path File to read
+  @param priority Band of the request
+  @param callback Run on the main thread by DispatchCompleted once the file is read or failed
+  @return Request id, to cancel or change priority
+  */
+  RequestId Request( const std::string &path, Priority priority, const Callback &callback );
+
+  /**
+  Requests a file used at a world position. Within its band, nearer to the focus is read first
+  */
+  RequestId RequestAt( const std::string &path, Priority priority, float x, float y, const Callback &callback );
+
+  /**
+  Moves a request still waiting for an I/O thread to another band
+  @return False if the request is already being read, finished or cancelled
+  */
+  bool SetPriority( RequestId id, Priority priority );
+
+  /**
+  Cancels a request. Its callback is never run, even if the file was already read
+  @return False if the request already called back or does not exist
+  */
+  bool Cancel( RequestId id );
+
+  /**
+  Cancels every request
+  */
+  void CancelAll( void );
+
+  /**
+  Runs the callbacks of finished requests until the frame budget is spent. Call once per frame on the main thread. At
+  least one callback is run per call so streaming always progresses
+  */
+  void DispatchCompleted( void );
+
+  /**
+  Sets the point distances are measured from, usually the camera
+  */
+  void SetFocus( float x, float y );
+
+  /**
+  Set and get for the per-frame callback budget in milliseconds
+  */
+  inline float GetCallbackBudget( void ) const {
+    return mCallbackBudget;
+  }
+  inline void SetCallbackBudget( float milliseconds ){
+    mCallbackBudget = milliseconds;
+  }
+
+  /**
+  Returns the number of requests not called back yet: waiting, being read or waiting for their callback
+  */
+  size_t GetOutstandingCount( void );
+
+private:
+
+  // Constructor and destructor private for singleton (only one instance can be created)
+  /**
+  Private constructor for AssetStreamer singleton. Starts the I/O threads
+  */
+  AssetStreamer( void );
+
+  /**
+  Private destructor for AssetStreamer singleton. Drops pending requests and joins the I/O threads
+  */
+  /*virtual*/ ~AssetStreamer( void ); // Avoid virtual if not strictly necessary (Singletons don't use inheritance)
+
+  /**
+  Queues a request and wakes an I/O thread
+  */
+  RequestId AddRequest( PendingRequest &request );
+
+  /**
+  I/O thread main loop
+  */
+  void IoLoop( void );
+
+  /**
+  Returns the position in mPending of the request to read next. Called with mMutex held and mPending not empty
+  */
+  size_t FindNext( void ) const;
+
+  /**
+  Reads a whole file in chunks. Runs on an I/O thread without mMutex held
+  @param id Request, checked for cancellation between chunks
+  @param path File to read
+  @param data Receives the file contents
+  @return True if the whole file was read, false if it failed or was cancelled
+  */
+  bool ReadFile( RequestId id, const std::string &path, std::vector<Uint8> &data );
+
+  /**
+  Returns true if a read in progress was cancelled
+  */
+  bool IsReadCancelled( RequestId id );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<std::thread>     mIoThreads;        ///< I/O threads
+  std::vector<PendingRequest>  mPending;          ///< Requests waiting for an I/O thread, unordered
+  std::vector<Reading>         mReading;          ///< Reads in progress
+  std::deque<Completed>        mCompleted;        ///< Finished requests waiting for DispatchCompleted
+  std::mutex                   mMutex;            ///< Protects every container and the focus
+  std::condition_variable      mRequestAdded;     ///< Signaled when a request is queued or the streamer quits
+  RequestId                    mNextId;           ///< Id of the next request
+  float                        mFocusX;           ///< Point distances are measured from
+  float                        mFocusY;
+  float                        mCallbackBudget;   ///< Milliseconds per frame spent in DispatchCompleted
+  bool                         mQuit;             ///< I/O threads must exit
+};
+
+/**********************************************************************************************************************/
+
+#endif
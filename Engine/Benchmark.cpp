@@ -0,0 +1,1959 @@
+#include "Benchmark.h"
+
+// Benchmarked modules
+#include "AssetArchive.h"
+#include "AssetStreamer.h"
+#include "CollisionMask.h"
+#include "ContactSolver.h"
+#include "ContinuousCollision.h"
+#include "ControllerManager.h"
+#include "DynamicAABBTree.h"
+#include "EntityWorld.h"
+#include "InputRecorder.h"
+#include "Movement.h"
+#include "Prefab.h"
+#include "SpatialHashGrid.h"
+#include "SweepAndPrune.h"
+#include "TileCollisionMap.h"
+
+// Scene generation
+#include "RandomStream.h"
+
+// Worker count of the parallel runs
+#include "JobManager.h"
+
+// Timing and logging
+#include <SDL.h>
+
+// Medians
+#include <algorithm>
+#include <vector>
+
+// SoA reference kernel, same test as Movement.cpp
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+  #define BENCHMARK_USE_SSE2
+  #include <emmintrin.h>
+#endif
+
+// Damping factor
+#include <cmath>
+
+// Bit for bit comparisons
+#include <cstring>
+
+// Removing the benchmark assets
+#include <cstdio>
+
+/**********************************************************************************************************************/
+
+/**
+Returns the milliseconds elapsed since a performance counter value
+*/
+static double GetMilliseconds( Uint64 start )
+{
+  return ( SDL_GetPerformanceCounter() - start ) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+/**********************************************************************************************************************/
+
+/**
+Returns the median of timing samples. Reorders them
+*/
+static double Median( std::vector<double> &samples )
+{
+  std::nth_element( samples.begin(), samples.begin() + samples.size() / 2, samples.end() );
+  return samples[samples.size() / 2];
+}
+
+/**********************************************************************************************************************/
+
+/**
+Random float in [minimum, maximum)
+*/
+static float NextFloat( RandomStream &random, float minimum, float maximum )
+{
+  return minimum + ( maximum - minimum ) * ( random.Next() >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+/**********************************************************************************************************************/
+// MOVEMENT
+/**********************************************************************************************************************/
+
+/**
+Movement data in split x and y arrays, the layout Movement does not use
+*/
+struct SplitMovement
+{
+  std::vector<float> mX, mY, mVelocityX, mVelocityY, mAccelerationX, mAccelerationY;
+};
+
+/**********************************************************************************************************************/
+
+/**
+Same step as Movement::Integrate with uniform damping, over split arrays
+*/
+static void IntegrateSplit( SplitMovement &data, float factor, float deltaTime )
+{
+  const Uint32 count = static_cast<Uint32>( data.mX.size() );
+  Uint32       first = 0;
+
+#ifdef BENCHMARK_USE_SSE2
+  const __m128 dt = _mm_set1_ps( deltaTime );
+  const __m128 k  = _mm_set1_ps( factor );
+
+  first = count & ~3u;
+  for( Uint32 i = 0; i < first; i += 4 ){
+    __m128 velocityX = _mm_loadu_ps( &data.mVelocityX[i] );
+    __m128 velocityY = _mm_loadu_ps( &data.mVelocityY[i] );
+    velocityX = _mm_mul_ps( _mm_add_ps( velocityX, _mm_mul_ps( _mm_loadu_ps( &data.mAccelerationX[i] ), dt ) ), k );
+    velocityY = _mm_mul_ps( _mm_add_ps( velocityY, _mm_mul_ps( _mm_loadu_ps( &data.mAccelerationY[i] ), dt ) ), k );
+    _mm_storeu_ps( &data.mVelocityX[i], velocityX );
+    _mm_storeu_ps( &data.mVelocityY[i], velocityY );
+    _mm_storeu_ps( &data.mX[i], _mm_add_ps( _mm_loadu_ps( &data.mX[i] ), _mm_mul_ps( velocityX, dt ) ) );
+    _mm_storeu_ps( &data.mY[i], _mm_add_ps( _mm_loadu_ps( &data.mY[i] ), _mm_mul_ps( velocityY, dt ) ) );
+  }
+#endif
+
+  for( Uint32 i = first; i < count; ++i ){
+    data.mVelocityX[i] = ( data.mVelocityX[i] + data.mAccelerationX[i] * deltaTime ) * factor;
+    data.mVelocityY[i] = ( data.mVelocityY[i] + data.mAccelerationY[i] * deltaTime ) * factor;
+    data.mX[i]        += data.mVelocityX[i] * deltaTime;
+    data.mY[i]        += data.mVelocityY[i] * deltaTime;
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Fills a world with moving entities
+@param uniform True to give every entity the same damping, the common case of spawned entities
+*/
+static void SpawnMovers( EntityWorld &world, Uint32 count, bool uniform )
+{
+  RandomStream random( 1 );
+  for( Uint32 i = 0; i < count; ++i ){
+    const Position      position      = { NextFloat( random, 0.0f, 4096.0f ), NextFloat( random, 0.0f, 4096.0f ) };
+    const Velocity      velocity      = { NextFloat( random, -100.0f, 100.0f ), NextFloat( random, -100.0f, 100.0f ) };
+    const Acceleration  acceleration  = { 0.0f, 98.0f };
+    const Damping       damping       = { uniform ? 0.5f : NextFloat( random, 0.0f, 2.0f ) };
+    world.CreateEntity( position, velocity, acceleration, damping );
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Returns every position of a world, in iteration order
+*/
+static std::vector<Position> GetPositions( EntityWorld &world )
+{
+  std::vector<Position> positions;
+  world.ForEach<const Position>( [&positions]( const Position &position ){ positions.push_back( position ); } );
+  return positions;
+}
+
+/**********************************************************************************************************************/
+
+/**
+Movement::Integrate against its scalar version and against split x and y arrays, at a million entities, then the
+damped velocity after one second at several frame rates
+*/
+static void BenchmarkMovement( void )
+{
+  const Uint32  ENTITY_COUNT  = 1000000;
+  const int     STEP_COUNT    = 31;
+  const float   DELTA_TIME    = 1.0f / 60.0f;
+
+  for( int uniform = 1; uniform >= 0; --uniform ){
+    EntityWorld simd;
+    EntityWorld scalar;
+    SpawnMovers( simd, ENTITY_COUNT, uniform != 0 );
+    SpawnMovers( scalar, ENTITY_COUNT, uniform != 0 );
+
+    // Each world runs all its steps in a row, as the split arrays below: alternating them would time cache misses
+    std::vector<double> simdSamples;
+    std::vector<double> scalarSamples;
+    for( int step = 0; step < STEP_COUNT; ++step ){
+      const Uint64 start = SDL_GetPerformanceCounter();
+      simd.ForEachChunk<Position, Velocity, const Acceleration, const Damping>(
+        [DELTA_TIME]( Uint32 count, Position *positions, Velocity *velocities, const Acceleration *accelerations,
+                      const Damping *damping ){
+          Movement::Integrate( positions, velocities, accelerations, damping, count, DELTA_TIME );
+        } );
+      simdSamples.push_back( GetMilliseconds( start ) );
+    }
+    for( int step = 0; step < STEP_COUNT; ++step ){
+      const Uint64 start = SDL_GetPerformanceCounter();
+      scalar.ForEachChunk<Position, Velocity, const Acceleration, const Damping>(
+        [DELTA_TIME]( Uint32 count, Position *positions, Velocity *velocities, const Acceleration *accelerations,
+                      const Damping *damping ){
+          Movement::IntegrateScalar( positions, velocities, accelerations, damping, count, DELTA_TIME );
+        } );
+      scalarSamples.push_back( GetMilliseconds( start ) );
+    }
+
+    const std::vector<Position> simdPositions   = GetPositions( simd );
+    const std::vector<Position> scalarPositions = GetPositions( scalar );
+    Uint32 mismatches = 0;
+    for( size_t i = 0; i < simdPositions.size(); ++i ){
+      mismatches += simdPositions[i].x != scalarPositions[i].x || simdPositions[i].y != scalarPositions[i].y ? 1 : 0;
+    }
+
+    SDL_Log( "movement %u entities, %s damping: SSE2 %.3f ms, scalar %.3f ms per step, %u positions differ",
+             ENTITY_COUNT, uniform ? "uniform" : "per entity", Median( simdSamples ), Median( scalarSamples ),
+             mismatches );
+  }
+
+  // Raw split arrays, without the entity world around them
+  SplitMovement split;
+  RandomStream  random( 1 );
+  for( Uint32 i = 0; i < ENTITY_COUNT; ++i ){
+    split.mX.push_back( NextFloat( random, 0.0f, 4096.0f ) );
+    split.mY.push_back( NextFloat( random, 0.0f, 4096.0f ) );
+    split.mVelocityX.push_back( NextFloat( random, -100.0f, 100.0f ) );
+    split.mVelocityY.push_back( NextFloat( random, -100.0f, 100.0f ) );
+    split.mAccelerationX.push_back( 0.0f );
+    split.mAccelerationY.push_back( 98.0f );
+  }
+  std::vector<double> splitSamples;
+  for( int step = 0; step < STEP_COUNT; ++step ){
+    const Uint64 start = SDL_GetPerformanceCounter();
+    IntegrateSplit( split, std::exp( -0.5f * DELTA_TIME ), DELTA_TIME );
+    splitSamples.push_back( GetMilliseconds( start ) );
+  }
+  SDL_Log( "movement %u entities, split x and y arrays: %.3f ms per step", ENTITY_COUNT, Median( splitSamples ) );
+
+  // Damping does not depend on the frame rate: with k = 2 any rate must leave exp(-2) of the velocity after a second
+  const int RATES[] = { 30, 60, 240 };
+  for( size_t r = 0; r < SDL_arraysize( RATES ); ++r ){
+    Position            positions[4]      = {};
+    Velocity            velocities[4]     = { { 100.0f, -100.0f }, { 100.0f, -100.0f }, { 100.0f, -100.0f },
+                                              { 100.0f, -100.0f } };
+    const Acceleration  accelerations[4]  = {};
+    const Damping       damping[4]        = { { 2.0f }, { 2.0f }, { 2.0f }, { 2.0f } };
+    for( int step = 0; step < RATES[r]; ++step ){
+      Movement::Integrate( positions, velocities, accelerations, damping, 4, 1.0f / RATES[r] );
+    }
+    const float expected = 100.0f * std::exp( -2.0f );
+    SDL_Log( "movement damping k = 2 at %3d Hz: velocity %.4f after 1 s, exp(-2) gives %.4f, %s", RATES[r],
+             velocities[0].x, expected, std::fabs( velocities[0].x - expected ) < 0.01f ? "ok" : "WRONG" );
+  }
+}
+
+/**********************************************************************************************************************/
+// ENTITIES
+/**********************************************************************************************************************/
+
+/**
+Drawing data of a sprite, carried along but not read by movement
+*/
+struct SpriteInfo
+{
+  SDL_Rect  mFrame;       ///< Source rect in the texture
+  Uint64    mTexture;     ///< Texture handle
+  char      mName[32];    ///< Debug name
+};
+
+/**
+One object per sprite holding all of its data, the layout of the game before EntityWorld
+*/
+struct SpriteObject
+{
+  Position    mPosition;
+  Velocity    mVelocity;
+  SpriteInfo  mInfo;
+};
+
+/**********************************************************************************************************************/
+
+/**
+Moves every sprite object by its velocity, objects allocated one by one
+*/
+static void StepObjects( std::vector<SpriteObject*> &objects, float deltaTime )
+{
+  for( size_t i = 0; i < objects.size(); ++i ){
+    objects[i]->mPosition.x += objects[i]->mVelocity.x * deltaTime;
+    objects[i]->mPosition.y += objects[i]->mVelocity.y * deltaTime;
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Moves every sprite object by its velocity, objects in one array
+*/
+static void StepObjects( std::vector<SpriteObject> &objects, float deltaTime )
+{
+  for( size_t i = 0; i < objects.size(); ++i ){
+    objects[i].mPosition.x += objects[i].mVelocity.x * deltaTime;
+    objects[i].mPosition.y += objects[i].mVelocity.y * deltaTime;
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Entity iteration over archetype chunks against the object layout it replaced, at a million sprites, and over entities
+with nothing but the iterated components. Then the cost of an entity created and destroyed right at a chunk boundary
+*/
+static void BenchmarkEntities( void )
+{
+  const Uint32  ENTITY_COUNT  = 1000000;
+  const int     STEP_COUNT    = 31;
+  const Uint32  CHURN_COUNT   = 100000;
+  const float   DELTA_TIME    = 1.0f / 60.0f;
+
+  // Objects allocated one by one and visited out of address order, as a heap looks after a while
+  RandomStream                random( 1 );
+  std::vector<SpriteObject*>  heapObjects( ENTITY_COUNT );
+  for( Uint32 i = 0; i < ENTITY_COUNT; ++i ){
+    heapObjects[i] = new SpriteObject();
+  }
+  for( Uint32 i = ENTITY_COUNT - 1; i > 0; --i ){
+    std::swap( heapObjects[i], heapObjects[random.NextRange( 0, static_cast<int>( i ) )] );
+  }
+
+  // The bare world only holds the two components movement reads
+  std::vector<SpriteObject> arrayObjects( ENTITY_COUNT );
+  EntityWorld               world;
+  EntityWorld               bare;
+  SpriteInfo                info = {};
+  for( Uint32 i = 0; i < ENTITY_COUNT; ++i ){
+    const Position position = { NextFloat( random, 0.0f, 4096.0f ), NextFloat( random, 0.0f, 4096.0f ) };
+    const Velocity velocity = { NextFloat( random, -100.0f, 100.0f ), NextFloat( random, -100.0f, 100.0f ) };
+    heapObjects[i]->mPosition   = position;
+    heapObjects[i]->mVelocity   = velocity;
+    arrayObjects[i].mPosition   = position;
+    arrayObjects[i].mVelocity   = velocity;
+    world.CreateEntity( position, velocity, info );
+    bare.CreateEntity( position, velocity );
+  }
+
+  std::vector<double> heapSamples;
+  std::vector<double> arraySamples;
+  std::vector<double> chunkSamples;
+  std::vector<double> bareSamples;
+  for( int step = 0; step < STEP_COUNT; ++step ){
+    Uint64 start = SDL_GetPerformanceCounter();
+    StepObjects( heapObjects, DELTA_TIME );
+    heapSamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    StepObjects( arrayObjects, DELTA_TIME );
+    arraySamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    world.ForEach<Position, const Velocity>( [DELTA_TIME]( Position &position, const Velocity &velocity ){
+      position.x += velocity.x * DELTA_TIME;
+      position.y += velocity.y * DELTA_TIME;
+    } );
+    chunkSamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    bare.ForEach<Position, const Velocity>( [DELTA_TIME]( Position &position, const Velocity &velocity ){
+      position.x += velocity.x * DELTA_TIME;
+      position.y += velocity.y * DELTA_TIME;
+    } );
+    bareSamples.push_back( GetMilliseconds( start ) );
+  }
+
+  // Entities are visited in creation order, like the objects
+  const std::vector<Position> positions     = GetPositions( world );
+  const std::vector<Position> barePositions = GetPositions( bare );
+  Uint32 mismatches = 0;
+  for( Uint32 i = 0; i < ENTITY_COUNT; ++i ){
+    const Position &heap  = heapObjects[i]->mPosition;
+    const Position &array = arrayObjects[i].mPosition;
+    mismatches += heap.x != positions[i].x || heap.y != positions[i].y || array.x != positions[i].x ||
+                  array.y != positions[i].y || barePositions[i].x != positions[i].x ||
+                  barePositions[i].y != positions[i].y ? 1 : 0;
+  }
+  for( Uint32 i = 0; i < ENTITY_COUNT; ++i ){
+    delete heapObjects[i];
+  }
+
+  SDL_Log( "entities %u sprites: heap objects %.3f ms, object array %.3f ms, archetype chunks %.3f ms per step, "
+           "%u positions differ", ENTITY_COUNT, Median( heapSamples ), Median( arraySamples ), Median( chunkSamples ),
+           mismatches );
+  SDL_Log( "entities %u with position and velocity only: %.3f ms per step", ENTITY_COUNT, Median( bareSamples ) );
+
+  // Fill the last chunk exactly, then cross its boundary back and forth
+  EntityWorld churn;
+  churn.CreateEntity( Position(), Velocity(), info );
+  Uint32 filled = 1;
+  for( size_t i = 0; i < churn.GetArchetypeCount(); ++i ){
+    const Archetype &archetype = churn.GetArchetype( i );
+    if( archetype.GetMask() == EntityWorld::MaskOf<Position, Velocity, SpriteInfo>() ){
+      filled = archetype.GetChunkCapacity() * 4;
+    }
+  }
+  for( Uint32 i = 1; i < filled; ++i ){
+    churn.CreateEntity( Position(), Velocity(), info );
+  }
+
+  const Uint64 start = SDL_GetPerformanceCounter();
+  for( Uint32 i = 0; i < CHURN_COUNT; ++i ){
+    churn.DestroyEntity( churn.CreateEntity( Position(), Velocity(), info ) );
+  }
+  const double churnMilliseconds = GetMilliseconds( start );
+  SDL_Log( "entities create and destroy at a chunk boundary: %.3f us per pair",
+           churnMilliseconds * 1000.0 / CHURN_COUNT );
+}
+
+/**********************************************************************************************************************/
+// PREFABS
+/**********************************************************************************************************************/
+
+/**
+Prefab spawning of a hundred thousand sprites sharing their drawing data, then the copy on write of one instance:
+the edited instance must see its value and every other instance the prefab one
+*/
+static void BenchmarkPrefab( void )
+{
+  const Uint32  INSTANCE_COUNT  = 100000;
+  const int     RUN_COUNT       = 11;
+
+  SpriteInfo look = {};
+  look.mFrame.w   = 32;
+  look.mFrame.h   = 32;
+  look.mTexture   = 1;
+
+  Prefab prefab;
+  prefab.SetInstanceValue( Position() );
+  prefab.SetInstanceValue( Velocity() );
+  prefab.SetSharedValue( look );
+
+  std::vector<double> spawnSamples;
+  std::vector<double> createSamples;
+  std::vector<Entity> instances( INSTANCE_COUNT );
+  for( int run = 0; run < RUN_COUNT; ++run ){
+    EntityWorld spawned;
+    Uint64 start = SDL_GetPerformanceCounter();
+    prefab.Spawn( spawned, INSTANCE_COUNT, &instances[0] );
+    spawnSamples.push_back( GetMilliseconds( start ) );
+
+    // The same entities made one by one, with the drawing data copied into each
+    EntityWorld created;
+    start = SDL_GetPerformanceCounter();
+    for( Uint32 i = 0; i < INSTANCE_COUNT; ++i ){
+      created.CreateEntity( Position(), Velocity(), look );
+    }
+    createSamples.push_back( GetMilliseconds( start ) );
+  }
+
+  EntityWorld world;
+  prefab.Spawn( world, INSTANCE_COUNT, &instances[0] );
+  const Entity edited = instances[INSTANCE_COUNT / 2];
+  SpriteInfo  *value  = Prefab::EditShared<SpriteInfo>( world, edited );
+  if( value != NULL ){
+    value->mTexture = 2;
+  }
+
+  Uint32 wrong = Prefab::GetShared<SpriteInfo>( world, edited ) == value && value != NULL ? 0 : 1;
+  for( Uint32 i = 0; i < INSTANCE_COUNT; ++i ){
+    const SpriteInfo *shared = Prefab::GetShared<SpriteInfo>( world, instances[i] );
+    wrong += instances[i] != edited && ( shared == NULL || shared->mTexture != 1 ) ? 1 : 0;
+  }
+  wrong += prefab.GetSharedValues().Get<SpriteInfo>()->mTexture != 1 ? 1 : 0;
+
+  // An entity given the component by mask has no block: reads and edits find nothing
+  const Entity bare = world.CreateEntity( ComponentType<SharedComponents>::GetMask() );
+  wrong += Prefab::GetShared<SpriteInfo>( world, bare ) != NULL ? 1 : 0;
+  wrong += Prefab::EditShared<SpriteInfo>( world, bare ) != NULL ? 1 : 0;
+
+  // The edited instance releases its own block, the others the prefab one
+  world.DestroyEntity( edited );
+  world.DestroyEntity( bare );
+
+  SDL_Log( "prefab %u instances: spawn %.3f ms, one by one with copied data %.3f ms, copy on write %s",
+           INSTANCE_COUNT, Median( spawnSamples ), Median( createSamples ), wrong == 0 ? "ok" : "WRONG" );
+}
+
+/**********************************************************************************************************************/
+// BROADPHASE
+/**********************************************************************************************************************/
+
+/**
+Placement of the objects of a benchmark scene
+*/
+enum SceneLayout
+{
+  LAYOUT_UNIFORM,       ///< Small objects spread over the whole world
+  LAYOUT_CLUSTERED,     ///< Small objects gathered in a few dense groups
+  LAYOUT_MIXED_SIZES,   ///< Uniform, with one object in ten four to eight times larger
+  LAYOUT_COUNT
+};
+
+static const char *LAYOUT_NAMES[LAYOUT_COUNT] = { "uniform", "clustered", "mixed" };
+
+/**********************************************************************************************************************/
+
+/**
+Objects moving a few pixels per frame and bouncing inside a square world
+*/
+struct MovingScene
+{
+  std::vector<SDL_Rect>   mRects;
+  std::vector<int>        mVelocityX;   ///< Pixels per frame
+  std::vector<int>        mVelocityY;
+  int                     mWorldSize;   ///< World side in pixels
+};
+
+/**********************************************************************************************************************/
+
+/**
+Fills a scene with objects of 8 to 32 pixels, placed as the layout says. The world grows with the object count so
+density stays the same, about a tenth of the world covered in the uniform layout
+*/
+static void CreateScene( MovingScene &scene, Uint32 count, SceneLayout layout )
+{
+  const int CLUSTER_COUNT = 16;
+
+  RandomStream random( count );
+  scene.mWorldSize = static_cast<int>( std::sqrt( static_cast<double>( count ) ) * 64.0 );
+  scene.mRects.resize( count );
+  scene.mVelocityX.resize( count );
+  scene.mVelocityY.resize( count );
+
+  // Clusters are squares holding the objects at four times the uniform density
+  const int clusterSize = scene.mWorldSize / 8;
+  SDL_Point clusters[CLUSTER_COUNT];
+  for( int i = 0; i < CLUSTER_COUNT; ++i ){
+    clusters[i].x = random.NextRange( 0, scene.mWorldSize - clusterSize );
+    clusters[i].y = random.NextRange( 0, scene.mWorldSize - clusterSize );
+  }
+
+  for( Uint32 i = 0; i < count; ++i ){
+    SDL_Rect &rect = scene.mRects[i];
+    const int scale = layout == LAYOUT_MIXED_SIZES && i % 10 == 0 ? 8 : 1;
+    rect.w = random.NextRange( 8 * scale, 32 * scale );
+    rect.h = random.NextRange( 8 * scale, 32 * scale );
+    if( layout == LAYOUT_CLUSTERED ){
+      const SDL_Point &cluster = clusters[i % CLUSTER_COUNT];
+      rect.x = cluster.x + random.NextRange( 0, clusterSize - rect.w );
+      rect.y = cluster.y + random.NextRange( 0, clusterSize - rect.h );
+    }
+    else{
+      rect.x = random.NextRange( 0, scene.mWorldSize - rect.w );
+      rect.y = random.NextRange( 0, scene.mWorldSize - rect.h );
+    }
+    scene.mVelocityX[i] = random.NextRange( -2, 2 );
+    scene.mVelocityY[i] = random.NextRange( -2, 2 );
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Moves every object of a scene by its velocity, bouncing on the world bounds
+*/
+static void StepScene( MovingScene &scene )
+{
+  for( size_t i = 0; i < scene.mRects.size(); ++i ){
+    SDL_Rect &rect = scene.mRects[i];
+    rect.x += scene.mVelocityX[i];
+    rect.y += scene.mVelocityY[i];
+    if( rect.x < 0 || rect.x + rect.w > scene.mWorldSize ){
+      scene.mVelocityX[i] = -scene.mVelocityX[i];
+      rect.x             += 2 * scene.mVelocityX[i];
+    }
+    if( rect.y < 0 || rect.y + rect.h > scene.mWorldSize ){
+      scene.mVelocityY[i] = -scene.mVelocityY[i];
+      rect.y             += 2 * scene.mVelocityY[i];
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Returns the number of overlapping pairs of a scene, testing every pair
+*/
+static Uint32 CountPairsBruteForce( const MovingScene &scene )
+{
+  Uint32 count = 0;
+  for( size_t i = 0; i < scene.mRects.size(); ++i ){
+    for( size_t j = i + 1; j < scene.mRects.size(); ++j ){
+      count += RectsOverlap( scene.mRects[i], scene.mRects[j] ) ? 1 : 0;
+    }
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+/**
+SpatialHashGrid moves and pair finding from 1k to 200k moving objects
+*/
+static void BenchmarkGrid( void )
+{
+  const Uint32  COUNTS[]      = { 1000, 10000, 50000, 100000, 200000 };
+  const int     FRAME_COUNT   = 21;
+  const Uint32  BRUTE_LIMIT   = 10000;    ///< Largest scene checked against every pair
+
+  for( size_t c = 0; c < SDL_arraysize( COUNTS ); ++c ){
+    MovingScene scene;
+    CreateScene( scene, COUNTS[c], LAYOUT_UNIFORM );
+
+    SpatialHashGrid       grid;
+    std::vector<ProxyId>  proxies( COUNTS[c] );
+    for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+      proxies[i] = grid.Insert( scene.mRects[i], i );
+    }
+
+    std::vector<BroadphasePair> pairs( COUNTS[c] * 4 );
+    std::vector<double>         moveSamples;
+    std::vector<double>         pairSamples;
+    Uint32                      pairCount = 0;
+    for( int frame = 0; frame < FRAME_COUNT; ++frame ){
+      StepScene( scene );
+
+      Uint64 start = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+        grid.Move( proxies[i], scene.mRects[i] );
+      }
+      moveSamples.push_back( GetMilliseconds( start ) );
+
+      start     = SDL_GetPerformanceCounter();
+      pairCount = grid.FindPairs( pairs.data(), static_cast<Uint32>( pairs.size() ) );
+      pairSamples.push_back( GetMilliseconds( start ) );
+    }
+
+    const char *check = "not checked";
+    if( COUNTS[c] <= BRUTE_LIMIT ){
+      check = CountPairsBruteForce( scene ) == pairCount ? "matches brute force" : "DIFFERS from brute force";
+    }
+    SDL_Log( "grid %6u objects: moves %.3f ms, pairs %.3f ms, %u pairs %s", COUNTS[c], Median( moveSamples ),
+             Median( pairSamples ), pairCount, check );
+  }
+}
+
+/**********************************************************************************************************************/
+
+/**
+Sorts pairs found by a broadphase, for comparison with another one
+@param pairs Pair buffer, resized to count
+@param count Pair count returned by FindPairs. If it exceeded the buffer the caller found them again after the resize
+*/
+static void SortPairs( std::vector<BroadphasePair> &pairs, Uint32 count )
+{
+  pairs.resize( count );
+  std::sort( pairs.begin(), pairs.end() );
+}
+
+/**********************************************************************************************************************/
+
+/**
+SweepAndPrune against SpatialHashGrid on every scene layout, moves and pair finding together. Both must report the
+same pairs
+*/
+static void BenchmarkBroadphase( void )
+{
+  const Uint32  COUNTS[]      = { 1000, 10000, 100000 };
+  const int     FRAME_COUNT   = 21;
+
+  for( int layout = 0; layout < LAYOUT_COUNT; ++layout ){
+    for( size_t c = 0; c < SDL_arraysize( COUNTS ); ++c ){
+      MovingScene scene;
+      CreateScene( scene, COUNTS[c], static_cast<SceneLayout>( layout ) );
+
+      SpatialHashGrid       grid;
+      SweepAndPrune         sweep;
+      std::vector<ProxyId>  gridProxies( COUNTS[c] );
+      std::vector<ProxyId>  sweepProxies( COUNTS[c] );
+      for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+        gridProxies[i]  = grid.Insert( scene.mRects[i], i );
+        sweepProxies[i] = sweep.Insert( scene.mRects[i], i );
+      }
+      sweep.Update();
+
+      std::vector<BroadphasePair> gridPairs( COUNTS[c] * 4 );
+      std::vector<BroadphasePair> sweepPairs( COUNTS[c] * 4 );
+      std::vector<double>         gridSamples;
+      std::vector<double>         sweepSamples;
+      Uint32                      gridCount   = 0;
+      Uint32                      sweepCount  = 0;
+      for( int frame = 0; frame < FRAME_COUNT; ++frame ){
+        StepScene( scene );
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+          grid.Move( gridProxies[i], scene.mRects[i] );
+        }
+        gridCount = grid.FindPairs( gridPairs.data(), static_cast<Uint32>( gridPairs.size() ) );
+        gridSamples.push_back( GetMilliseconds( start ) );
+
+        start = SDL_GetPerformanceCounter();
+        for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+          sweep.Move( sweepProxies[i], scene.mRects[i] );
+        }
+        sweep.Update();
+        sweepCount = sweep.FindPairs( sweepPairs.data(), static_cast<Uint32>( sweepPairs.size() ) );
+        sweepSamples.push_back( GetMilliseconds( start ) );
+      }
+
+      // Pairs of the last frame, found again if they did not fit
+      if( gridCount > gridPairs.size() ){
+        gridPairs.resize( gridCount );
+        grid.FindPairs( gridPairs.data(), gridCount );
+      }
+      if( sweepCount > sweepPairs.size() ){
+        sweepPairs.resize( sweepCount );
+        sweep.FindPairs( sweepPairs.data(), sweepCount );
+      }
+      SortPairs( gridPairs, gridCount );
+      SortPairs( sweepPairs, sweepCount );
+      const char *check = gridPairs == sweepPairs ? "same pairs" : "DIFFERENT pairs";
+
+      SDL_Log( "broadphase %-9s %6u objects: grid %.3f ms, sweep and prune %.3f ms, %u pairs, %s",
+               LAYOUT_NAMES[layout], COUNTS[c], Median( gridSamples ), Median( sweepSamples ), sweepCount, check );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+// TREE
+/**********************************************************************************************************************/
+
+/**
+DynamicAABBTree under moves, creates and destroys, its region queries checked against every live rect, then single
+queries against QueryBatch
+*/
+static void BenchmarkTree( void )
+{
+  const Uint32  OBJECT_COUNT  = 16384;
+  const int     FRAME_COUNT   = 61;
+  const int     RUN_COUNT     = 11;     ///< Timed runs of the last queries
+  const Uint32  CHURN_COUNT   = 160;    ///< Objects destroyed and created again every frame
+  const Uint32  QUERY_COUNT   = 1000;   ///< Checked queries per frame
+  const int     QUERY_SIZE    = 256;    ///< Largest query side in pixels
+
+  MovingScene scene;
+  CreateScene( scene, OBJECT_COUNT, LAYOUT_UNIFORM );
+
+  DynamicAABBTree       tree;
+  std::vector<ProxyId>  proxies( OBJECT_COUNT );
+  for( Uint32 i = 0; i < OBJECT_COUNT; ++i ){
+    proxies[i] = tree.CreateProxy( scene.mRects[i], i );
+  }
+
+  RandomStream                random( 5 );
+  std::vector<SDL_Rect>       regions( QUERY_COUNT );
+  std::vector<ProxyId>        found( OBJECT_COUNT );
+  std::vector<ProxyId>        expected;
+  std::vector<double>         moveSamples;
+  Uint32                      mismatches = 0;
+  for( int frame = 0; frame < FRAME_COUNT; ++frame ){
+    StepScene( scene );
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( Uint32 i = 0; i < OBJECT_COUNT; ++i ){
+      tree.MoveProxy( proxies[i], scene.mRects[i], static_cast<float>( scene.mVelocityX[i] ),
+                      static_cast<float>( scene.mVelocityY[i] ) );
+    }
+    moveSamples.push_back( GetMilliseconds( start ) );
+
+    // Ids freed here are handed out again by the creates
+    for( Uint32 c = 0; c < CHURN_COUNT; ++c ){
+      const Uint32 i = static_cast<Uint32>( random.NextRange( 0, static_cast<int>( OBJECT_COUNT ) - 1 ) );
+      tree.DestroyProxy( proxies[i] );
+      proxies[i] = tree.CreateProxy( scene.mRects[i], i );
+    }
+
+    for( Uint32 q = 0; q < QUERY_COUNT; ++q ){
+      SDL_Rect &region = regions[q];
+      region.w = random.NextRange( 1, QUERY_SIZE );
+      region.h = random.NextRange( 1, QUERY_SIZE );
+      region.x = random.NextRange( -QUERY_SIZE, scene.mWorldSize );
+      region.y = random.NextRange( -QUERY_SIZE, scene.mWorldSize );
+    }
+
+    for( Uint32 q = 0; q < QUERY_COUNT; ++q ){
+      const Uint32 count = tree.Query( regions[q], found.data(), static_cast<Uint32>( found.size() ) );
+      expected.clear();
+      for( Uint32 i = 0; i < OBJECT_COUNT; ++i ){
+        if( RectsOverlap( scene.mRects[i], regions[q] ) ){
+          expected.push_back( proxies[i] );
+        }
+      }
+      std::sort( found.begin(), found.begin() + count );
+      std::sort( expected.begin(), expected.end() );
+      mismatches += count != expected.size() || !std::equal( expected.begin(), expected.end(), found.begin() ) ? 1 : 0;
+    }
+  }
+  SDL_Log( "tree %u objects, height %d: moves %.3f ms per frame, %u of %u queries differ from brute force",
+           OBJECT_COUNT, tree.GetHeight(), Median( moveSamples ), mismatches, QUERY_COUNT * FRAME_COUNT );
+
+  // The last regions one by one on this thread, spread over the JobManager and tested against every rect
+  std::vector< std::vector<ProxyId> > batchResults( QUERY_COUNT );
+  std::vector<double>                 singleSamples;
+  std::vector<double>                 batchSamples;
+  std::vector<double>                 bruteSamples;
+  Uint32                              batchMismatches = 0;
+  Uint32                              bruteCount      = 0;
+  for( int run = 0; run < RUN_COUNT; ++run ){
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( Uint32 q = 0; q < QUERY_COUNT; ++q ){
+      tree.Query( regions[q], found.data(), static_cast<Uint32>( found.size() ) );
+    }
+    singleSamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    tree.QueryBatch( regions.data(), batchResults.data(), QUERY_COUNT );
+    batchSamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    for( Uint32 q = 0; q < QUERY_COUNT; ++q ){
+      for( Uint32 i = 0; i < OBJECT_COUNT; ++i ){
+        bruteCount += RectsOverlap( scene.mRects[i], regions[q] ) ? 1 : 0;
+      }
+    }
+    bruteSamples.push_back( GetMilliseconds( start ) );
+  }
+  for( Uint32 q = 0; q < QUERY_COUNT; ++q ){
+    const Uint32 count = tree.Query( regions[q], found.data(), static_cast<Uint32>( found.size() ) );
+    std::sort( found.begin(), found.begin() + count );
+    std::sort( batchResults[q].begin(), batchResults[q].end() );
+    batchMismatches += count != batchResults[q].size() ||
+                       !std::equal( batchResults[q].begin(), batchResults[q].end(), found.begin() ) ? 1 : 0;
+  }
+  SDL_Log( "tree %u queries: one by one %.3f ms, QueryBatch on %u workers %.3f ms with %u differing, brute force "
+           "%.3f ms for %u hits", QUERY_COUNT, Median( singleSamples ), JobManager::GetInstance().GetWorkerCount(),
+           Median( batchSamples ), batchMismatches, Median( bruteSamples ), bruteCount / RUN_COUNT );
+}
+
+/**********************************************************************************************************************/
+// MASKS
+/**********************************************************************************************************************/
+
+/**
+Creates the mask of a sprite shaped like a disc filling the image, with one pixel in five of the disc transparent
+*/
+static CollisionMask *CreateSpriteMask( int size, RandomStream &random )
+{
+  SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat( 0, size, size, 32, SDL_PIXELFORMAT_ARGB8888 );
+  if( surface == NULL ){
+    return NULL;
+  }
+
+  const float radius = size * 0.5f;
+  for( int y = 0; y < size; ++y ){
+    Uint32 *row = reinterpret_cast<Uint32*>( static_cast<Uint8*>( surface->pixels ) + y * surface->pitch );
+    for( int x = 0; x < size; ++x ){
+      const float dx     = x + 0.5f - radius;
+      const float dy     = y + 0.5f - radius;
+      const bool  inside = dx * dx + dy * dy <= radius * radius && random.NextRange( 0, 4 ) != 0;
+      row[x] = inside ? 0xFF808080 : 0x00808080;
+    }
+  }
+
+  CollisionMask *mask = new CollisionMask( surface );
+  SDL_FreeSurface( surface );
+  return mask;
+}
+
+/**********************************************************************************************************************/
+
+/**
+Returns true if two placed masks have a solid pixel in common, testing every pixel of their common rect
+*/
+static bool OverlapPerPixel( const CollisionMask &a, int ax, int ay, const CollisionMask &b, int bx, int by )
+{
+  const int left    = SDL_max( ax, bx );
+  const int top     = SDL_max( ay, by );
+  const int right   = SDL_min( ax + a.GetWidth(), bx + b.GetWidth() );
+  const int bottom  = SDL_min( ay + a.GetHeight(), by + b.GetHeight() );
+  for( int y = top; y < bottom; ++y ){
+    for( int x = left; x < right; ++x ){
+      if( a.TestPoint( x - ax, y - ay ) && b.TestPoint( x - bx, y - by ) ){
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**********************************************************************************************************************/
+
+/**
+CollisionMask::Overlap checked against a per pixel test over random placements of masks from 1x1 to 250x250, then
+timed on overlapping sprites of the same size, next to the rect test it refines
+*/
+static void BenchmarkMasks( void )
+{
+  const int     SIZES[]       = { 1, 7, 16, 33, 64, 65, 100, 128, 200, 250 };
+  const int     TIMED_SIZES[] = { 64, 128, 250 };
+  const Uint32  CHECK_COUNT   = 200000;
+  const Uint32  TIMED_COUNT   = 100000;
+  const int     RUN_COUNT     = 11;
+
+  RandomStream                  random( 6 );
+  std::vector<CollisionMask*>   masks;
+  for( size_t i = 0; i < SDL_arraysize( SIZES ); ++i ){
+    CollisionMask *mask = CreateSpriteMask( SIZES[i], random );
+    if( mask == NULL ){
+      SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "masks: unable to create a surface: %s", SDL_GetError() );
+      for( size_t m = 0; m < masks.size(); ++m ){
+        delete masks[m];
+      }
+      return;
+    }
+    masks.push_back( mask );
+  }
+
+  // Offsets keep the images close so most placements overlap at least their rects
+  Uint32 mismatches = 0;
+  Uint32 overlaps   = 0;
+  for( Uint32 i = 0; i < CHECK_COUNT; ++i ){
+    const CollisionMask &a  = *masks[random.NextRange( 0, static_cast<int>( masks.size() ) - 1 )];
+    const CollisionMask &b  = *masks[random.NextRange( 0, static_cast<int>( masks.size() ) - 1 )];
+    const int            bx = random.NextRange( -b.GetWidth(), a.GetWidth() );
+    const int            by = random.NextRange( -b.GetHeight(), a.GetHeight() );
+    const bool           hit = CollisionMask::Overlap( a, 0, 0, b, bx, by );
+    mismatches += hit != OverlapPerPixel( a, 0, 0, b, bx, by ) ? 1 : 0;
+    overlaps   += hit ? 1 : 0;
+  }
+  SDL_Log( "masks %u placements of %u sizes: %u overlap, %u differ from the per pixel test", CHECK_COUNT,
+           static_cast<Uint32>( masks.size() ), overlaps, mismatches );
+
+  for( size_t t = 0; t < SDL_arraysize( TIMED_SIZES ); ++t ){
+    const int      size = TIMED_SIZES[t];
+    CollisionMask *a    = CreateSpriteMask( size, random );
+    CollisionMask *b    = CreateSpriteMask( size, random );
+    if( a == NULL || b == NULL ){
+      delete a;
+      delete b;
+      continue;
+    }
+
+    std::vector<SDL_Point> offsets( TIMED_COUNT );
+    for( Uint32 i = 0; i < TIMED_COUNT; ++i ){
+      offsets[i].x = random.NextRange( 1 - size, size - 1 );
+      offsets[i].y = random.NextRange( 1 - size, size - 1 );
+    }
+
+    const SDL_Rect      rectA = { 0, 0, size, size };
+    std::vector<double> maskSamples;
+    std::vector<double> rectSamples;
+    Uint32              maskHits = 0;
+    Uint32              rectHits = 0;
+    for( int run = 0; run < RUN_COUNT; ++run ){
+      maskHits = 0;
+      Uint64 start = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < TIMED_COUNT; ++i ){
+        maskHits += CollisionMask::Overlap( *a, 0, 0, *b, offsets[i].x, offsets[i].y ) ? 1 : 0;
+      }
+      maskSamples.push_back( GetMilliseconds( start ) );
+
+      rectHits = 0;
+      start    = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < TIMED_COUNT; ++i ){
+        const SDL_Rect rectB = { offsets[i].x, offsets[i].y, size, size };
+        rectHits += RectsOverlap( rectA, rectB ) ? 1 : 0;
+      }
+      rectSamples.push_back( GetMilliseconds( start ) );
+    }
+    SDL_Log( "masks %3dx%-3d overlapping rects: mask test %.1f ns, rect test %.1f ns, %u of %u rect overlaps hit",
+             size, size, Median( maskSamples ) * 1e6 / TIMED_COUNT, Median( rectSamples ) * 1e6 / TIMED_COUNT,
+             maskHits, rectHits );
+    delete a;
+    delete b;
+  }
+
+  for( size_t m = 0; m < masks.size(); ++m ){
+    delete masks[m];
+  }
+}
+
+/**********************************************************************************************************************/
+// CONTINUOUS COLLISION
+/**********************************************************************************************************************/
+
+/**
+Moves every collider by its velocity, the step MovementSystem runs before ContinuousCollisionSystem
+*/
+static void MoveColliders( EntityWorld &world, float deltaTime )
+{
+  world.ForEach<Position, const Velocity>( [deltaTime]( Position &position, const Velocity &velocity ){
+    position.x += velocity.x * deltaTime;
+    position.y += velocity.y * deltaTime;
+  } );
+}
+
+/**********************************************************************************************************************/
+
+/**
+Creates a square body with its proxy in the tree, its previous position being the current one
+*/
+static Entity CreateBody( EntityWorld &world, DynamicAABBTree &tree, const Position &position,
+                          const Velocity &velocity, float size, bool continuous )
+{
+  const int       side      = static_cast<int>( size );
+  const SDL_Rect  rect      = { static_cast<int>( position.x ), static_cast<int>( position.y ), side, side };
+  Collider        collider  = {};
+  collider.mProxy       = tree.CreateProxy( rect );
+  collider.mWidth       = size;
+  collider.mHeight      = size;
+  collider.mPreviousX   = position.x;
+  collider.mPreviousY   = position.y;
+  collider.mContinuous  = continuous ? 1 : 0;
+  return world.CreateEntity( position, velocity, collider );
+}
+
+/**********************************************************************************************************************/
+
+/**
+Bullets shot at a thin wall, with and without sweeps, then the cost of a step against the number of fast bodies
+*/
+static void BenchmarkContinuousCollision( void )
+{
+  const int     RUN_COUNT     = 100;
+  const int     STEP_COUNT    = 21;
+  const float   DELTA_TIME    = 1.0f / 60.0f;
+  const float   BULLET_SIZE   = 4.0f;
+  const SDL_Rect WALL         = { 200, 0, 4, 400 };
+
+  // A discrete test only sees the wall if a step ends overlapping it. The sweep must stop every bullet before it
+  RandomStream random( 1 );
+  Uint32       missed    = 0;
+  Uint32       tunneled  = 0;
+  for( int run = 0; run < RUN_COUNT; ++run ){
+    const Position start  = { NextFloat( random, 0.0f, 40.0f ), NextFloat( random, 100.0f, 300.0f ) };
+    const Velocity speed  = { NextFloat( random, 1500.0f, 2500.0f ), 0.0f };
+
+    for( int continuous = 0; continuous < 2; ++continuous ){
+      EntityWorld     world;
+      DynamicAABBTree tree;
+      tree.CreateProxy( WALL );
+      const Entity bullet = CreateBody( world, tree, start, speed, BULLET_SIZE, continuous != 0 );
+      ContinuousCollisionSystem system( tree );
+
+      bool seen = false;
+      for( int step = 0; step < STEP_COUNT; ++step ){
+        MoveColliders( world, DELTA_TIME );
+        system.Update( world, DELTA_TIME );
+        const Position &position = *world.GetComponent<Position>( bullet );
+        seen |= position.x + BULLET_SIZE > WALL.x && position.x < WALL.x + WALL.w;
+      }
+
+      const Position &position = *world.GetComponent<Position>( bullet );
+      if( continuous ){
+        tunneled += position.x + BULLET_SIZE > WALL.x ? 1 : 0;
+      }
+      else{
+        missed += seen ? 0 : 1;
+      }
+    }
+  }
+  SDL_Log( "ccd %dx%d bullets at 1500-2500 px/s through a %d px wall: discrete misses %u/%d, sweep lets %u/%d through",
+           static_cast<int>( BULLET_SIZE ), static_cast<int>( BULLET_SIZE ), WALL.w, missed, RUN_COUNT, tunneled,
+           RUN_COUNT );
+
+  // Cost of a step over ten thousand bodies among static rects, against the number of fast ones
+  const Uint32  BODY_COUNT      = 10000;
+  const Uint32  OBSTACLE_COUNT  = 3000;
+  const Uint32  FAST_COUNTS[]   = { 0, 100, 1000 };
+  const float   WORLD_SIZE      = 4096.0f;
+
+  for( size_t f = 0; f < SDL_arraysize( FAST_COUNTS ); ++f ){
+    RandomStream    scene( 2 );
+    EntityWorld     world;
+    DynamicAABBTree tree;
+    for( Uint32 i = 0; i < OBSTACLE_COUNT; ++i ){
+      const SDL_Rect rect = { scene.NextRange( 0, 4064 ), scene.NextRange( 0, 4064 ), scene.NextRange( 4, 32 ),
+                              scene.NextRange( 4, 32 ) };
+      tree.CreateProxy( rect );
+    }
+
+    std::vector<Velocity> velocities( BODY_COUNT );
+    for( Uint32 i = 0; i < BODY_COUNT; ++i ){
+      const bool      fast      = i < FAST_COUNTS[f];
+      const float     speed     = fast ? 2000.0f : 30.0f;
+      const Position  position  = { NextFloat( scene, 0.0f, WORLD_SIZE ), NextFloat( scene, 0.0f, WORLD_SIZE ) };
+      velocities[i].x = NextFloat( scene, -speed, speed );
+      velocities[i].y = NextFloat( scene, -speed, speed );
+      CreateBody( world, tree, position, velocities[i], 8.0f, fast );
+    }
+    ContinuousCollisionSystem system( tree );
+
+    std::vector<double> samples;
+    Uint32              sweeps = 0;
+    for( int step = 0; step < STEP_COUNT; ++step ){
+      // Hits zero the velocity: give it back, and wrap bodies leaving the world without sweeping the jump
+      Uint32 index = 0;
+      world.ForEach<Position, Velocity, Collider>(
+        [&velocities, &index, WORLD_SIZE]( Position &position, Velocity &velocity, Collider &collider ){
+          velocity = velocities[index++];
+          if( position.x < 0.0f || position.x > WORLD_SIZE || position.y < 0.0f || position.y > WORLD_SIZE ){
+            position.x          = std::fmod( position.x + WORLD_SIZE, WORLD_SIZE );
+            position.y          = std::fmod( position.y + WORLD_SIZE, WORLD_SIZE );
+            collider.mPreviousX = position.x;
+            collider.mPreviousY = position.y;
+          }
+        } );
+      MoveColliders( world, DELTA_TIME );
+
+      const Uint64 start = SDL_GetPerformanceCounter();
+      system.Update( world, DELTA_TIME );
+      samples.push_back( GetMilliseconds( start ) );
+      sweeps = system.GetSweepCount();
+    }
+
+    SDL_Log( "ccd %u bodies over %u rects, %4u fast: %.3f ms per step, %u sweeps", BODY_COUNT, OBSTACLE_COUNT,
+             FAST_COUNTS[f], Median( samples ), sweeps );
+  }
+}
+
+/**********************************************************************************************************************/
+// CONTACTS
+/**********************************************************************************************************************/
+
+/**
+ContactSolver on the calling thread and on the JobManager, over the pairs of clustered scenes. Both must end with the
+same bodies and contacts bit for bit
+*/
+static void BenchmarkContacts( void )
+{
+  const Uint32  COUNTS[]    = { 10000, 100000 };
+  const int     STEP_COUNT  = 21;
+
+  for( size_t c = 0; c < SDL_arraysize( COUNTS ); ++c ){
+    MovingScene scene;
+    CreateScene( scene, COUNTS[c], LAYOUT_CLUSTERED );
+
+    // Bodies are indexed by proxy, one in eight is static
+    SpatialHashGrid                     grid;
+    std::vector<ContactSolver::Body>    start;
+    for( Uint32 i = 0; i < COUNTS[c]; ++i ){
+      const SDL_Rect &rect  = scene.mRects[i];
+      const ProxyId   proxy = grid.Insert( rect, i );
+      if( proxy >= start.size() ){
+        start.resize( proxy + 1 );
+      }
+      ContactSolver::Body &body = start[proxy];
+      body.mX           = static_cast<float>( rect.x );
+      body.mY           = static_cast<float>( rect.y );
+      body.mWidth       = static_cast<float>( rect.w );
+      body.mHeight      = static_cast<float>( rect.h );
+      body.mVelocityX   = static_cast<float>( scene.mVelocityX[i] * 60 );
+      body.mVelocityY   = static_cast<float>( scene.mVelocityY[i] * 60 );
+      body.mInverseMass = i % 8 == 0 ? 0.0f : 1.0f / static_cast<float>( rect.w * rect.h );
+    }
+
+    std::vector<BroadphasePair> pairs( COUNTS[c] * 4 );
+    Uint32 pairCount = grid.FindPairs( pairs.data(), static_cast<Uint32>( pairs.size() ) );
+    if( pairCount > pairs.size() ){
+      pairs.resize( pairCount );
+      pairCount = grid.FindPairs( pairs.data(), pairCount );
+    }
+
+    // Each run solves the same pairs for several steps, so later steps start from bodies moved by the earlier ones
+    ContactSolver                     serialSolver;
+    ContactSolver                     parallelSolver;
+    std::vector<ContactSolver::Body>  serialBodies( start );
+    std::vector<ContactSolver::Body>  parallelBodies( start );
+    std::vector<double>               serialSamples;
+    std::vector<double>               parallelSamples;
+    Uint32                            contactCount = 0;
+    for( int step = 0; step < STEP_COUNT; ++step ){
+      Uint64 begin = SDL_GetPerformanceCounter();
+      contactCount = serialSolver.Solve( serialBodies.data(), pairs.data(), pairCount, false );
+      serialSamples.push_back( GetMilliseconds( begin ) );
+
+      begin = SDL_GetPerformanceCounter();
+      parallelSolver.Solve( parallelBodies.data(), pairs.data(), pairCount, true );
+      parallelSamples.push_back( GetMilliseconds( begin ) );
+    }
+
+    const std::vector<ContactSolver::Contact> &serialContacts   = serialSolver.GetContacts();
+    const std::vector<ContactSolver::Contact> &parallelContacts = parallelSolver.GetContacts();
+    const bool same = serialContacts.size() == parallelContacts.size() &&
+                      std::memcmp( serialContacts.data(), parallelContacts.data(),
+                                   serialContacts.size() * sizeof( ContactSolver::Contact ) ) == 0 &&
+                      std::memcmp( serialBodies.data(), parallelBodies.data(),
+                                   serialBodies.size() * sizeof( ContactSolver::Body ) ) == 0;
+    SDL_Log( "contacts %6u bodies, %u pairs, %u contacts: serial %.3f ms, %u workers %.3f ms, %s", COUNTS[c],
+             pairCount, contactCount, Median( serialSamples ), JobManager::GetInstance().GetWorkerCount(),
+             Median( parallelSamples ), same ? "bit identical" : "DIFFERENT results" );
+  }
+}
+
+/**********************************************************************************************************************/
+// TILES
+/**********************************************************************************************************************/
+
+/**
+Tile holding a pixel coordinate, rounding down for negative ones. Integer floors like the map, so the comparison
+measures the tile tests and not the conversions
+*/
+static int ToTile( float pixel, int tileSize )
+{
+  int floor = static_cast<int>( pixel );
+  floor -= pixel < static_cast<float>( floor ) ? 1 : 0;
+  return floor >= 0 ? floor / tileSize : -( ( tileSize - 1 - floor ) / tileSize );
+}
+
+/**
+Last tile covered by [start, start + size): a side exactly on a tile border does not touch the next tile
+*/
+static int ToLastTile( float start, float size, int tileSize )
+{
+  const float end   = start + size;
+  int         pixel = static_cast<int>( end );
+  pixel += end > static_cast<float>( pixel ) ? 1 : 0;
+  return ToTile( static_cast<float>( pixel - 1 ), tileSize );
+}
+
+/**********************************************************************************************************************/
+
+/**
+TileCollisionMap::Move written the obvious way, testing every tile entered with IsSolid. Same rules: horizontal first,
+tiles covered at the start never block, a side on a tile border does not touch the next tile
+*/
+static TileCollisionMap::MoveResult MovePerTile( const TileCollisionMap &map, float x, float y, float w, float h,
+                                                 float dx, float dy )
+{
+  const int                     size      = map.GetTileSize();
+  TileCollisionMap::MoveResult  result    = { x + dx, y, false, false };
+  const int                     firstRow  = ToTile( y, size );
+  const int                     lastRow   = ToLastTile( y, h, size );
+
+  if( dx > 0.0f ){
+    const int last = ToLastTile( x + dx, w, size );
+    for( int column = ToLastTile( x, w, size ) + 1; column <= last && !result.mHitX; ++column ){
+      for( int row = firstRow; row <= lastRow; ++row ){
+        if( map.IsSolid( column, row ) ){
+          result.mX     = static_cast<float>( column * size ) - w;
+          result.mHitX  = true;
+          break;
+        }
+      }
+    }
+  }
+  else if( dx < 0.0f ){
+    for( int column = ToTile( x, size ) - 1, last = ToTile( x + dx, size ); column >= last && !result.mHitX; --column ){
+      for( int row = firstRow; row <= lastRow; ++row ){
+        if( map.IsSolid( column, row ) ){
+          result.mX     = static_cast<float>( ( column + 1 ) * size );
+          result.mHitX  = true;
+          break;
+        }
+      }
+    }
+  }
+
+  result.mY = y + dy;
+  const int firstColumn = ToTile( result.mX, size );
+  const int lastColumn  = ToLastTile( result.mX, w, size );
+  if( dy > 0.0f ){
+    const int last = ToLastTile( y + dy, h, size );
+    for( int row = lastRow + 1; row <= last && !result.mHitY; ++row ){
+      for( int column = firstColumn; column <= lastColumn; ++column ){
+        if( map.IsSolid( column, row ) ){
+          result.mY     = static_cast<float>( row * size ) - h;
+          result.mHitY  = true;
+          break;
+        }
+      }
+    }
+  }
+  else if( dy < 0.0f ){
+    for( int row = firstRow - 1, last = ToTile( y + dy, size ); row >= last && !result.mHitY; --row ){
+      for( int column = firstColumn; column <= lastColumn; ++column ){
+        if( map.IsSolid( column, row ) ){
+          result.mY     = static_cast<float>( ( row + 1 ) * size );
+          result.mHitY  = true;
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/**********************************************************************************************************************/
+
+/**
+TileCollisionMap::Move against the per tile loop on a cave like map, for walking and for fast boxes. Both must stop
+every box at the same place
+*/
+static void BenchmarkTiles( void )
+{
+  const int     MAP_SIZE      = 512;
+  const int     TILE_SIZE     = 16;
+  const Uint32  MOVE_COUNT    = 100000;
+  const int     RUN_COUNT     = 11;
+  const float   SPEEDS[]      = { 4.0f, 64.0f, 512.0f };  ///< Largest displacement per move, in pixels
+
+  // One tile in forty solid, plus a wall every 32 tiles with gaps so fast boxes still travel
+  RandomStream      random( 3 );
+  TileCollisionMap  map( MAP_SIZE, MAP_SIZE, TILE_SIZE );
+  for( int row = 0; row < MAP_SIZE; ++row ){
+    for( int column = 0; column < MAP_SIZE; ++column ){
+      const bool wall = ( column % 32 == 0 || row % 32 == 0 ) && random.NextRange( 0, 3 ) != 0;
+      map.SetSolid( column, row, wall || random.NextRange( 0, 39 ) == 0 );
+    }
+  }
+
+  struct TileMove
+  {
+    float mX, mY, mW, mH, mDX, mDY;
+  };
+
+  for( size_t s = 0; s < SDL_arraysize( SPEEDS ); ++s ){
+    std::vector<TileMove> moves( MOVE_COUNT );
+    for( Uint32 i = 0; i < MOVE_COUNT; ++i ){
+      TileMove &move = moves[i];
+      move.mX   = NextFloat( random, 0.0f, static_cast<float>( MAP_SIZE * TILE_SIZE ) );
+      move.mY   = NextFloat( random, 0.0f, static_cast<float>( MAP_SIZE * TILE_SIZE ) );
+      move.mW   = NextFloat( random, 8.0f, 40.0f );
+      move.mH   = NextFloat( random, 8.0f, 40.0f );
+      move.mDX  = NextFloat( random, -SPEEDS[s], SPEEDS[s] );
+      move.mDY  = NextFloat( random, -SPEEDS[s], SPEEDS[s] );
+    }
+
+    std::vector<TileCollisionMap::MoveResult> masked( MOVE_COUNT );
+    std::vector<TileCollisionMap::MoveResult> perTile( MOVE_COUNT );
+    std::vector<double>                       maskedSamples;
+    std::vector<double>                       perTileSamples;
+    for( int run = 0; run < RUN_COUNT; ++run ){
+      Uint64 start = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < MOVE_COUNT; ++i ){
+        const TileMove &move = moves[i];
+        masked[i] = map.Move( move.mX, move.mY, move.mW, move.mH, move.mDX, move.mDY );
+      }
+      maskedSamples.push_back( GetMilliseconds( start ) );
+
+      start = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < MOVE_COUNT; ++i ){
+        const TileMove &move = moves[i];
+        perTile[i] = MovePerTile( map, move.mX, move.mY, move.mW, move.mH, move.mDX, move.mDY );
+      }
+      perTileSamples.push_back( GetMilliseconds( start ) );
+    }
+
+    Uint32 differences = 0;
+    Uint32 hits        = 0;
+    for( Uint32 i = 0; i < MOVE_COUNT; ++i ){
+      differences += masked[i].mX != perTile[i].mX || masked[i].mY != perTile[i].mY ||
+                     masked[i].mHitX != perTile[i].mHitX || masked[i].mHitY != perTile[i].mHitY ? 1 : 0;
+      hits        += masked[i].mHitX || masked[i].mHitY ? 1 : 0;
+    }
+    SDL_Log( "tiles %u moves up to %3.0f px, %u blocked: bitmask %.3f ms, per tile %.3f ms, %s", MOVE_COUNT, SPEEDS[s],
+             hits, Median( maskedSamples ), Median( perTileSamples ), differences ? "RESULTS DIFFER" : "same results" );
+    if( differences ){
+      SDL_Log( "tiles %u moves out of %u differ", differences, MOVE_COUNT );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+// ARCHIVE
+/**********************************************************************************************************************/
+
+/**
+Reads a whole RWops into a buffer and closes it
+@return False if rw is NULL or the read failed
+*/
+static bool ReadAll( SDL_RWops *rw, std::vector<Uint8> &data )
+{
+  if( rw == NULL ){
+    return false;
+  }
+  const Sint64 size = SDL_RWsize( rw );
+  data.resize( size > 0 ? static_cast<size_t>( size ) : 0 );
+  const bool read = size >= 0 && ( data.empty() || SDL_RWread( rw, &data[0], data.size(), 1 ) == 1 );
+  SDL_RWclose( rw );
+  return read;
+}
+
+/**********************************************************************************************************************/
+
+/**
+Loads a synthetic asset set from loose files and from an archive packed from them, as a startup does: the archive is
+opened again on every pass. The first pass of each is the cold one of the process, the others are warm. The files
+were just written so the OS cache holds them for both: this compares the open and read paths, not disk latency
+*/
+static void BenchmarkArchive( void )
+{
+  const Uint32  ASSET_COUNT = 300;
+  const int     PASS_COUNT  = 11;
+
+  char *folder = SDL_GetPrefPath( "Engine", "Benchmark" );
+  if( folder == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "archive: no folder to write the assets to: %s", SDL_GetError() );
+    return;
+  }
+  const std::string root( folder );
+  SDL_free( folder );
+  const std::string archivePath = root + "benchmark.apak";
+
+  // Mostly sprites of 1 to 64 KB, one in fifty a 512 KB sheet
+  RandomStream                      random( 4 );
+  std::vector<std::string>          paths( ASSET_COUNT );
+  std::vector< std::vector<Uint8> > contents( ASSET_COUNT );
+  Uint64                            totalSize = 0;
+  bool                              written   = true;
+  for( Uint32 i = 0; i < ASSET_COUNT && written; ++i ){
+    char name[32];
+    SDL_snprintf( name, sizeof( name ), "benchmark_%03u.bin", i );
+    paths[i] = name;
+    contents[i].resize( i % 50 == 0 ? 512 * 1024 : static_cast<size_t>( random.NextRange( 1, 64 ) ) * 1024 );
+    for( size_t b = 0; b < contents[i].size(); ++b ){
+      contents[i][b] = static_cast<Uint8>( random.NextRange( 0, 255 ) );
+    }
+    totalSize += contents[i].size();
+
+    SDL_RWops *file = SDL_RWFromFile( ( root + name ).c_str(), "wb" );
+    written = file != NULL && SDL_RWwrite( file, &contents[i][0], contents[i].size(), 1 ) == 1;
+    if( file != NULL ){
+      SDL_RWclose( file );
+    }
+  }
+
+  if( written && AssetArchive::Pack( archivePath, root, paths ) ){
+    std::vector< std::vector<Uint8> > loose( ASSET_COUNT );
+    std::vector< std::vector<Uint8> > archived( ASSET_COUNT );
+    std::vector<double>               looseSamples;
+    std::vector<double>               archiveSamples;
+    bool                              read = true;
+    for( int pass = 0; pass < PASS_COUNT; ++pass ){
+      Uint64 start = SDL_GetPerformanceCounter();
+      for( Uint32 i = 0; i < ASSET_COUNT; ++i ){
+        read &= ReadAll( SDL_RWFromFile( ( root + paths[i] ).c_str(), "rb" ), loose[i] );
+      }
+      looseSamples.push_back( GetMilliseconds( start ) );
+
+      start = SDL_GetPerformanceCounter();
+      AssetArchive archive;
+      read &= archive.Open( archivePath );
+      for( Uint32 i = 0; i < ASSET_COUNT && archive.IsOpen(); ++i ){
+        read &= ReadAll( archive.OpenAsset( paths[i] ), archived[i] );
+      }
+      archiveSamples.push_back( GetMilliseconds( start ) );
+    }
+
+    Uint32 differences = 0;
+    for( Uint32 i = 0; i < ASSET_COUNT; ++i ){
+      differences += loose[i] != contents[i] || archived[i] != contents[i] ? 1 : 0;
+    }
+    const double cold[2] = { looseSamples[0], archiveSamples[0] };
+    looseSamples.erase( looseSamples.begin() );
+    archiveSamples.erase( archiveSamples.begin() );
+    SDL_Log( "archive %u assets, %u KB: loose cold %.3f ms warm %.3f ms, archive cold %.3f ms warm %.3f ms, %s",
+             ASSET_COUNT, static_cast<Uint32>( totalSize / 1024 ), cold[0], Median( looseSamples ), cold[1],
+             Median( archiveSamples ), !read ? "READ FAILED" : differences ? "BYTES DIFFER" : "same bytes" );
+  }
+  else{
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "archive: unable to write the assets to %s", root.c_str() );
+  }
+
+  for( Uint32 i = 0; i < ASSET_COUNT; ++i ){
+    std::remove( ( root + paths[i] ).c_str() );
+  }
+  std::remove( archivePath.c_str() );
+}
+
+/**********************************************************************************************************************/
+// STREAMER
+/**********************************************************************************************************************/
+
+/**
+Streams 200 files of 1 MB the way a level load does: the level content is requested at random world positions in the
+normal band, then a fifth of the files in the high band, and one level request in eight is cancelled right away. The
+callbacks only record the order the files came back in and check their size. DispatchCompleted runs once per
+millisecond, as a frame would, to time the main thread. Two I/O threads read at once, so neighbours in the order may
+swap. The files were just written so the OS cache holds them: this measures the ordering and the main thread cost,
+not disk latency
+*/
+static void BenchmarkStreamer( void )
+{
+  const Uint32  FILE_COUNT  = 200;
+  const Uint32  HIGH_COUNT  = FILE_COUNT / 5;
+  const size_t  FILE_SIZE   = 1024 * 1024;
+
+  AssetStreamer &streamer = AssetStreamer::GetInstance();
+  if( streamer.GetOutstandingCount() != 0 ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "streamer: requests already outstanding, nothing measured" );
+    return;
+  }
+
+  char *folder = SDL_GetPrefPath( "Engine", "Benchmark" );
+  if( folder == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "streamer: no folder to write the files to: %s", SDL_GetError() );
+    return;
+  }
+  const std::string root( folder );
+  SDL_free( folder );
+
+  RandomStream              random( 9 );
+  std::vector<std::string>  paths( FILE_COUNT );
+  std::vector<Uint8>        contents( FILE_SIZE );
+  bool                      written = true;
+  for( size_t b = 0; b < FILE_SIZE; ++b ){
+    contents[b] = static_cast<Uint8>( random.NextRange( 0, 255 ) );
+  }
+  for( Uint32 i = 0; i < FILE_COUNT && written; ++i ){
+    char name[32];
+    SDL_snprintf( name, sizeof( name ), "benchmark_stream_%03u.bin", i );
+    paths[i] = root + name;
+
+    SDL_RWops *file = SDL_RWFromFile( paths[i].c_str(), "wb" );
+    written = file != NULL && SDL_RWwrite( file, &contents[0], FILE_SIZE, 1 ) == 1;
+    if( file != NULL ){
+      SDL_RWclose( file );
+    }
+  }
+
+  if( written ){
+    // Files past HIGH_COUNT are the level content, placed around a focus in the middle of the world
+    std::vector<float>                      distances( FILE_COUNT, 0.0f );
+    std::vector<AssetStreamer::RequestId>   ids( FILE_COUNT );
+    std::vector<Uint32>                     order;
+    std::vector<bool>                       cancelled( FILE_COUNT, false );
+    Uint32                                  failures = 0;
+    streamer.SetFocus( 2048.0f, 2048.0f );
+    for( Uint32 i = HIGH_COUNT; i < FILE_COUNT; ++i ){
+      const float x = NextFloat( random, 0.0f, 4096.0f );
+      const float y = NextFloat( random, 0.0f, 4096.0f );
+      distances[i]  = sqrtf( ( x - 2048.0f ) * ( x - 2048.0f ) + ( y - 2048.0f ) * ( y - 2048.0f ) );
+      ids[i]        = streamer.RequestAt( paths[i], AssetStreamer::PRIORITY_NORMAL, x, y,
+                                          [&order, &failures, i]( AssetStreamer::RequestId,
+                                                                             AssetStreamer::StreamResult result,
+                                                                             std::vector<Uint8> &data ){
+        failures += result != AssetStreamer::STREAM_RESULT_LOADED || data.size() != FILE_SIZE ? 1 : 0;
+        order.push_back( i );
+      } );
+    }
+    for( Uint32 i = 0; i < HIGH_COUNT; ++i ){
+      ids[i] = streamer.Request( paths[i], AssetStreamer::PRIORITY_HIGH,
+                                 [&order, &failures, i]( AssetStreamer::RequestId,
+                                                                    AssetStreamer::StreamResult result,
+                                                                    std::vector<Uint8> &data ){
+        failures += result != AssetStreamer::STREAM_RESULT_LOADED || data.size() != FILE_SIZE ? 1 : 0;
+        order.push_back( i );
+      } );
+    }
+    Uint32 cancelCount = 0;
+    for( Uint32 i = HIGH_COUNT; i < FILE_COUNT; i += 8 ){
+      cancelled[i]  = streamer.Cancel( ids[i] );
+      cancelCount  += cancelled[i] ? 1 : 0;
+    }
+
+    std::vector<double> dispatchSamples;
+    const Uint64        start = SDL_GetPerformanceCounter();
+    while( streamer.GetOutstandingCount() != 0 ){
+      const Uint64 dispatchStart = SDL_GetPerformanceCounter();
+      streamer.DispatchCompleted();
+      dispatchSamples.push_back( GetMilliseconds( dispatchStart ) );
+      SDL_Delay( 1 );
+    }
+    const double totalTime = GetMilliseconds( start );
+
+    // Level files that came back before the last high one, and nearer level files that came back later
+    size_t lastHigh = 0;
+    for( size_t o = 0; o < order.size(); ++o ){
+      lastHigh = order[o] < HIGH_COUNT ? o : lastHigh;
+    }
+    Uint32 normalBeforeHigh = 0;
+    Uint32 inversions       = 0;
+    Uint32 calledCancelled  = 0;
+    for( size_t o = 0; o < order.size(); ++o ){
+      normalBeforeHigh += o < lastHigh && order[o] >= HIGH_COUNT ? 1 : 0;
+      inversions       += o > lastHigh + 1 && distances[order[o]] < distances[order[o - 1]] ? 1 : 0;
+      calledCancelled  += cancelled[order[o]] ? 1 : 0;
+    }
+
+    double worst = 0.0;
+    double total = 0.0;
+    for( size_t d = 0; d < dispatchSamples.size(); ++d ){
+      worst  = SDL_max( worst, dispatchSamples[d] );
+      total += dispatchSamples[d];
+    }
+    SDL_Log( "streamer %u files of 1 MB in %.1f ms: %u cancelled, %u called back, %u failed or short, %u cancelled "
+             "called back", FILE_COUNT, totalTime, cancelCount, static_cast<Uint32>( order.size() ), failures,
+             calledCancelled );
+    SDL_Log( "streamer order: %u level files before the last high one, %u of %u level files nearer than the one before",
+             normalBeforeHigh, inversions, static_cast<Uint32>( order.size() - lastHigh - 1 ) );
+    SDL_Log( "streamer DispatchCompleted over %u frames: mean %.3f ms, worst %.3f ms",
+             static_cast<Uint32>( dispatchSamples.size() ), total / dispatchSamples.size(), worst );
+  }
+  else{
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "streamer: unable to write the files to %s", root.c_str() );
+  }
+
+  for( Uint32 i = 0; i < FILE_COUNT; ++i ){
+    std::remove( paths[i].c_str() );
+  }
+}
+
+/**********************************************************************************************************************/
+// REPLAY
+/**********************************************************************************************************************/
+
+/**
+Input of one recorded tick, as the game sees it after ActionMap::Update
+*/
+struct ReplayTick
+{
+  static const Uint32 ACTION_COUNT = 8;
+
+  Uint64  mDown;
+  int     mCursorX;
+  int     mCursorY;
+  float   mValues[ACTION_COUNT];
+};
+
+/**********************************************************************************************************************/
+
+/**
+Defines the actions of the replay benchmark: four keys for moving, a jump key, a mouse button and both stick directions
+*/
+static void CreateReplayActions( ActionMap &actions )
+{
+  const SDL_Scancode KEYS[]  = { SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_W, SDL_SCANCODE_S, SDL_SCANCODE_SPACE };
+  const char        *NAMES[] = { "left", "right", "up", "down", "jump" };
+  for( Uint32 k = 0; k < SDL_arraysize( KEYS ); ++k ){
+    actions.BindKey( KEYS[k], actions.AddAction( NAMES[k] ) );
+  }
+  actions.BindMouseButton( SDL_BUTTON_LEFT, actions.AddAction( "fire" ) );
+  actions.BindControllerAxis( SDL_CONTROLLER_AXIS_LEFTX, false, actions.AddAction( "stick left" ) );
+  actions.BindControllerAxis( SDL_CONTROLLER_AXIS_LEFTX, true, actions.AddAction( "stick right" ) );
+  actions.Compile();
+}
+
+/**********************************************************************************************************************/
+
+/**
+Plays a recording back and counts the ticks whose actions or cursor differ from the recorded input
+*/
+static Uint32 CountReplayMismatches( InputRecorder &recorder, const std::vector<ReplayTick> &ticks )
+{
+  ActionMap actions;
+  CreateReplayActions( actions );
+  recorder.Rewind();
+
+  Uint32 mismatches = 0;
+  int    cursorX    = 0;
+  int    cursorY    = 0;
+  for( size_t t = 0; t < ticks.size(); ++t ){
+    if( !recorder.Play( actions, cursorX, cursorY ) ){
+      return mismatches + static_cast<Uint32>( ticks.size() - t );
+    }
+
+    bool same = actions.GetDownMask() == ticks[t].mDown && cursorX == ticks[t].mCursorX &&
+                cursorY == ticks[t].mCursorY;
+    for( Uint32 a = 0; a < ReplayTick::ACTION_COUNT; ++a ){
+      const float value = actions.GetValue( a );
+      same &= memcmp( &value, &ticks[t].mValues[a], sizeof( value ) ) == 0;
+    }
+    mismatches += same ? 0 : 1;
+  }
+  return mismatches;
+}
+
+/**********************************************************************************************************************/
+
+/**
+Records ten minutes of synthetic input at 60 ticks per second: keys and the mouse button held for random spans, the
+cursor wandering half of the time and a stick swept during the second half. Reports the recording size and the cost
+of Record, then replays it from memory and from a saved file against the recorded input. Record is timed after
+ActionMap::Apply, which stands in for the Update of the game; the Apply only loop is subtracted
+*/
+static void BenchmarkReplay( void )
+{
+  const Uint32  TICK_RATE   = 60;
+  const Uint32  TICK_COUNT  = 10 * 60 * TICK_RATE;
+  const Uint32  KEY_COUNT   = 5;
+  const int     RUN_COUNT   = 11;
+
+  // Input devices driven through the ActionMap setters, as the event handler would
+  const SDL_Scancode  KEYS[KEY_COUNT] = { SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_W, SDL_SCANCODE_S,
+                                          SDL_SCANCODE_SPACE };
+  RandomStream              random( 7 );
+  ActionMap                 actions;
+  std::vector<ReplayTick>   ticks( TICK_COUNT );
+  Uint32                    toggleTicks[KEY_COUNT + 1] = { 0 };
+  bool                      held[KEY_COUNT + 1]        = { false };
+  int                       cursorX                    = 400;
+  int                       cursorY                    = 300;
+  CreateReplayActions( actions );
+  for( Uint32 t = 0; t < TICK_COUNT; ++t ){
+    for( Uint32 k = 0; k <= KEY_COUNT; ++k ){
+      if( t == toggleTicks[k] ){
+        held[k]         = !held[k];
+        toggleTicks[k] += static_cast<Uint32>( random.NextRange( 5, 120 ) );
+        if( k < KEY_COUNT ){
+          actions.SetKey( KEYS[k], held[k] );
+        }
+        else{
+          actions.SetMouseButton( SDL_BUTTON_LEFT, held[k] );
+        }
+      }
+    }
+    if( t >= TICK_COUNT / 2 && t % 3 == 0 ){
+      actions.SetControllerAxis( SDL_CONTROLLER_AXIS_LEFTX, sinf( t * 0.013f ) + NextFloat( random, -0.05f, 0.05f ) );
+    }
+    if( ( t / 300 ) % 2 == 0 ){
+      cursorX += random.NextRange( -3, 3 );
+      cursorY += random.NextRange( -3, 3 );
+    }
+    actions.Update();
+
+    ticks[t].mDown    = actions.GetDownMask();
+    ticks[t].mCursorX = cursorX;
+    ticks[t].mCursorY = cursorY;
+    for( Uint32 a = 0; a < ReplayTick::ACTION_COUNT; ++a ){
+      ticks[t].mValues[a] = actions.GetValue( a );
+    }
+  }
+  const Uint32 checksum = static_cast<Uint32>( ticks.back().mDown ^ ( ticks.back().mDown >> 32 ) );
+
+  InputRecorder       recorder;
+  std::vector<double> recordSamples;
+  std::vector<double> applySamples;
+  for( int run = 0; run < RUN_COUNT; ++run ){
+    recorder.Begin( 7, TICK_RATE, ReplayTick::ACTION_COUNT );
+    Uint64 start = SDL_GetPerformanceCounter();
+    for( Uint32 t = 0; t < TICK_COUNT; ++t ){
+      actions.Apply( ticks[t].mDown, ticks[t].mValues, ReplayTick::ACTION_COUNT );
+      recorder.Record( actions, ticks[t].mCursorX, ticks[t].mCursorY );
+    }
+    recorder.End( checksum );
+    recordSamples.push_back( GetMilliseconds( start ) );
+
+    start = SDL_GetPerformanceCounter();
+    for( Uint32 t = 0; t < TICK_COUNT; ++t ){
+      actions.Apply( ticks[t].mDown, ticks[t].mValues, ReplayTick::ACTION_COUNT );
+    }
+    applySamples.push_back( GetMilliseconds( start ) );
+  }
+  const double recordNs = ( Median( recordSamples ) - Median( applySamples ) ) * 1e6 / TICK_COUNT;
+  SDL_Log( "replay %u ticks: %u bytes, record %.1f ns per tick, %u ticks differ replayed from memory", TICK_COUNT,
+           static_cast<Uint32>( recorder.GetDataSize() ), recordNs, CountReplayMismatches( recorder, ticks ) );
+
+  char *folder = SDL_GetPrefPath( "Engine", "Benchmark" );
+  if( folder != NULL ){
+    const std::string path = std::string( folder ) + "benchmark.inpr";
+    SDL_free( folder );
+
+    InputRecorder loaded;
+    if( recorder.Save( path ) && loaded.Load( path ) ){
+      SDL_Log( "replay from file: %u ticks differ, checksum %s", CountReplayMismatches( loaded, ticks ),
+               loaded.GetChecksum() == checksum ? "ok" : "WRONG" );
+    }
+    std::remove( path.c_str() );
+  }
+  else{
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "replay: no folder to save the recording to: %s", SDL_GetError() );
+  }
+
+  // A minute of holding and releasing one key every two seconds
+  ActionMap idle;
+  CreateReplayActions( idle );
+  recorder.Begin( 7, TICK_RATE, ReplayTick::ACTION_COUNT );
+  for( Uint32 t = 0; t < 60 * TICK_RATE; ++t ){
+    idle.SetKey( SDL_SCANCODE_D, ( t / ( 2 * TICK_RATE ) ) % 2 == 0 );
+    idle.Update();
+    recorder.Record( idle, 400, 300 );
+  }
+  recorder.End( 0 );
+  SDL_Log( "replay one key held and released every two seconds for a minute: %u bytes",
+           static_cast<Uint32>( recorder.GetDataSize() ) );
+}
+
+/**********************************************************************************************************************/
+// CONTROLLERS
+/**********************************************************************************************************************/
+
+/**
+Returns an axis motion event of a controller
+*/
+static SDL_Event MakeAxisEvent( SDL_JoystickID instance, SDL_GameControllerAxis axis, Sint16 value )
+{
+  SDL_Event event;
+  SDL_zero( event );
+  event.type        = SDL_CONTROLLERAXISMOTION;
+  event.caxis.which = instance;
+  event.caxis.axis  = static_cast<Uint8>( axis );
+  event.caxis.value = value;
+  return event;
+}
+
+/**********************************************************************************************************************/
+
+/**
+Times the ControllerManager filter on stick events sent to the first connected game controller: a stick circling
+outside the dead zone, where every event changes the actions, then noise inside the dead zone, where none does.
+Unplugging is checked to release a held button and the stick. Needs a controller, the events are synthetic
+*/
+static void BenchmarkControllers( void )
+{
+  const Uint32  EVENT_COUNT = 1000000;
+  const int     RUN_COUNT   = 11;
+
+  const bool initialized = SDL_WasInit( SDL_INIT_GAMECONTROLLER ) != 0;
+  if( !initialized && SDL_InitSubSystem( SDL_INIT_GAMECONTROLLER ) != 0 ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "controller: unable to init: %s", SDL_GetError() );
+    return;
+  }
+
+  int deviceIndex = 0;
+  while( deviceIndex < SDL_NumJoysticks() && !SDL_IsGameController( deviceIndex ) ){
+    ++deviceIndex;
+  }
+  SDL_GameController *handle = deviceIndex < SDL_NumJoysticks() ? SDL_GameControllerOpen( deviceIndex ) : NULL;
+  if( handle == NULL ){
+    SDL_Log( "controller: no game controller connected, nothing to measure" );
+    if( !initialized ){
+      SDL_QuitSubSystem( SDL_INIT_GAMECONTROLLER );
+    }
+    return;
+  }
+  const SDL_JoystickID instance = SDL_JoystickInstanceID( SDL_GameControllerGetJoystick( handle ) );
+
+  ActionMap actions;
+  const ActionMap::ActionId fire  = actions.AddAction( "fire" );
+  const ActionMap::ActionId right = actions.AddAction( "stick right" );
+  actions.BindControllerButton( SDL_CONTROLLER_BUTTON_A, fire );
+  actions.BindControllerAxis( SDL_CONTROLLER_AXIS_LEFTX, true, right );
+  actions.BindControllerAxis( SDL_CONTROLLER_AXIS_LEFTY, true, actions.AddAction( "stick down" ) );
+  actions.Compile();
+
+  // The manager opens its own reference, as it does for the added events SDL sends at start
+  ControllerManager manager( actions );
+  SDL_Event         added;
+  SDL_zero( added );
+  added.type          = SDL_CONTROLLERDEVICEADDED;
+  added.cdevice.which = deviceIndex;
+  manager.HandleEvent( added );
+
+  // Odd events move Y, so every event moves the stick
+  RandomStream            random( 8 );
+  std::vector<SDL_Event>  moving( EVENT_COUNT );
+  std::vector<SDL_Event>  resting( EVENT_COUNT );
+  for( Uint32 i = 0; i < EVENT_COUNT; ++i ){
+    const float angle = ( i / 2 ) * 0.01f;
+    moving[i] = i % 2 == 0 ? MakeAxisEvent( instance, SDL_CONTROLLER_AXIS_LEFTX,
+                                            static_cast<Sint16>( cosf( angle ) * 0.8f * 32767.0f ) ) :
+                             MakeAxisEvent( instance, SDL_CONTROLLER_AXIS_LEFTY,
+                                            static_cast<Sint16>( sinf( angle ) * 0.8f * 32767.0f ) );
+    resting[i] = MakeAxisEvent( instance, i % 2 == 0 ? SDL_CONTROLLER_AXIS_LEFTX : SDL_CONTROLLER_AXIS_LEFTY,
+                                static_cast<Sint16>( random.NextRange( -5000, 5000 ) ) );
+  }
+
+  std::vector<double> movingSamples;
+  std::vector<double> restingSamples;
+  Uint32              movingChanges   = 0;
+  Uint32              restingChanges  = 0;
+  for( int run = 0; run < RUN_COUNT; ++run ){
+    movingChanges = 0;
+    Uint64 start  = SDL_GetPerformanceCounter();
+    for( Uint32 i = 0; i < EVENT_COUNT; ++i ){
+      movingChanges += manager.HandleEvent( moving[i] ) ? 1 : 0;
+    }
+    movingSamples.push_back( GetMilliseconds( start ) );
+
+    // Centered first, so the resting events start inside the dead zone
+    manager.HandleEvent( MakeAxisEvent( instance, SDL_CONTROLLER_AXIS_LEFTX, 0 ) );
+    manager.HandleEvent( MakeAxisEvent( instance, SDL_CONTROLLER_AXIS_LEFTY, 0 ) );
+    restingChanges = 0;
+    start          = SDL_GetPerformanceCounter();
+    for( Uint32 i = 0; i < EVENT_COUNT; ++i ){
+      restingChanges += manager.HandleEvent( resting[i] ) ? 1 : 0;
+    }
+    restingSamples.push_back( GetMilliseconds( start ) );
+  }
+  SDL_Log( "controller moving stick: %.1f ns per event, %u of %u events change the actions",
+           Median( movingSamples ) * 1e6 / EVENT_COUNT, movingChanges, EVENT_COUNT );
+  SDL_Log( "controller dead zone noise: %.1f ns per event, %u of %u events change the actions",
+           Median( restingSamples ) * 1e6 / EVENT_COUNT, restingChanges, EVENT_COUNT );
+
+  // Unplugged while the button is held and the stick pushed
+  SDL_Event button;
+  SDL_zero( button );
+  button.type           = SDL_CONTROLLERBUTTONDOWN;
+  button.cbutton.which  = instance;
+  button.cbutton.button = SDL_CONTROLLER_BUTTON_A;
+  manager.HandleEvent( button );
+  manager.HandleEvent( moving[0] );
+  actions.Update();
+  const bool held = actions.IsDown( fire ) && actions.GetValue( right ) > 0.0f;
+
+  SDL_Event removed;
+  SDL_zero( removed );
+  removed.type          = SDL_CONTROLLERDEVICEREMOVED;
+  removed.cdevice.which = instance;
+  manager.HandleEvent( removed );
+  actions.Update();
+  const bool released = !actions.IsDown( fire ) && actions.GetValue( right ) == 0.0f;
+  SDL_Log( "controller unplugged while held: input %s", held && released ? "released ok" : "WRONG" );
+
+  SDL_GameControllerClose( handle );
+  if( !initialized ){
+    SDL_QuitSubSystem( SDL_INIT_GAMECONTROLLER );
+  }
+}
+
+/**********************************************************************************************************************/
+// TABLE
+/**********************************************************************************************************************/
+
+/**
+Named benchmark
+*/
+struct BenchmarkEntry
+{
+  const char  *mName;         ///< Name given to -bench
+  void       ( *mRun )( void );
+};
+
+static const BenchmarkEntry BENCHMARKS[] =
+{
+  { "movement",   BenchmarkMovement },
+  { "entities",   BenchmarkEntities },
+  { "prefab",     BenchmarkPrefab },
+  { "grid",       BenchmarkGrid },
+  { "broadphase", BenchmarkBroadphase },
+  { "tree",       BenchmarkTree },
+  { "masks",      BenchmarkMasks },
+  { "ccd",        BenchmarkContinuousCollision },
+  { "contacts",   BenchmarkContacts },
+  { "tiles",      BenchmarkTiles },
+  { "archive",    BenchmarkArchive },
+  { "streamer",   BenchmarkStreamer },
+  { "replay",     BenchmarkReplay },
+  { "controller", BenchmarkControllers }
+};
+
+/**********************************************************************************************************************/
+
+bool Benchmark::Run( const std::string &name )
+{
+  bool found = false;
+  for( size_t i = 0; i < SDL_arraysize( BENCHMARKS ); ++i ){
+    if( name == "all" || name == BENCHMARKS[i].mName ){
+      BENCHMARKS[i].mRun();
+      found = true;
+    }
+  }
+  if( !found ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unknown benchmark %s, expected all %s", name.c_str(),
+                  GetNames().c_str() );
+  }
+  return found;
+}
+
+/**********************************************************************************************************************/
+
+std::string Benchmark::GetNames( void )
+{
+  std::string names;
+  for( size_t i = 0; i < SDL_arraysize( BENCHMARKS ); ++i ){
+    names += i ? " " : "";
+    names += BENCHMARKS[i].mName;
+  }
+  return names;
+}
+
+/**********************************************************************************************************************/
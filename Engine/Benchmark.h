@@ -0,0 +1,36 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Names
+#include <string>
+
+/**
+Benchmark class
+Timing runs of the engine modules on synthetic scenes, started with the -bench option of the game. Every benchmark
+logs its timings with SDL_Log; times are medians over several runs so a preempted run does not skew them. Run them
+on an optimized build
+*/
+class Benchmark
+{
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Runs a benchmark and logs its results
+  @param name Benchmark name, or "all" to run every benchmark
+  @return False if no benchmark has that name
+  */
+  static bool Run( const std::string &name );
+
+  /**
+  Returns the names of the benchmarks, separated by spaces
+  */
+  static std::string GetNames( void );
+};
+
+/**********************************************************************************************************************/
+
+#endif
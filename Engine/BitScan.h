@@ -0,0 +1,59 @@
+#ifndef BITSCAN_H
+#define BITSCAN_H
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+// Bit scan intrinsics
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+/**********************************************************************************************************************/
+
+/**
+Returns the index of the lowest set bit of a word, which must not be 0. 32-bit MSVC has no 64-bit scan and tests the
+two halves
+*/
+inline int LowestBit( Uint64 word )
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64( &index, word );
+  return static_cast<int>( index );
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if( _BitScanForward( &index, static_cast<unsigned long>( word ) ) ){
+    return static_cast<int>( index );
+  }
+  _BitScanForward( &index, static_cast<unsigned long>( word >> 32 ) );
+  return static_cast<int>( index ) + 32;
+#else
+  return __builtin_ctzll( word );
+#endif
+}
+
+/**
+Returns the index of the highest set bit of a word, which must not be 0
+*/
+inline int HighestBit( Uint64 word )
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+  unsigned long index;
+  _BitScanReverse64( &index, word );
+  return static_cast<int>( index );
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if( _BitScanReverse( &index, static_cast<unsigned long>( word >> 32 ) ) ){
+    return static_cast<int>( index ) + 32;
+  }
+  _BitScanReverse( &index, static_cast<unsigned long>( word ) );
+  return static_cast<int>( index );
+#else
+  return 63 - __builtin_clzll( word );
+#endif
+}
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+// Fixed size integer types, SDL_Rect
+#include <SDL_rect.h>
+
+/**********************************************************************************************************************/
+
+typedef Uint32 ProxyId;                             ///< Object registered in a broadphase
+
+static const ProxyId INVALID_PROXY = 0xFFFFFFFF;    ///< Id that never references an object
+
+/**
+Pair of objects whose rects overlap. mA is always lower than mB
+*/
+struct BroadphasePair
+{
+  ProxyId mA;
+  ProxyId mB;
+
+  inline bool operator==( const BroadphasePair &other ) const {
+    return mA == other.mA && mB == other.mB;
+  }
+  inline bool operator<( const BroadphasePair &other ) const {
+    return mA != other.mA ? mA < other.mA : mB < other.mB;
+  }
+};
+
+/**
+Returns true if two rects overlap. Same result as SDL_HasIntersection: rects touching on an edge do not overlap and
+empty rects never overlap
+*/
+inline bool RectsOverlap( const SDL_Rect &a, const SDL_Rect &b )
+{
+  return a.w > 0 && a.h > 0 && b.w > 0 && b.h > 0 &&
+         a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+/**********************************************************************************************************************/
+
+#endif
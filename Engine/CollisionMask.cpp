@@ -0,0 +1,148 @@
+#include "CollisionMask.h"
+
+// SSE2 is always available on x64 and is the Visual Studio default on x86
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+  #define COLLISIONMASK_USE_SSE2
+  #include <emmintrin.h>
+#endif
+
+/**********************************************************************************************************************/
+
+CollisionMask::CollisionMask( SDL_Surface *surface, Uint8 alphaThreshold )
+  : mWidth(surface->w), mHeight(surface->h), mDataWords(( surface->w + WORD_BITS - 1 ) / WORD_BITS),
+    mStride(mDataWords + 2)
+{
+  mBits.resize( static_cast<size_t>( mStride ) * mHeight + 1, 0 );
+
+  const SDL_PixelFormat  *format  = surface->format;
+  Uint32                  key     = 0;
+  const bool              keyed   = SDL_GetColorKey( surface, &key ) == 0;
+  const Uint32            rgbMask = ~format->Amask;
+  const bool              argb    = format->format == SDL_PIXELFORMAT_ARGB8888;
+
+  int minX = mWidth;
+  int minY = mHeight;
+  int maxX = -1;
+  int maxY = -1;
+
+  SDL_LockSurface( surface );
+  for( int y = 0; y < mHeight; ++y ){
+    const Uint8  *pixels  = static_cast<const Uint8*>( surface->pixels ) + y * surface->pitch;
+    Uint64       *row     = &mBits[static_cast<size_t>( y ) * mStride + 1];
+    for( int x = 0; x < mWidth; ++x ){
+      Uint32 pixel;
+      Uint8  alpha;
+      if( argb ){
+        pixel = reinterpret_cast<const Uint32*>( pixels )[x];
+        alpha = static_cast<Uint8>( pixel >> 24 );
+      }
+      else{
+        const Uint8 *bytes = pixels + x * format->BytesPerPixel;
+        switch( format->BytesPerPixel ){
+          case 1:   pixel = *bytes; break;
+          case 2:   pixel = *reinterpret_cast<const Uint16*>( bytes ); break;
+          case 3:   pixel = SDL_BYTEORDER == SDL_LIL_ENDIAN ? bytes[0] | bytes[1] << 8 | bytes[2] << 16
+                                                            : bytes[2] | bytes[1] << 8 | bytes[0] << 16; break;
+          default:  pixel = *reinterpret_cast<const Uint32*>( bytes ); break;
+        }
+        Uint8 r, g, b;
+        SDL_GetRGBA( pixel, format, &r, &g, &b, &alpha );
+      }
+
+      if( alpha < alphaThreshold || ( keyed && ( pixel & rgbMask ) == ( key & rgbMask ) ) ){
+        continue;
+      }
+      row[x / WORD_BITS] |= static_cast<Uint64>( 1 ) << ( x % WORD_BITS );
+      minX = SDL_min( minX, x );
+      maxX = SDL_max( maxX, x );
+      minY = SDL_min( minY, y );
+      maxY = y;
+    }
+  }
+  SDL_UnlockSurface( surface );
+
+  mBounds.x = maxX >= 0 ? minX : 0;
+  mBounds.y = maxY >= 0 ? minY : 0;
+  mBounds.w = maxX >= 0 ? maxX - minX + 1 : 0;
+  mBounds.h = maxY >= 0 ? maxY - minY + 1 : 0;
+}
+
+/**********************************************************************************************************************/
+
+bool CollisionMask::TestPoint( int x, int y ) const
+{
+  if( x < 0 || y < 0 || x >= mWidth || y >= mHeight ){
+    return false;
+  }
+  return ( GetRow( y )[x / WORD_BITS] >> ( x % WORD_BITS ) ) & 1;
+}
+
+/**********************************************************************************************************************/
+
+bool CollisionMask::Overlap( const CollisionMask &a, int ax, int ay, const CollisionMask &b, int bx, int by )
+{
+  // Rect early-out on the opaque bounds. Only their intersection can hold pixels solid in both masks
+  const SDL_Rect boundsA = { ax + a.mBounds.x, ay + a.mBounds.y, a.mBounds.w, a.mBounds.h };
+  const SDL_Rect boundsB = { bx + b.mBounds.x, by + b.mBounds.y, b.mBounds.w, b.mBounds.h };
+  SDL_Rect       common;
+  if( !SDL_IntersectRect( &boundsA, &boundsB, &common ) ){
+    return false;
+  }
+
+  // Shift the right mask onto the left one so word shifts only go one way
+  if( bx < ax ){
+    return OverlapRows( b, a, ax - bx, common.y - by, common.y - ay, common.h, ( common.x - bx ) / WORD_BITS,
+                        ( common.x + common.w - 1 - bx ) / WORD_BITS );
+  }
+  return OverlapRows( a, b, bx - ax, common.y - ay, common.y - by, common.h, ( common.x - ax ) / WORD_BITS,
+                      ( common.x + common.w - 1 - ax ) / WORD_BITS );
+}
+
+/**********************************************************************************************************************/
+
+bool CollisionMask::OverlapRows( const CollisionMask &a, const CollisionMask &b, int offsetX, int rowA, int rowB,
+                                 int rows, int firstWord, int lastWord )
+{
+  // Word k of a lines up with bits of words k - wordShift and k - wordShift - 1 of b. Words outside the common bounds
+  // may be read, on either side one of the masks is empty there. Reads stay within the padding words
+  const int wordShift = offsetX / WORD_BITS;
+  const int bitShift  = offsetX % WORD_BITS;
+
+#ifdef COLLISIONMASK_USE_SSE2
+  // Two words per iteration. A shift by 64 gives zero, so aligned masks need no special case
+  const __m128i shiftLeft   = _mm_cvtsi32_si128( bitShift );
+  const __m128i shiftRight  = _mm_cvtsi32_si128( WORD_BITS - bitShift );
+  const __m128i zero        = _mm_setzero_si128();
+  for( int y = 0; y < rows; ++y ){
+    const Uint64 *wordsA  = a.GetRow( rowA + y );
+    const Uint64 *wordsB  = b.GetRow( rowB + y ) - wordShift;
+    __m128i       found   = zero;
+    for( int k = firstWord; k <= lastWord; k += 2 ){
+      const __m128i high    = _mm_loadu_si128( reinterpret_cast<const __m128i*>( wordsB + k ) );
+      const __m128i low     = _mm_loadu_si128( reinterpret_cast<const __m128i*>( wordsB + k - 1 ) );
+      const __m128i shifted = _mm_or_si128( _mm_sll_epi64( high, shiftLeft ), _mm_srl_epi64( low, shiftRight ) );
+      found = _mm_or_si128( found, _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( wordsA + k ) ),
+                                                  shifted ) );
+    }
+    if( _mm_movemask_epi8( _mm_cmpeq_epi8( found, zero ) ) != 0xFFFF ){
+      return true;
+    }
+  }
+#else
+  for( int y = 0; y < rows; ++y ){
+    const Uint64 *wordsA  = a.GetRow( rowA + y );
+    const Uint64 *wordsB  = b.GetRow( rowB + y ) - wordShift;
+    Uint64        found   = 0;
+    for( int k = firstWord; k <= lastWord; ++k ){
+      const Uint64 shifted = bitShift ? wordsB[k] << bitShift | wordsB[k - 1] >> ( WORD_BITS - bitShift ) : wordsB[k];
+      found |= wordsA[k] & shifted;
+    }
+    if( found ){
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,120 @@
+#ifndef COLLISIONMASK_H
+#define COLLISIONMASK_H
+
+// SDL surfaces and rects
+#include <SDL.h>
+
+// Bit rows
+#include <vector>
+
+/**
+Collision mask class
+One bit per pixel of an image, set where the image is opaque. Rows are packed in 64-bit words, lowest bit first, with
+a zero word on each side so shifted reads past the edges see empty pixels. Two masks are compared by shifting the words
+of one onto the other and ANDing them two words at a time with SSE2, after rejecting with the opaque bounds of both
+*/
+class CollisionMask
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint8    DEFAULT_ALPHA_THRESHOLD = 128;  ///< Pixels with at least this alpha are solid
+
+private:
+
+  static const int      WORD_BITS = 64;                 ///< Pixels per word
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Builds the mask from the alpha channel of a surface. Color keyed pixels are transparent
+  @param surface Image. Any pixel format, ARGB8888 is the fast path
+  @param alphaThreshold Minimum alpha of a solid pixel
+  */
+  explicit CollisionMask( SDL_Surface *surface, Uint8 alphaThreshold = DEFAULT_ALPHA_THRESHOLD );
+
+  /**
+  Checks whether a pixel is solid
+  @param x Column in the image, pixels outside are empty
+  @param y Row in the image
+  */
+  bool TestPoint( int x, int y ) const;
+
+  /**
+  Checks whether two masks have a solid pixel in common. Positions are the top left corners of the images
+  @param a First mask
+  @param ax Position of the first image
+  @param ay
+  @param b Second mask
+  @param bx Position of the second image
+  @param by
+  @return True if the masks overlap
+  */
+  static bool Overlap( const CollisionMask &a, int ax, int ay, const CollisionMask &b, int bx, int by );
+
+  /**
+  Getters
+  */
+  inline int GetWidth( void ) const {
+    return mWidth;
+  }
+  inline int GetHeight( void ) const {
+    return mHeight;
+  }
+
+  /**
+  Smallest rect holding every solid pixel, in image coordinates. Empty if the image is fully transparent
+  */
+  inline const SDL_Rect &GetBounds( void ) const {
+    return mBounds;
+  }
+
+private:
+
+  /**
+  Returns the first data word of a row. Word -1 and word mDataWords are zero padding
+  */
+  inline const Uint64 *GetRow( int y ) const {
+    return &mBits[static_cast<size_t>( y ) * mStride + 1];
+  }
+
+  /**
+  Checks rows of two masks against each other, b being offset to the right of a
+  @param a Left mask
+  @param b Right mask
+  @param offsetX Column of a where b starts, at least 0
+  @param rowA First row of a to test
+  @param rowB Matching row of b
+  @param rows Number of rows
+  @param firstWord First word of a to test in every row
+  @param lastWord Last word of a to test in every row
+  */
+  static bool OverlapRows( const CollisionMask &a, const CollisionMask &b, int offsetX, int rowA, int rowB, int rows,
+                           int firstWord, int lastWord );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<Uint64>   mBits;        ///< Rows of mStride words: padding, data, padding. One more padding word at the end
+  int                   mWidth;       ///< Image size in pixels
+  int                   mHeight;
+  int                   mDataWords;   ///< Words holding pixels in a row
+  int                   mStride;      ///< Words per row including padding
+  SDL_Rect              mBounds;      ///< Opaque bounds
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,62 @@
+#include "ComponentRegistry.h"
+
+// Registry overflow
+#include "AssertionManager.h"
+
+// Registration may happen from worker threads
+#include <mutex>
+
+/**********************************************************************************************************************/
+
+ComponentRegistry::ComponentInfo  ComponentRegistry::sInfos[MAX_COMPONENT_TYPES];
+unsigned                          ComponentRegistry::sCount = 0;
+ComponentMask                     ComponentRegistry::sReleaseMask = 0;
+
+// Protects registration
+static std::mutex sRegistryMutex;
+
+/**********************************************************************************************************************/
+
+ComponentTypeId ComponentRegistry::Register( size_t size, size_t alignment, const char *name )
+{
+  std::lock_guard<std::mutex> lock( sRegistryMutex );
+
+  AssertMessage( sCount < MAX_COMPONENT_TYPES, "Too many component types. Widen ComponentMask" );
+
+  ComponentTypeId id    = sCount++;
+  sInfos[id].mSize      = size;
+  sInfos[id].mAlignment = alignment;
+  sInfos[id].mName      = name;
+  sInfos[id].mRelease   = NULL;
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+const ComponentRegistry::ComponentInfo &ComponentRegistry::GetInfo( ComponentTypeId id )
+{
+  AssertCondition( id < sCount );
+  return sInfos[id];
+}
+
+/**********************************************************************************************************************/
+
+unsigned ComponentRegistry::GetCount( void )
+{
+  std::lock_guard<std::mutex> lock( sRegistryMutex );
+  return sCount;
+}
+
+/**********************************************************************************************************************/
+
+void ComponentRegistry::SetReleaseFunction( ComponentTypeId id, ReleaseFunction release )
+{
+  std::lock_guard<std::mutex> lock( sRegistryMutex );
+
+  AssertCondition( id < sCount );
+  const ComponentMask bit = static_cast<ComponentMask>( 1 ) << id;
+  sInfos[id].mRelease     = release;
+  sReleaseMask            = release != NULL ? sReleaseMask | bit : sReleaseMask & ~bit;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,143 @@
+#ifndef COMPONENTREGISTRY_H
+#define COMPONENTREGISTRY_H
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+// Component type checks
+#include <type_traits>
+#include <typeinfo>
+
+/**********************************************************************************************************************/
+
+typedef unsigned  ComponentTypeId;  ///< Index of a component type in the registry
+typedef Uint64    ComponentMask;    ///< One bit per component type
+
+/**
+Component registry class
+Gives every component type a small id and keeps its size and alignment so archetypes can store components as raw bytes
+*/
+class ComponentRegistry
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const unsigned MAX_COMPONENT_TYPES = 64;   ///< Bits in ComponentMask
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Releases what components own (block references, handles) when their values leave the world: entity destroyed,
+  component removed or overwritten, world destroyed. Components are still moved with memcpy, so moves never call it
+  @param components First component
+  @param count Number of contiguous components
+  */
+  typedef void ( *ReleaseFunction )( void *components, Uint32 count );
+
+  /**
+  Memory layout of a component type
+  */
+  struct ComponentInfo
+  {
+    size_t            mSize;        ///< sizeof the component
+    size_t            mAlignment;   ///< alignof the component
+    const char       *mName;        ///< Type name for debugging
+    ReleaseFunction   mRelease;     ///< Run on dropped values, NULL for plain data
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+  /**
+  Registers a component type. Use ComponentType<T>::GetId instead of calling it directly
+  @param size Size of the component
+  @param alignment Alignment of the component
+  @param name Type name for debugging
+  @return Id of the new component type
+  */
+  static ComponentTypeId Register( size_t size, size_t alignment, const char *name );
+
+  /**
+  Returns the layout of a registered component type
+  @param id Component type id
+  @return Component info
+  */
+  static const ComponentInfo &GetInfo( ComponentTypeId id );
+
+  /**
+  Returns the number of registered component types
+  @return Registered component types
+  */
+  static unsigned GetCount( void );
+
+  /**
+  Sets the function releasing dropped values of a component type. Set it before any value of the type exists
+  @param id Component type id
+  @param release Release function, NULL for plain data
+  */
+  static void SetReleaseFunction( ComponentTypeId id, ReleaseFunction release );
+
+  /**
+  Returns the component types having a release function, so worlds skip plain data with one test
+  */
+  inline static ComponentMask GetReleaseMask( void ) {
+    return sReleaseMask;
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  static ComponentInfo  sInfos[MAX_COMPONENT_TYPES];  ///< Registered component types
+  static unsigned       sCount;                       ///< Number of registered component types
+  static ComponentMask  sReleaseMask;                 ///< Types with a release function
+};
+
+/**********************************************************************************************************************/
+
+/**
+Component type class
+Maps a C++ component type to its registry id. Components are moved with memcpy so they must be trivially copyable
+*/
+template < class T >
+class ComponentType
+{
+  static_assert( std::is_trivially_copyable<T>::value, "Components must be trivially copyable" );
+
+public:
+
+  /**
+  Returns the id of the component type, registering it on first use
+  @return Component type id
+  */
+  inline static ComponentTypeId GetId( void )
+  {
+    static const ComponentTypeId sId = ComponentRegistry::Register( sizeof(T), alignof(T), typeid(T).name() );
+    return sId;
+  }
+
+  /**
+  Returns the mask bit of the component type
+  @return Component mask with only this type set
+  */
+  inline static ComponentMask GetMask( void )
+  {
+    return static_cast<ComponentMask>( 1 ) << GetId();
+  }
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,156 @@
+#include "ContactSolver.h"
+
+// Assertions
+#include "AssertionManager.h"
+
+// Parallel batches
+#include "JobManager.h"
+
+/**********************************************************************************************************************/
+
+ContactSolver::ContactSolver( float restitution, float correction, float slop )
+  : mBuffers( JobManager::GetInstance().GetWorkerCount() + 1 ), mRestitution(restitution), mCorrection(correction),
+    mSlop(slop)
+{
+}
+
+/**********************************************************************************************************************/
+
+Uint32 ContactSolver::Solve( Body *bodies, const BroadphasePair *pairs, Uint32 pairCount, bool parallel )
+{
+  // Narrowphase and response in parallel. Bodies are only read until every job has finished
+  JobManager             &jobManager = JobManager::GetInstance();
+  JobManager::JobCounter  counter;
+  mBatches.resize( ( pairCount + PAIRS_PER_JOB - 1 ) / PAIRS_PER_JOB );
+  for( Uint32 batch = 0; batch < mBatches.size(); ++batch ){
+    const Uint32 last = ( batch + 1 ) * PAIRS_PER_JOB < pairCount ? ( batch + 1 ) * PAIRS_PER_JOB : pairCount;
+    if( !parallel ){
+      CollideBatch( bodies, pairs, batch, last );
+      continue;
+    }
+    jobManager.AddJob( [this, bodies, pairs, batch, last]( void ){
+      CollideBatch( bodies, pairs, batch, last );
+    }, &counter );
+  }
+  jobManager.Wait( counter );
+
+  MergeContacts();
+
+  // Applied in pair order so the float sums of bodies in several contacts always round the same way
+  for( size_t i = 0; i < mContacts.size(); ++i ){
+    const Contact &contact = mContacts[i];
+    Body          &a       = bodies[contact.mA];
+    Body          &b       = bodies[contact.mB];
+
+    const float impulseX    = contact.mImpulse * contact.mNormalX;
+    const float impulseY    = contact.mImpulse * contact.mNormalY;
+    const float correctionX = contact.mCorrection * contact.mNormalX;
+    const float correctionY = contact.mCorrection * contact.mNormalY;
+    a.mVelocityX -= impulseX * a.mInverseMass;
+    a.mVelocityY -= impulseY * a.mInverseMass;
+    b.mVelocityX += impulseX * b.mInverseMass;
+    b.mVelocityY += impulseY * b.mInverseMass;
+    a.mX         -= correctionX * a.mInverseMass;
+    a.mY         -= correctionY * a.mInverseMass;
+    b.mX         += correctionX * b.mInverseMass;
+    b.mY         += correctionY * b.mInverseMass;
+  }
+
+  return static_cast<Uint32>( mContacts.size() );
+}
+
+/**********************************************************************************************************************/
+
+bool ContactSolver::Collide( const Body &a, const Body &b, Contact &contact ) const
+{
+  const float overlapX = ( a.mX + a.mWidth < b.mX + b.mWidth ? a.mX + a.mWidth : b.mX + b.mWidth ) -
+                         ( a.mX > b.mX ? a.mX : b.mX );
+  const float overlapY = ( a.mY + a.mHeight < b.mY + b.mHeight ? a.mY + a.mHeight : b.mY + b.mHeight ) -
+                         ( a.mY > b.mY ? a.mY : b.mY );
+  if( overlapX <= 0.0f || overlapY <= 0.0f ){
+    return false;
+  }
+
+  // Separate along the axis of least penetration, towards B
+  const bool alongX = overlapX < overlapY;
+  if( alongX ){
+    contact.mNormalX  = a.mX + a.mWidth * 0.5f <= b.mX + b.mWidth * 0.5f ? 1.0f : -1.0f;
+    contact.mNormalY  = 0.0f;
+    contact.mDepth    = overlapX;
+  }
+  else{
+    contact.mNormalX  = 0.0f;
+    contact.mNormalY  = a.mY + a.mHeight * 0.5f <= b.mY + b.mHeight * 0.5f ? 1.0f : -1.0f;
+    contact.mDepth    = overlapY;
+  }
+
+  contact.mImpulse    = 0.0f;
+  contact.mCorrection = 0.0f;
+  const float inverseMassSum = a.mInverseMass + b.mInverseMass;
+  if( inverseMassSum <= 0.0f ){
+    return true;
+  }
+
+  // Only bodies moving towards each other get an impulse, resting and separating ones keep their velocity
+  const float approach = ( b.mVelocityX - a.mVelocityX ) * contact.mNormalX +
+                         ( b.mVelocityY - a.mVelocityY ) * contact.mNormalY;
+  if( approach < 0.0f ){
+    contact.mImpulse = -( 1.0f + mRestitution ) * approach / inverseMassSum;
+  }
+  if( contact.mDepth > mSlop ){
+    contact.mCorrection = ( contact.mDepth - mSlop ) * mCorrection / inverseMassSum;
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void ContactSolver::CollideBatch( const Body *bodies, const BroadphasePair *pairs, Uint32 batch, Uint32 last )
+{
+  const unsigned index = JobManager::GetCurrentThreadIndex();
+  AssertMessage( index < mBuffers.size(), "Contact batch run by a thread unknown to the solver" );
+  std::vector<Contact> &contacts = mBuffers[index].mContacts;
+
+  // Only this job writes this batch entry
+  Batch &entry  = mBatches[batch];
+  entry.mThread = index;
+  entry.mFirst  = static_cast<Uint32>( contacts.size() );
+
+  Contact contact;
+  for( Uint32 i = batch * PAIRS_PER_JOB; i < last; ++i ){
+    if( Collide( bodies[pairs[i].mA], bodies[pairs[i].mB], contact ) ){
+      contact.mPair = i;
+      contact.mA    = pairs[i].mA;
+      contact.mB    = pairs[i].mB;
+      contacts.push_back( contact );
+    }
+  }
+  entry.mLast = static_cast<Uint32>( contacts.size() );
+}
+
+/**********************************************************************************************************************/
+
+void ContactSolver::MergeContacts( void )
+{
+  size_t total = 0;
+  for( size_t t = 0; t < mBuffers.size(); ++t ){
+    total += mBuffers[t].mContacts.size();
+  }
+
+  // Which thread ran which batch changes from run to run, the batch order does not. Contacts come out in pair order
+  mContacts.resize( total );
+  size_t count = 0;
+  for( size_t i = 0; i < mBatches.size(); ++i ){
+    const Batch   &batch    = mBatches[i];
+    const Contact *contacts = mBuffers[batch.mThread].mContacts.data();
+    for( Uint32 c = batch.mFirst; c < batch.mLast; ++c ){
+      mContacts[count++] = contacts[c];
+    }
+  }
+
+  for( size_t t = 0; t < mBuffers.size(); ++t ){
+    mBuffers[t].mContacts.clear();
+  }
+}
+
+/**********************************************************************************************************************/
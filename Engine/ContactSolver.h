@@ -0,0 +1,149 @@
+#ifndef CONTACTSOLVER_H
+#define CONTACTSOLVER_H
+
+// Pairs from the broadphases
+#include "Broadphase.h"
+
+// Per-thread contact buffers
+#include <vector>
+
+/**
+Contact solver class
+Narrowphase and response for the pairs found by a broadphase. Bodies are axis aligned boxes; every overlapping pair
+becomes a contact with the separating axis, the penetration depth and the impulse and position correction that push
+the two bodies apart. Pairs are split in batches run as jobs, each job appending its contacts to the buffer of its
+thread. Contacts are computed from the state before the step, so jobs never write to bodies; the batches are then
+copied out of the buffers in batch order and applied on the calling thread. The merged order only depends on the pair
+order, so results are the same bit for bit whatever the number of threads
+*/
+class ContactSolver
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   PAIRS_PER_JOB   = 256;    ///< Pairs tested by one job
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Solved body, indexed by its ProxyId in the broadphase
+  */
+  struct Body
+  {
+    float   mX;               ///< Top left corner
+    float   mY;
+    float   mWidth;
+    float   mHeight;
+    float   mVelocityX;
+    float   mVelocityY;
+    float   mInverseMass;     ///< 0 for static bodies
+  };
+
+  /**
+  Overlapping pair
+  */
+  struct Contact
+  {
+    Uint32    mPair;          ///< Index of the pair in the solved array
+    ProxyId   mA;
+    ProxyId   mB;
+    float     mNormalX;       ///< Separating axis, from A to B
+    float     mNormalY;
+    float     mDepth;         ///< Penetration along the normal
+    float     mImpulse;       ///< Velocity change along the normal per unit of inverse mass
+    float     mCorrection;    ///< Position change along the normal per unit of inverse mass
+  };
+
+private:
+
+  /**
+  Contacts found by one batch, stored in a thread buffer
+  */
+  struct Batch
+  {
+    Uint32  mThread;    ///< Thread that ran the batch
+    Uint32  mFirst;     ///< First contact in the thread buffer
+    Uint32  mLast;      ///< One past the last contact
+  };
+
+  /**
+  Contacts found by one thread
+  */
+  struct ThreadBuffer
+  {
+    Uint8                 mPadBefore[64]; ///< The vector of a buffer gets a cache line to itself even when mBuffers
+                                          ///< does not start on a line boundary, which VS2015 does not guarantee
+    std::vector<Contact>  mContacts;      ///< Contacts in the order found, batch after batch
+    Uint8                 mPadAfter[64];  ///< See mPadBefore
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Creates one buffer per JobManager thread, so the JobManager must exist
+  @param restitution Fraction of the approach speed given back, 0 for no bounce
+  @param correction Fraction of the penetration removed per step
+  @param slop Penetration in pixels left alone, avoids jitter of resting bodies
+  */
+  explicit ContactSolver( float restitution = 0.0f, float correction = 0.8f, float slop = 0.05f );
+
+  /**
+  Finds the contacts of the pairs and applies them to the bodies
+  @param bodies Bodies indexed by ProxyId, velocities and positions are updated
+  @param pairs Broadphase pairs. Every pair must reference valid bodies
+  @param pairCount Number of pairs
+  @param parallel False runs every batch on the calling thread, with the same results
+  @return Number of contacts
+  */
+  Uint32 Solve( Body *bodies, const BroadphasePair *pairs, Uint32 pairCount, bool parallel = true );
+
+  /**
+  Returns the contacts of the last Solve, in pair order
+  */
+  inline const std::vector<Contact> &GetContacts( void ) const {
+    return mContacts;
+  }
+
+private:
+
+  /**
+  Narrowphase and response of one pair
+  @return True if the bodies overlap, contact is set on success
+  */
+  bool Collide( const Body &a, const Body &b, Contact &contact ) const;
+
+  /**
+  Tests the pairs of a batch and appends the contacts to the buffer of the calling thread
+  @param batch Batch index, the batch covers pairs [batch * PAIRS_PER_JOB, last)
+  */
+  void CollideBatch( const Body *bodies, const BroadphasePair *pairs, Uint32 batch, Uint32 last );
+
+  /**
+  Copies the contacts of every batch to mContacts in batch order and empties the thread buffers
+  */
+  void MergeContacts( void );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<ThreadBuffer>   mBuffers;       ///< One per JobManager thread, indexed by thread index
+  std::vector<Batch>          mBatches;       ///< Batches of the current Solve, each written by its own job
+  std::vector<Contact>        mContacts;      ///< Merged contacts of the last Solve
+  float                       mRestitution;   ///< Bounce factor
+  float                       mCorrection;    ///< Penetration fraction removed per step
+  float                       mSlop;          ///< Penetration tolerance
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,89 @@
+#include "ContinuousCollision.h"
+
+// sqrt, floor
+#include <cmath>
+
+/**********************************************************************************************************************/
+
+const float ContinuousCollision::SKIN = 0.01f;
+
+/**********************************************************************************************************************/
+
+Uint32 ContinuousCollision::Sweep( const DynamicAABBTree &tree, const Collider &collider, Position &position,
+                                   Velocity &velocity )
+{
+  float   x     = collider.mPreviousX;
+  float   y     = collider.mPreviousY;
+  float   dx    = position.x - x;
+  float   dy    = position.y - y;
+  Uint32  hits  = 0;
+
+  for( Uint32 step = 0; step < MAX_SUBSTEPS; ++step ){
+    DynamicAABBTree::RayHit hit;
+    if( !tree.SweepRect( x, y, collider.mWidth, collider.mHeight, dx, dy, hit, collider.mProxy ) ){
+      x += dx;
+      y += dy;
+      break;
+    }
+    ++hits;
+
+    // Stop a little before the contact so the next sweep does not start touching the obstacle
+    const float length    = std::sqrt( dx * dx + dy * dy );
+    float       fraction  = hit.mFraction - SKIN / length;
+    if( fraction < 0.0f ){
+      fraction = 0.0f;
+    }
+    x += dx * fraction;
+    y += dy * fraction;
+
+    // Slide: the rest of the motion continues without the component into the obstacle
+    const float remaining = 1.0f - fraction;
+    dx *= remaining;
+    dy *= remaining;
+    if( hit.mNormalX != 0.0f ){
+      dx          = 0.0f;
+      velocity.x  = 0.0f;
+    }
+    if( hit.mNormalY != 0.0f ){
+      dy          = 0.0f;
+      velocity.y  = 0.0f;
+    }
+    if( dx == 0.0f && dy == 0.0f ){
+      break;
+    }
+  }
+
+  position.x = x;
+  position.y = y;
+  return hits;
+}
+
+/**********************************************************************************************************************/
+
+void ContinuousCollisionSystem::Update( EntityWorld &world, float /*deltaTime*/ )
+{
+  DynamicAABBTree  &tree    = mTree;
+  Uint32            sweeps  = 0;
+
+  world.ForEach<Position, Velocity, Collider>(
+    [&tree, &sweeps]( Position &position, Velocity &velocity, Collider &collider ){
+      if( ContinuousCollision::NeedsSweep( collider, position.x - collider.mPreviousX,
+                                           position.y - collider.mPreviousY ) ){
+        ContinuousCollision::Sweep( tree, collider, position, velocity );
+        ++sweeps;
+      }
+
+      // Rects are on whole pixels, rounded down like the rendering
+      const SDL_Rect rect = { static_cast<int>( std::floor( position.x ) ),
+                              static_cast<int>( std::floor( position.y ) ),
+                              static_cast<int>( collider.mWidth ),
+                              static_cast<int>( collider.mHeight ) };
+      tree.MoveProxy( collider.mProxy, rect, position.x - collider.mPreviousX, position.y - collider.mPreviousY );
+      collider.mPreviousX = position.x;
+      collider.mPreviousY = position.y;
+    } );
+
+  mSweeps = sweeps;
+}
+
+/**********************************************************************************************************************/
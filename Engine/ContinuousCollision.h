@@ -0,0 +1,121 @@
+#ifndef CONTINUOUSCOLLISION_H
+#define CONTINUOUSCOLLISION_H
+
+// Swept tests against the broadphase
+#include "DynamicAABBTree.h"
+
+// Position and Velocity components
+#include "Movement.h"
+
+/**********************************************************************************************************************/
+// COMPONENTS
+/**********************************************************************************************************************/
+
+/**
+Rect of an entity registered in a DynamicAABBTree. The rect is mWidth x mHeight with its top left corner at Position
+*/
+struct Collider
+{
+  ProxyId   mProxy;         ///< Proxy in the tree, created by the owner of the tree
+  float     mWidth;
+  float     mHeight;
+  float     mPreviousX;     ///< Position at the end of the previous step, where the sweep starts
+  float     mPreviousY;
+  Uint32    mContinuous;    ///< Nonzero for bodies fast enough to pass through thin obstacles in one step
+};
+
+/**********************************************************************************************************************/
+
+/**
+Continuous collision class
+Stops fast bodies at the first obstacle on their path instead of at their end position. A body moving more than half
+its own size in one step can jump over thin obstacles, so its rect is swept from the previous position to the new one
+through the tree and the time of impact is exact. After an impact the remaining motion slides along the obstacle, which
+may hit another one: each slide is a sub-step, so only bodies that hit something pay for more than one sweep
+*/
+class ContinuousCollision
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   MAX_SUBSTEPS  = 4;        ///< Sweeps per body and step, the rest of the motion is dropped
+  static const float    SKIN;                     ///< Distance in pixels kept from obstacles after an impact
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Returns true if a body moves far enough in one step to need a sweep
+  @param collider Body rect
+  @param dx Displacement of the step
+  @param dy
+  */
+  static inline bool NeedsSweep( const Collider &collider, float dx, float dy ){
+    const float limitX = collider.mWidth * 0.5f;
+    const float limitY = collider.mHeight * 0.5f;
+    return collider.mContinuous != 0 && ( dx > limitX || -dx > limitX || dy > limitY || -dy > limitY );
+  }
+
+  /**
+  Moves a rect from its previous position towards a target position, stopping and sliding at obstacles
+  @param tree Obstacles
+  @param collider Moving rect, its own proxy is ignored
+  @param position Target position, replaced by the reachable position
+  @param velocity Components towards hit obstacles are removed
+  @return Number of obstacles hit
+  */
+  static Uint32 Sweep( const DynamicAABBTree &tree, const Collider &collider, Position &position, Velocity &velocity );
+};
+
+/**********************************************************************************************************************/
+
+/**
+Continuous collision system class
+Runs after MovementSystem. Fast continuous bodies are swept and corrected, every body then has its proxy moved to the
+new position. Slow bodies are only moved, so the cost grows with the number of fast bodies and not with the total.
+Slow bodies get no collision response here: a body ending a step overlapping an obstacle stays there, and separating
+it is left to a discrete pass over the tree pairs such as ContactSolver. Sweeps also ignore obstacles already
+overlapped at the start of the step, so a body has to be separated before its next sweep can stop it.
+Entities with a Collider must be registered in the tree, which no other system may use at the same time
+*/
+class ContinuousCollisionSystem : public System
+{
+public:
+
+  /**
+  Constructor
+  @param tree Tree holding the proxies of the colliders and the static obstacles
+  */
+  explicit ContinuousCollisionSystem( DynamicAABBTree &tree )
+    : System("ContinuousCollision"), mTree(tree), mSweeps(0)
+  {
+    Writes<Position, Velocity, Collider>();
+  }
+
+  /**
+  Sweeps fast bodies and moves all proxies
+  */
+  virtual void Update( EntityWorld &world, float deltaTime );
+
+  /**
+  Returns the number of bodies swept by the last Update
+  */
+  inline Uint32 GetSweepCount( void ) const {
+    return mSweeps;
+  }
+
+private:
+
+  DynamicAABBTree  &mTree;      ///< Broadphase
+  Uint32            mSweeps;    ///< Bodies swept by the last Update
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,212 @@
+#include "ControllerManager.h"
+
+// memset
+#include <cstring>
+
+// sqrt, pow
+#include <cmath>
+
+/**********************************************************************************************************************/
+
+const float ControllerManager::DEFAULT_STICK_DEAD_ZONE    = 0.24f;   // XInput left stick recommendation
+const float ControllerManager::DEFAULT_TRIGGER_DEAD_ZONE  = 0.12f;   // XInput trigger threshold
+const float ControllerManager::DEFAULT_RESPONSE_EXPONENT  = 1.5f;
+
+/**********************************************************************************************************************/
+
+ControllerManager::ControllerManager( ActionMap &actions )
+  : mActions(actions), mStickDeadZone(DEFAULT_STICK_DEAD_ZONE), mTriggerDeadZone(DEFAULT_TRIGGER_DEAD_ZONE),
+    mResponseExponent(DEFAULT_RESPONSE_EXPONENT)
+{
+}
+
+/**********************************************************************************************************************/
+
+ControllerManager::~ControllerManager( void )
+{
+  CloseAll();
+}
+
+/**********************************************************************************************************************/
+
+bool ControllerManager::HandleEvent( const SDL_Event &event )
+{
+  switch( event.type ){
+  case SDL_CONTROLLERDEVICEADDED:
+    Open( event.cdevice.which );
+    return false;
+  case SDL_CONTROLLERDEVICEREMOVED:
+    {
+      const size_t index = Find( event.cdevice.which );
+      if( index < mControllers.size() ){
+        Close( index );
+        return true;
+      }
+    }
+    return false;
+  case SDL_CONTROLLERBUTTONDOWN:
+  case SDL_CONTROLLERBUTTONUP:
+    {
+      const size_t index = Find( event.cbutton.which );
+      if( index >= mControllers.size() || event.cbutton.button >= SDL_CONTROLLER_BUTTON_MAX ){
+        return false;
+      }
+      const Uint32 bit = 1u << event.cbutton.button;
+      Uint32 &buttons  = mControllers[index].mButtons;
+      buttons = event.type == SDL_CONTROLLERBUTTONDOWN ? buttons | bit : buttons & ~bit;
+      WriteButton( static_cast<SDL_GameControllerButton>( event.cbutton.button ) );
+    }
+    return true;
+  case SDL_CONTROLLERAXISMOTION:
+    {
+      const size_t index = Find( event.caxis.which );
+      if( index >= mControllers.size() || event.caxis.axis >= SDL_CONTROLLER_AXIS_MAX ){
+        return false;
+      }
+      return OnAxis( mControllers[index], static_cast<SDL_GameControllerAxis>( event.caxis.axis ), event.caxis.value );
+    }
+  default:
+    return false;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ControllerManager::CloseAll( void )
+{
+  while( !mControllers.empty() ){
+    Close( mControllers.size() - 1 );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ControllerManager::SetFilter( float stickDeadZone, float triggerDeadZone, float responseExponent )
+{
+  mStickDeadZone    = stickDeadZone;
+  mTriggerDeadZone  = triggerDeadZone;
+  mResponseExponent = responseExponent;
+}
+
+/**********************************************************************************************************************/
+
+void ControllerManager::Open( int deviceIndex )
+{
+  SDL_GameController *handle = SDL_GameControllerOpen( deviceIndex );
+  if( handle == NULL ){
+    SDL_LogWarn( SDL_LOG_CATEGORY_INPUT, "Unable to open game controller %d: %s", deviceIndex, SDL_GetError() );
+    return;
+  }
+
+  // SDL may report a controller twice, opening it again only adds a reference
+  const SDL_JoystickID instance = SDL_JoystickInstanceID( SDL_GameControllerGetJoystick( handle ) );
+  if( Find( instance ) < mControllers.size() ){
+    SDL_GameControllerClose( handle );
+    return;
+  }
+
+  Controller controller;
+  memset( &controller, 0, sizeof( controller ) );
+  controller.mHandle    = handle;
+  controller.mInstance  = instance;
+  mControllers.push_back( controller );
+  SDL_Log( "Game controller connected: %s", SDL_GameControllerName( handle ) );
+}
+
+/**********************************************************************************************************************/
+
+void ControllerManager::Close( size_t index )
+{
+  // Removed from the merge before its input is released, so buttons held on other controllers stay down
+  Controller controller = mControllers[index];
+  mControllers.erase( mControllers.begin() + index );
+
+  for( int button = 0; button < SDL_CONTROLLER_BUTTON_MAX; ++button ){
+    if( controller.mButtons >> button & 1 ){
+      WriteButton( static_cast<SDL_GameControllerButton>( button ) );
+    }
+  }
+  for( int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; ++axis ){
+    if( controller.mAxes[axis] != 0.0f ){
+      mActions.SetControllerAxis( static_cast<SDL_GameControllerAxis>( axis ), 0.0f );
+    }
+  }
+
+  SDL_Log( "Game controller disconnected: %s", SDL_GameControllerName( controller.mHandle ) );
+  SDL_GameControllerClose( controller.mHandle );
+}
+
+/**********************************************************************************************************************/
+
+size_t ControllerManager::Find( SDL_JoystickID instance ) const
+{
+  for( size_t i = 0; i < mControllers.size(); ++i ){
+    if( mControllers[i].mInstance == instance ){
+      return i;
+    }
+  }
+  return mControllers.size();
+}
+
+/**********************************************************************************************************************/
+
+bool ControllerManager::OnAxis( Controller &controller, SDL_GameControllerAxis axis, Sint16 value )
+{
+  controller.mRaw[axis] = value;
+
+  if( axis == SDL_CONTROLLER_AXIS_TRIGGERLEFT || axis == SDL_CONTROLLER_AXIS_TRIGGERRIGHT ){
+    return WriteAxis( controller, axis, Shape( value / 32767.0f, mTriggerDeadZone ) );
+  }
+
+  // Both axes of the stick, the dead zone applies to the distance from the center
+  const SDL_GameControllerAxis axisX = axis == SDL_CONTROLLER_AXIS_LEFTX || axis == SDL_CONTROLLER_AXIS_LEFTY ?
+                                       SDL_CONTROLLER_AXIS_LEFTX : SDL_CONTROLLER_AXIS_RIGHTX;
+  const SDL_GameControllerAxis axisY = static_cast<SDL_GameControllerAxis>( axisX + 1 );
+  const float x         = controller.mRaw[axisX] / 32767.0f;
+  const float y         = controller.mRaw[axisY] / 32767.0f;
+  const float magnitude = std::sqrt( x * x + y * y );
+  const float shaped    = Shape( magnitude, mStickDeadZone );
+  const float scale     = shaped > 0.0f ? shaped / magnitude : 0.0f;
+
+  // Non short-circuit OR: both axes must be written
+  const bool changedX = WriteAxis( controller, axisX, x * scale );
+  const bool changedY = WriteAxis( controller, axisY, y * scale );
+  return changedX || changedY;
+}
+
+/**********************************************************************************************************************/
+
+bool ControllerManager::WriteAxis( Controller &controller, SDL_GameControllerAxis axis, float value )
+{
+  value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+  if( value == controller.mAxes[axis] ){
+    return false;
+  }
+  controller.mAxes[axis] = value;
+  mActions.SetControllerAxis( axis, value );
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void ControllerManager::WriteButton( SDL_GameControllerButton button )
+{
+  Uint32 held = 0;
+  for( size_t i = 0; i < mControllers.size(); ++i ){
+    held |= mControllers[i].mButtons;
+  }
+  mActions.SetControllerButton( button, ( held >> button & 1 ) != 0 );
+}
+
+/**********************************************************************************************************************/
+
+float ControllerManager::Shape( float magnitude, float deadZone ) const
+{
+  if( magnitude <= deadZone ){
+    return 0.0f;
+  }
+  const float rescaled = ( magnitude - deadZone ) / ( 1.0f - deadZone );
+  return std::pow( rescaled < 1.0f ? rescaled : 1.0f, mResponseExponent );
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,146 @@
+#ifndef CONTROLLERMANAGER_H
+#define CONTROLLERMANAGER_H
+
+// Controller state is written into the actions
+#include "ActionMap.h"
+
+// Open controllers
+#include <vector>
+
+/**
+Controller manager class
+Opens game controllers as they are plugged in and closes them when they are removed, including the ones present at
+start, which SDL reports as added. Button and axis events are filtered once per change and written into an ActionMap:
+sticks get a radial dead zone, so diagonals are not clipped, triggers a linear one, and the remaining range is rescaled
+to [0, 1] and shaped by a response curve. Nothing is polled, so idle controllers cost nothing per frame.
+Buttons of several controllers are merged, axes take the value of the controller that moved last
+*/
+class ControllerManager
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const float DEFAULT_STICK_DEAD_ZONE;     ///< Fraction of the stick range ignored around the center
+  static const float DEFAULT_TRIGGER_DEAD_ZONE;   ///< Fraction of the trigger range ignored at rest
+  static const float DEFAULT_RESPONSE_EXPONENT;   ///< Response curve, 1 is linear, higher gives finer slow moves
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Open controller
+  */
+  struct Controller
+  {
+    SDL_GameController *mHandle;                          ///< SDL controller
+    SDL_JoystickID      mInstance;                        ///< Id used by the events of the controller
+    Uint32              mButtons;                         ///< Bit per SDL_GameControllerButton held
+    float               mAxes[SDL_CONTROLLER_AXIS_MAX];   ///< Filtered value per axis
+    Sint16              mRaw[SDL_CONTROLLER_AXIS_MAX];    ///< Last raw value per axis
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param actions Action map receiving the controller state
+  */
+  explicit ControllerManager( ActionMap &actions );
+
+  /**
+  Destructor. Closes the open controllers
+  */
+  ~ControllerManager( void );
+
+  /**
+  Handles controller device, button and axis events. Other events are ignored
+  @param event Any SDL event
+  @return True if the event changed the state of the actions
+  */
+  bool HandleEvent( const SDL_Event &event );
+
+  /**
+  Closes every controller and releases their input
+  */
+  void CloseAll( void );
+
+  /**
+  Filter settings. Apply to the next change of every axis
+  @param stickDeadZone Fraction of the stick range ignored, in [0, 1)
+  @param triggerDeadZone Fraction of the trigger range ignored, in [0, 1)
+  @param responseExponent Exponent applied to the rescaled deflection
+  */
+  void SetFilter( float stickDeadZone, float triggerDeadZone, float responseExponent );
+
+  /**
+  Getters
+  */
+  inline Uint32 GetControllerCount( void ) const {
+    return static_cast<Uint32>( mControllers.size() );
+  }
+
+private:
+
+  /**
+  Opens a controller
+  @param deviceIndex Joystick device index of the added event
+  */
+  void Open( int deviceIndex );
+
+  /**
+  Closes a controller and releases its input
+  @param index Index in mControllers
+  */
+  void Close( size_t index );
+
+  /**
+  Returns the index of a controller in mControllers, or mControllers.size()
+  */
+  size_t Find( SDL_JoystickID instance ) const;
+
+  /**
+  Filters a raw axis change and writes the result. Sticks refilter both axes of the stick
+  @return True if a filtered value changed
+  */
+  bool OnAxis( Controller &controller, SDL_GameControllerAxis axis, Sint16 value );
+
+  /**
+  Writes a filtered axis value if it changed
+  @return True if it changed
+  */
+  bool WriteAxis( Controller &controller, SDL_GameControllerAxis axis, float value );
+
+  /**
+  Writes a button as the merge of every controller
+  */
+  void WriteButton( SDL_GameControllerButton button );
+
+  /**
+  Rescales a magnitude beyond the dead zone to [0, 1] and applies the response curve
+  */
+  float Shape( float magnitude, float deadZone ) const;
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  ActionMap                &mActions;             ///< Receives the filtered state
+  std::vector<Controller>   mControllers;         ///< Open controllers
+  float                     mStickDeadZone;       ///< Radial dead zone of sticks
+  float                     mTriggerDeadZone;     ///< Dead zone of triggers
+  float                     mResponseExponent;    ///< Response curve exponent
+};
+
+/**********************************************************************************************************************/
+
+#endif
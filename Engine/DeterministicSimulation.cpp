@@ -0,0 +1,61 @@
+#include "DeterministicSimulation.h"
+
+/**********************************************************************************************************************/
+
+static const Uint32 FNV_PRIME = 16777619u;
+
+/**********************************************************************************************************************/
+
+DeterministicSimulation::DeterministicSimulation( Uint64 seed, Uint32 tickRate, Uint32 maxTicksPerFrame )
+  : mSeed(seed), mTickRate(tickRate), mMaxTicksPerFrame(maxTicksPerFrame), mAccumulator(0)
+{
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DeterministicSimulation::Advance( Uint32 elapsedMilliseconds )
+{
+  // In units of 1 / (1000 * tick rate) seconds one tick is exactly 1000 units, no rounding anywhere
+  mAccumulator += elapsedMilliseconds * mTickRate;
+  Uint32 ticks  = mAccumulator / 1000;
+  mAccumulator %= 1000;
+
+  // After a stall, skip the backlog instead of spending the next frames catching up
+  return ticks < mMaxTicksPerFrame ? ticks : mMaxTicksPerFrame;
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DeterministicSimulation::EndTick( Uint32 stateChecksum )
+{
+  Uint32 checksum = stateChecksum;
+  for( size_t i = 0; i < mStreams.size(); ++i ){
+    const Uint64 state = mStreams[i].GetState();
+    checksum = HashBytes( &state, sizeof( state ), checksum );
+  }
+  mChecksums.push_back( checksum );
+  return checksum;
+}
+
+/**********************************************************************************************************************/
+
+RandomStream &DeterministicSimulation::GetStream( Uint32 index )
+{
+  while( mStreams.size() <= index ){
+    mStreams.push_back( RandomStream( mSeed, mStreams.size() ) );
+  }
+  return mStreams[index];
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DeterministicSimulation::HashBytes( const void *data, size_t size, Uint32 hash )
+{
+  const Uint8 *bytes = static_cast<const Uint8*>( data );
+  for( size_t i = 0; i < size; ++i ){
+    hash = ( hash ^ bytes[i] ) * FNV_PRIME;
+  }
+  return hash;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,145 @@
+#ifndef DETERMINISTICSIMULATION_H
+#define DETERMINISTICSIMULATION_H
+
+// Component hashing
+#include "EntityWorld.h"
+
+// Tick duration
+#include "FixedPoint.h"
+
+// Seeded streams
+#include "RandomStream.h"
+
+// Streams and checksum history
+#include <vector>
+
+/**
+Deterministic simulation class
+Drives a simulation at a fixed tick rate. Real time is accumulated in integer milliseconds and turned into whole ticks,
+so the simulation only ever sees the same constant step. Random numbers come from streams seeded from one master seed
+and every tick ends with a checksum of the simulated state, mixed with the state of the streams. Two runs fed with the
+same inputs at the same ticks produce the same checksums; the first differing tick shows where they diverged
+*/
+class DeterministicSimulation
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   DEFAULT_TICK_RATE             = 60;           ///< Ticks per second
+  static const Uint32   DEFAULT_MAX_TICKS_PER_FRAME   = 8;            ///< Backlog dropped beyond this, after stalls
+  static const Uint32   CHECKSUM_SEED                 = 2166136261u;  ///< FNV-1a offset basis
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param seed Master seed of the random streams
+  @param tickRate Ticks per second
+  @param maxTicksPerFrame Most ticks Advance returns at once
+  */
+  explicit DeterministicSimulation( Uint64 seed, Uint32 tickRate = DEFAULT_TICK_RATE,
+                                    Uint32 maxTicksPerFrame = DEFAULT_MAX_TICKS_PER_FRAME );
+
+  /**
+  Adds elapsed real time
+  @param elapsedMilliseconds Time since the previous call
+  @return Number of ticks to run now
+  */
+  Uint32 Advance( Uint32 elapsedMilliseconds );
+
+  /**
+  Ends the current tick and records its checksum
+  @param stateChecksum Checksum of the simulated state after the tick, see HashComponents
+  @return Checksum of the tick, including the random streams
+  */
+  Uint32 EndTick( Uint32 stateChecksum );
+
+  /**
+  Returns a random stream, created on first use. Stream index i always starts from the same point for a given seed
+  */
+  RandomStream &GetStream( Uint32 index );
+
+  /**
+  Hashes components of every entity having them, in iteration order. Components must have no padding bytes
+  @param world Simulated world
+  @param hash Running hash to continue
+  @return Updated hash
+  */
+  template<typename... Components>
+  static Uint32 HashComponents( EntityWorld &world, Uint32 hash = CHECKSUM_SEED );
+
+  /**
+  FNV-1a hash of raw bytes
+  */
+  static Uint32 HashBytes( const void *data, size_t size, Uint32 hash = CHECKSUM_SEED );
+
+  /**
+  Getters. GetTickSeconds is the same step for systems taking float seconds, only for code that does not need to be
+  deterministic. GetChecksums holds one checksum per finished tick, about 14 KB per minute at 60 ticks per second
+  */
+  inline Uint64 GetSeed( void ) const {
+    return mSeed;
+  }
+  inline Uint32 GetTickRate( void ) const {
+    return mTickRate;
+  }
+  inline Uint32 GetTick( void ) const {
+    return static_cast<Uint32>( mChecksums.size() );
+  }
+  inline Fixed GetTickDuration( void ) const {
+    return Fixed::FromRatio( 1, static_cast<int>( mTickRate ) );
+  }
+  inline float GetTickSeconds( void ) const {
+    return 1.0f / mTickRate;
+  }
+  inline const std::vector<Uint32> &GetChecksums( void ) const {
+    return mChecksums;
+  }
+
+private:
+
+  /**
+  Hashes one value of each component type
+  */
+  static inline Uint32 HashValues( Uint32 hash ){
+    return hash;
+  }
+  template<typename Component, typename... Others>
+  static inline Uint32 HashValues( Uint32 hash, const Component &component, const Others&... others ){
+    return HashValues( HashBytes( &component, sizeof( Component ), hash ), others... );
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<RandomStream>   mStreams;           ///< Streams by index
+  std::vector<Uint32>         mChecksums;         ///< Checksum of every finished tick
+  Uint64                      mSeed;              ///< Master seed
+  Uint32                      mTickRate;          ///< Ticks per second
+  Uint32                      mMaxTicksPerFrame;  ///< Advance limit
+  Uint32                      mAccumulator;       ///< Milliseconds * tick rate not yet turned into ticks
+};
+
+/**********************************************************************************************************************/
+
+template<typename... Components>
+Uint32 DeterministicSimulation::HashComponents( EntityWorld &world, Uint32 hash )
+{
+  world.ForEachEntity<Components...>( [&hash]( Entity entity, Components&... components ){
+    const Uint64 key = entity.GetKey();
+    hash = HashValues( HashBytes( &key, sizeof( key ), hash ), components... );
+  } );
+  return hash;
+}
+
+/**********************************************************************************************************************/
+
+#endif
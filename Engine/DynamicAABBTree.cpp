@@ -0,0 +1,656 @@
+#include "DynamicAABBTree.h"
+
+// Batch queries
+#include "JobManager.h"
+
+// Invalid proxy checks
+#include "AssertionManager.h"
+
+// fabsf
+#include <cmath>
+
+/**********************************************************************************************************************/
+
+const float   DynamicAABBTree::DEFAULT_MARGIN = 8.0f;
+const Uint32  DynamicAABBTree::NULL_NODE;
+const Uint32  DynamicAABBTree::MAX_STACK;
+const Uint32  DynamicAABBTree::BATCH_JOB_SIZE;
+
+/**********************************************************************************************************************/
+
+DynamicAABBTree::DynamicAABBTree( float margin )
+  : mRoot(NULL_NODE), mFreeList(NULL_NODE), mProxyCount(0), mMargin(margin)
+{
+}
+
+/**********************************************************************************************************************/
+
+ProxyId DynamicAABBTree::CreateProxy( const SDL_Rect &rect, Uint64 userData )
+{
+  const Uint32 leaf = AllocateNode();
+
+  Node &node      = mNodes[leaf];
+  node.mRect      = rect;
+  node.mUserData  = userData;
+  node.mHeight    = 0;
+  Fatten( node, 0.0f, 0.0f );
+
+  InsertLeaf( leaf );
+  ++mProxyCount;
+  return leaf;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::DestroyProxy( ProxyId proxy )
+{
+  AssertMessage( proxy < mNodes.size() && mNodes[proxy].mHeight == 0, "Destroying an invalid proxy" );
+  if( proxy >= mNodes.size() || mNodes[proxy].mHeight != 0 ){
+    return;
+  }
+
+  RemoveLeaf( proxy );
+  FreeNode( proxy );
+  --mProxyCount;
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::MoveProxy( ProxyId proxy, const SDL_Rect &rect, float displacementX, float displacementY )
+{
+  AssertMessage( proxy < mNodes.size() && mNodes[proxy].mHeight == 0, "Moving an invalid proxy" );
+  if( proxy >= mNodes.size() || mNodes[proxy].mHeight != 0 ){
+    return false;
+  }
+
+  Node &node  = mNodes[proxy];
+  node.mRect  = rect;
+  if( Contains( node.mBox, ToBox( rect ) ) ){
+    return false;
+  }
+
+  RemoveLeaf( proxy );
+  Fatten( mNodes[proxy], displacementX, displacementY );
+  InsertLeaf( proxy );
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::Clear( void )
+{
+  mNodes.clear();
+  mRoot       = NULL_NODE;
+  mFreeList   = NULL_NODE;
+  mProxyCount = 0;
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DynamicAABBTree::Query( const SDL_Rect &region, ProxyId *results, Uint32 capacity ) const
+{
+  const Box area  = ToBox( region );
+  Uint32    count = 0;
+
+  Uint32 stack[MAX_STACK];
+  Uint32 size = 0;
+  if( mRoot != NULL_NODE ){
+    stack[size++] = mRoot;
+  }
+
+  while( size > 0 ){
+    const Uint32  index = stack[--size];
+    const Node   &node  = mNodes[index];
+    if( node.mBox.mMaxX < area.mMinX || area.mMaxX < node.mBox.mMinX ||
+        node.mBox.mMaxY < area.mMinY || area.mMaxY < node.mBox.mMinY ){
+      continue;
+    }
+
+    if( node.IsLeaf() ){
+      if( RectsOverlap( node.mRect, region ) ){
+        if( count < capacity ){
+          results[count] = index;
+        }
+        ++count;
+      }
+    }
+    else{
+      AssertMessage( size + 2 <= MAX_STACK, "AABB tree traversal stack overflow" );
+      stack[size++] = node.mChild1;
+      stack[size++] = node.mChild2;
+    }
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::RayCast( const Ray &ray, RayHit &hit ) const
+{
+  hit.mProxy    = INVALID_PROXY;
+  hit.mFraction = 1.0f;
+
+  Uint32 stack[MAX_STACK];
+  Uint32 size = 0;
+  if( mRoot != NULL_NODE ){
+    stack[size++] = mRoot;
+  }
+
+  // Every hit shortens the segment, so later boxes are rejected earlier
+  while( size > 0 ){
+    const Uint32  index = stack[--size];
+    const Node   &node  = mNodes[index];
+
+    float fraction;
+    float normalX;
+    float normalY;
+    if( !IntersectSegment( node.mBox, ray, hit.mFraction, fraction, normalX, normalY ) ){
+      continue;
+    }
+
+    if( node.IsLeaf() ){
+      if( node.mRect.w > 0 && node.mRect.h > 0 &&
+          IntersectSegment( ToBox( node.mRect ), ray, hit.mFraction, fraction, normalX, normalY ) &&
+          ( hit.mProxy == INVALID_PROXY || fraction < hit.mFraction ) ){
+        hit.mProxy    = index;
+        hit.mFraction = fraction;
+        hit.mNormalX  = normalX;
+        hit.mNormalY  = normalY;
+      }
+    }
+    else{
+      AssertMessage( size + 2 <= MAX_STACK, "AABB tree traversal stack overflow" );
+      stack[size++] = node.mChild1;
+      stack[size++] = node.mChild2;
+    }
+  }
+
+  if( hit.mProxy == INVALID_PROXY ){
+    return false;
+  }
+  hit.mX = ray.mStartX + ( ray.mEndX - ray.mStartX ) * hit.mFraction;
+  hit.mY = ray.mStartY + ( ray.mEndY - ray.mStartY ) * hit.mFraction;
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::SweepRect( float x, float y, float w, float h, float dx, float dy, RayHit &hit,
+                                 ProxyId ignore ) const
+{
+  // The rect hits a box when its top left corner enters the box grown by the rect size to the top left, so the sweep
+  // is a raycast of the corner against grown boxes
+  const Ray ray = { x, y, x + dx, y + dy };
+  hit.mProxy    = INVALID_PROXY;
+  hit.mFraction = 1.0f;
+
+  Uint32 stack[MAX_STACK];
+  Uint32 size = 0;
+  if( mRoot != NULL_NODE ){
+    stack[size++] = mRoot;
+  }
+
+  while( size > 0 ){
+    const Uint32  index = stack[--size];
+    const Node   &node  = mNodes[index];
+
+    Box grown = node.mBox;
+    grown.mMinX -= w;
+    grown.mMinY -= h;
+
+    float fraction;
+    float normalX;
+    float normalY;
+    if( !IntersectSegment( grown, ray, hit.mFraction, fraction, normalX, normalY ) ){
+      continue;
+    }
+
+    if( node.IsLeaf() ){
+      if( index == ignore || node.mRect.w <= 0 || node.mRect.h <= 0 ){
+        continue;
+      }
+      grown       = ToBox( node.mRect );
+      grown.mMinX -= w;
+      grown.mMinY -= h;
+      if( EnterBox( grown, ray, hit.mFraction, fraction, normalX, normalY ) &&
+          ( hit.mProxy == INVALID_PROXY || fraction < hit.mFraction ) ){
+        hit.mProxy    = index;
+        hit.mFraction = fraction;
+        hit.mNormalX  = normalX;
+        hit.mNormalY  = normalY;
+      }
+    }
+    else{
+      AssertMessage( size + 2 <= MAX_STACK, "AABB tree traversal stack overflow" );
+      stack[size++] = node.mChild1;
+      stack[size++] = node.mChild2;
+    }
+  }
+
+  if( hit.mProxy == INVALID_PROXY ){
+    return false;
+  }
+  hit.mX = x + dx * hit.mFraction;
+  hit.mY = y + dy * hit.mFraction;
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::QueryBatch( const SDL_Rect *regions, std::vector<ProxyId> *results, Uint32 count ) const
+{
+  JobManager             &jobManager = JobManager::GetInstance();
+  JobManager::JobCounter  counter;
+
+  for( Uint32 first = 0; first < count; first += BATCH_JOB_SIZE ){
+    const Uint32 last = first + BATCH_JOB_SIZE < count ? first + BATCH_JOB_SIZE : count;
+    jobManager.AddJob( [this, regions, results, first, last]( void ){
+      for( Uint32 i = first; i < last; ++i ){
+        // Reuses the capacity of the result vector, a second pass only runs when it was too small
+        std::vector<ProxyId> &found = results[i];
+        found.resize( found.capacity() );
+        Uint32 total = Query( regions[i], found.empty() ? NULL : &found[0], static_cast<Uint32>( found.size() ) );
+        if( total > found.size() ){
+          found.resize( total );
+          Query( regions[i], &found[0], total );
+        }
+        found.resize( total );
+      }
+    }, &counter );
+  }
+  jobManager.Wait( counter );
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::RayCastBatch( const Ray *rays, RayHit *hits, Uint32 count ) const
+{
+  JobManager             &jobManager = JobManager::GetInstance();
+  JobManager::JobCounter  counter;
+
+  for( Uint32 first = 0; first < count; first += BATCH_JOB_SIZE ){
+    const Uint32 last = first + BATCH_JOB_SIZE < count ? first + BATCH_JOB_SIZE : count;
+    jobManager.AddJob( [this, rays, hits, first, last]( void ){
+      for( Uint32 i = first; i < last; ++i ){
+        RayCast( rays[i], hits[i] );
+      }
+    }, &counter );
+  }
+  jobManager.Wait( counter );
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DynamicAABBTree::AllocateNode( void )
+{
+  Uint32 index;
+  if( mFreeList != NULL_NODE ){
+    index     = mFreeList;
+    mFreeList = mNodes[index].mParent;
+  }
+  else{
+    index = static_cast<Uint32>( mNodes.size() );
+    mNodes.push_back( Node() );
+  }
+
+  Node &node    = mNodes[index];
+  node.mParent  = NULL_NODE;
+  node.mChild1  = NULL_NODE;
+  node.mChild2  = NULL_NODE;
+  node.mHeight  = 0;
+  return index;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::FreeNode( Uint32 node )
+{
+  mNodes[node].mParent  = mFreeList;
+  mNodes[node].mHeight  = -1;
+  mFreeList             = node;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::InsertLeaf( Uint32 leaf )
+{
+  if( mRoot == NULL_NODE ){
+    mRoot                 = leaf;
+    mNodes[leaf].mParent  = NULL_NODE;
+    return;
+  }
+
+  // Walk down to the sibling where inserting grows the total perimeter the least
+  const Box leafBox = mNodes[leaf].mBox;
+  Uint32    index   = mRoot;
+  while( !mNodes[index].IsLeaf() ){
+    const Node &node          = mNodes[index];
+    const float perimeter     = Perimeter( node.mBox );
+    const float combined      = Perimeter( Union( node.mBox, leafBox ) );
+
+    // Cost of a new parent for this node and the leaf, and cost pushed down to the children
+    const float cost          = 2.0f * combined;
+    const float inheritance   = 2.0f * ( combined - perimeter );
+
+    float childCosts[2];
+    const Uint32 children[2] = { node.mChild1, node.mChild2 };
+    for( int c = 0; c < 2; ++c ){
+      const Node &child = mNodes[children[c]];
+      childCosts[c] = Perimeter( Union( child.mBox, leafBox ) ) + inheritance;
+      if( !child.IsLeaf() ){
+        childCosts[c] -= Perimeter( child.mBox );
+      }
+    }
+
+    if( cost < childCosts[0] && cost < childCosts[1] ){
+      break;
+    }
+    index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+  }
+
+  const Uint32 sibling    = index;
+  const Uint32 oldParent  = mNodes[sibling].mParent;
+  const Uint32 newParent  = AllocateNode();
+
+  Node &parent    = mNodes[newParent];
+  parent.mParent  = oldParent;
+  parent.mBox     = Union( leafBox, mNodes[sibling].mBox );
+  parent.mHeight  = mNodes[sibling].mHeight + 1;
+  parent.mChild1  = sibling;
+  parent.mChild2  = leaf;
+
+  if( oldParent != NULL_NODE ){
+    if( mNodes[oldParent].mChild1 == sibling ){
+      mNodes[oldParent].mChild1 = newParent;
+    }
+    else{
+      mNodes[oldParent].mChild2 = newParent;
+    }
+  }
+  else{
+    mRoot = newParent;
+  }
+  mNodes[sibling].mParent = newParent;
+  mNodes[leaf].mParent    = newParent;
+
+  Refit( newParent );
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::RemoveLeaf( Uint32 leaf )
+{
+  if( leaf == mRoot ){
+    mRoot = NULL_NODE;
+    return;
+  }
+
+  const Uint32 parent       = mNodes[leaf].mParent;
+  const Uint32 grandParent  = mNodes[parent].mParent;
+  const Uint32 sibling      = mNodes[parent].mChild1 == leaf ? mNodes[parent].mChild2 : mNodes[parent].mChild1;
+
+  // The sibling takes the place of the parent
+  FreeNode( parent );
+  mNodes[sibling].mParent = grandParent;
+  if( grandParent == NULL_NODE ){
+    mRoot = sibling;
+    return;
+  }
+
+  if( mNodes[grandParent].mChild1 == parent ){
+    mNodes[grandParent].mChild1 = sibling;
+  }
+  else{
+    mNodes[grandParent].mChild2 = sibling;
+  }
+  Refit( grandParent );
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::Refit( Uint32 index )
+{
+  while( index != NULL_NODE ){
+    index = Balance( index );
+
+    Node        &node   = mNodes[index];
+    const Node  &child1 = mNodes[node.mChild1];
+    const Node  &child2 = mNodes[node.mChild2];
+    node.mHeight  = 1 + ( child1.mHeight > child2.mHeight ? child1.mHeight : child2.mHeight );
+    node.mBox     = Union( child1.mBox, child2.mBox );
+
+    index = node.mParent;
+  }
+}
+
+/**********************************************************************************************************************/
+
+Uint32 DynamicAABBTree::Balance( Uint32 iA )
+{
+  Node &a = mNodes[iA];
+  if( a.IsLeaf() || a.mHeight < 2 ){
+    return iA;
+  }
+
+  const Uint32  iB      = a.mChild1;
+  const Uint32  iC      = a.mChild2;
+  Node         &b       = mNodes[iB];
+  Node         &c       = mNodes[iC];
+  const int     balance = c.mHeight - b.mHeight;
+
+  // Rotate the higher child up. Its higher grandchild stays under it, the other one goes under the old node
+  if( balance > 1 || balance < -1 ){
+    const Uint32  iUp     = balance > 1 ? iC : iB;
+    const Uint32  iStay   = balance > 1 ? iB : iC;
+    Node         &up      = mNodes[iUp];
+    const Uint32  iF      = up.mChild1;
+    const Uint32  iG      = up.mChild2;
+    const bool    keepF   = mNodes[iF].mHeight > mNodes[iG].mHeight;
+    const Uint32  iKeep   = keepF ? iF : iG;
+    const Uint32  iMove   = keepF ? iG : iF;
+
+    up.mChild1  = iA;
+    up.mChild2  = iKeep;
+    up.mParent  = a.mParent;
+    a.mParent   = iUp;
+    if( up.mParent != NULL_NODE ){
+      if( mNodes[up.mParent].mChild1 == iA ){
+        mNodes[up.mParent].mChild1 = iUp;
+      }
+      else{
+        mNodes[up.mParent].mChild2 = iUp;
+      }
+    }
+    else{
+      mRoot = iUp;
+    }
+
+    a.mChild1               = iStay;
+    a.mChild2               = iMove;
+    mNodes[iMove].mParent   = iA;
+
+    const Node &stay  = mNodes[iStay];
+    const Node &moved = mNodes[iMove];
+    const Node &kept  = mNodes[iKeep];
+    a.mBox      = Union( stay.mBox, moved.mBox );
+    a.mHeight   = 1 + ( stay.mHeight > moved.mHeight ? stay.mHeight : moved.mHeight );
+    up.mBox     = Union( a.mBox, kept.mBox );
+    up.mHeight  = 1 + ( a.mHeight > kept.mHeight ? a.mHeight : kept.mHeight );
+    return iUp;
+  }
+  return iA;
+}
+
+/**********************************************************************************************************************/
+
+void DynamicAABBTree::Fatten( Node &leaf, float displacementX, float displacementY ) const
+{
+  leaf.mBox = ToBox( leaf.mRect );
+  leaf.mBox.mMinX -= mMargin;
+  leaf.mBox.mMinY -= mMargin;
+  leaf.mBox.mMaxX += mMargin;
+  leaf.mBox.mMaxY += mMargin;
+
+  // Predicted movement only extends the side the object moves toward
+  if( displacementX < 0.0f ){
+    leaf.mBox.mMinX += displacementX;
+  }
+  else{
+    leaf.mBox.mMaxX += displacementX;
+  }
+  if( displacementY < 0.0f ){
+    leaf.mBox.mMinY += displacementY;
+  }
+  else{
+    leaf.mBox.mMaxY += displacementY;
+  }
+}
+
+/**********************************************************************************************************************/
+
+DynamicAABBTree::Box DynamicAABBTree::Union( const Box &a, const Box &b )
+{
+  Box box;
+  box.mMinX = a.mMinX < b.mMinX ? a.mMinX : b.mMinX;
+  box.mMinY = a.mMinY < b.mMinY ? a.mMinY : b.mMinY;
+  box.mMaxX = a.mMaxX > b.mMaxX ? a.mMaxX : b.mMaxX;
+  box.mMaxY = a.mMaxY > b.mMaxY ? a.mMaxY : b.mMaxY;
+  return box;
+}
+
+/**********************************************************************************************************************/
+
+float DynamicAABBTree::Perimeter( const Box &box )
+{
+  return 2.0f * ( ( box.mMaxX - box.mMinX ) + ( box.mMaxY - box.mMinY ) );
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::Contains( const Box &outer, const Box &inner )
+{
+  return outer.mMinX <= inner.mMinX && outer.mMinY <= inner.mMinY &&
+         inner.mMaxX <= outer.mMaxX && inner.mMaxY <= outer.mMaxY;
+}
+
+/**********************************************************************************************************************/
+
+DynamicAABBTree::Box DynamicAABBTree::ToBox( const SDL_Rect &rect )
+{
+  Box box;
+  box.mMinX = static_cast<float>( rect.x );
+  box.mMinY = static_cast<float>( rect.y );
+  box.mMaxX = static_cast<float>( rect.x + ( rect.w > 0 ? rect.w : 0 ) );
+  box.mMaxY = static_cast<float>( rect.y + ( rect.h > 0 ? rect.h : 0 ) );
+  return box;
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::IntersectSegment( const Box &box, const Ray &ray, float maxFraction, float &fraction,
+                                        float &normalX, float &normalY )
+{
+  const float start[2]      = { ray.mStartX, ray.mStartY };
+  const float direction[2]  = { ray.mEndX - ray.mStartX, ray.mEndY - ray.mStartY };
+  const float minimum[2]    = { box.mMinX, box.mMinY };
+  const float maximum[2]    = { box.mMaxX, box.mMaxY };
+
+  // Slab test: the segment is inside the box between the latest entry and the earliest exit
+  float enter     = 0.0f;
+  float exit      = maxFraction;
+  float normal[2] = { 0.0f, 0.0f };
+  for( int axis = 0; axis < 2; ++axis ){
+    if( fabsf( direction[axis] ) < 1e-6f ){
+      if( start[axis] < minimum[axis] || start[axis] > maximum[axis] ){
+        return false;
+      }
+      continue;
+    }
+
+    const float inverse = 1.0f / direction[axis];
+    float       slabEnter = ( minimum[axis] - start[axis] ) * inverse;
+    float       slabExit  = ( maximum[axis] - start[axis] ) * inverse;
+    float       side      = -1.0f;
+    if( slabEnter > slabExit ){
+      const float swap = slabEnter;
+      slabEnter = slabExit;
+      slabExit  = swap;
+      side      = 1.0f;
+    }
+
+    if( slabEnter > enter ){
+      enter         = slabEnter;
+      normal[0]     = 0.0f;
+      normal[1]     = 0.0f;
+      normal[axis]  = side;
+    }
+    if( slabExit < exit ){
+      exit = slabExit;
+    }
+    if( enter > exit ){
+      return false;
+    }
+  }
+
+  fraction  = enter;
+  normalX   = normal[0];
+  normalY   = normal[1];
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+bool DynamicAABBTree::EnterBox( const Box &box, const Ray &ray, float maxFraction, float &fraction, float &normalX,
+                                float &normalY )
+{
+  const float start[2]      = { ray.mStartX, ray.mStartY };
+  const float direction[2]  = { ray.mEndX - ray.mStartX, ray.mEndY - ray.mStartY };
+  const float minimum[2]    = { box.mMinX, box.mMinY };
+  const float maximum[2]    = { box.mMaxX, box.mMaxY };
+
+  // Same slab test as IntersectSegment on the open box, without clamping the entry to the start of the segment
+  float enter     = -1.0f;
+  float exit      = maxFraction;
+  float normal[2] = { 0.0f, 0.0f };
+  for( int axis = 0; axis < 2; ++axis ){
+    if( direction[axis] == 0.0f ){
+      if( start[axis] <= minimum[axis] || start[axis] >= maximum[axis] ){
+        return false;
+      }
+      continue;
+    }
+
+    // Divided rather than multiplied by the inverse so that ending exactly on a side gives exactly maxFraction
+    float       slabEnter = ( minimum[axis] - start[axis] ) / direction[axis];
+    float       slabExit  = ( maximum[axis] - start[axis] ) / direction[axis];
+    float       side      = -1.0f;
+    if( slabEnter > slabExit ){
+      const float swap = slabEnter;
+      slabEnter = slabExit;
+      slabExit  = swap;
+      side      = 1.0f;
+    }
+
+    if( slabEnter > enter ){
+      enter         = slabEnter;
+      normal[0]     = 0.0f;
+      normal[1]     = 0.0f;
+      normal[axis]  = side;
+    }
+    if( slabExit < exit ){
+      exit = slabExit;
+    }
+  }
+
+  // Entering before the start means the point was already inside
+  if( enter < 0.0f || enter >= exit ){
+    return false;
+  }
+
+  fraction  = enter;
+  normalX   = normal[0];
+  normalY   = normal[1];
+  return true;
+}
+
+/**********************************************************************************************************************/
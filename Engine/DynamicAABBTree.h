@@ -0,0 +1,272 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+// Proxy type, rect overlap test
+#include "Broadphase.h"
+
+// Node pool, batch results
+#include <vector>
+
+/**
+Dynamic AABB tree class
+Bounding volume hierarchy over axis aligned rects for raycasts and region queries. Leaves store a fattened box around
+the rect, so small moves do not touch the tree. Leaves are inserted where the perimeter (the 2D surface area
+heuristic) grows the least and AVL-style rotations keep the tree balanced. Nodes live in a pool indexed by id and
+proxy ids are leaf node indices.
+Queries never modify the tree: any number of threads may query it while nobody changes it, and the batch versions
+spread their work on the JobManager
+*/
+class DynamicAABBTree
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const float    DEFAULT_MARGIN;                 ///< Pixels added around every rect
+
+private:
+
+  static const Uint32   NULL_NODE         = 0xFFFFFFFF; ///< No node
+  static const Uint32   MAX_STACK         = 256;        ///< Traversal depth, far above the height of a balanced tree
+  static const Uint32   BATCH_JOB_SIZE    = 64;         ///< Queries per job in batch calls
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Segment cast from start to end
+  */
+  struct Ray
+  {
+    float mStartX;
+    float mStartY;
+    float mEndX;
+    float mEndY;
+  };
+
+  /**
+  Closest rect hit by a ray
+  */
+  struct RayHit
+  {
+    ProxyId   mProxy;       ///< Hit object or INVALID_PROXY
+    float     mFraction;    ///< Position of the hit along the segment, 0 at start and 1 at end
+    float     mX;           ///< Hit point
+    float     mY;
+    float     mNormalX;     ///< Normal of the hit side, zero if the ray starts inside the rect
+    float     mNormalY;
+  };
+
+private:
+
+  /**
+  Axis aligned box with float bounds
+  */
+  struct Box
+  {
+    float mMinX;
+    float mMinY;
+    float mMaxX;
+    float mMaxY;
+  };
+
+  /**
+  Tree node. Leaves have no children and hold a proxy
+  */
+  struct Node
+  {
+    Box       mBox;         ///< Fat box for leaves, union of the children for internal nodes
+    SDL_Rect  mRect;        ///< Exact rect of a leaf
+    Uint64    mUserData;    ///< Caller data of a leaf
+    Uint32    mParent;      ///< Parent node, next free node while in the free list
+    Uint32    mChild1;      ///< NULL_NODE for leaves
+    Uint32    mChild2;
+    int       mHeight;      ///< 0 for leaves, -1 for free nodes
+
+    inline bool IsLeaf( void ) const {
+      return mChild1 == NULL_NODE;
+    }
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param margin Pixels added around every rect. Larger margins mean fewer tree updates and looser queries
+  */
+  explicit DynamicAABBTree( float margin = DEFAULT_MARGIN );
+
+  /**
+  Adds a rect
+  @param rect Rect of the object
+  @param userData Caller data returned by GetUserData
+  @return Proxy id of the object
+  */
+  ProxyId CreateProxy( const SDL_Rect &rect, Uint64 userData = 0 );
+
+  /**
+  Removes an object. The id may be reused by the next CreateProxy
+  */
+  void DestroyProxy( ProxyId proxy );
+
+  /**
+  Changes the rect of an object. The tree only changes if the rect leaves the fat box
+  @param proxy Object to move
+  @param rect New rect
+  @param displacementX Expected movement until the next call, extends the fat box in that direction
+  @param displacementY
+  @return True if the object was reinserted, false if it stayed in its fat box or the proxy is invalid
+  */
+  bool MoveProxy( ProxyId proxy, const SDL_Rect &rect, float displacementX = 0.0f, float displacementY = 0.0f );
+
+  /**
+  Removes every object
+  */
+  void Clear( void );
+
+  /**
+  Finds the objects overlapping a region, with the same result as SDL_HasIntersection on their rects
+  @param region Searched rect
+  @param results Buffer receiving the proxies
+  @param capacity Size of the buffer
+  @return Number of overlapping objects. Only the first capacity ones are written
+  */
+  Uint32 Query( const SDL_Rect &region, ProxyId *results, Uint32 capacity ) const;
+
+  /**
+  Finds the first rect crossed by a segment
+  @param ray Segment
+  @param hit Returns the closest hit, mProxy is INVALID_PROXY if nothing was hit
+  @return True if a rect was hit
+  */
+  bool RayCast( const Ray &ray, RayHit &hit ) const;
+
+  /**
+  Moves a rect along a displacement and finds the first rect it runs into. Rects only touching along the movement and
+  rects the moving one already overlaps at the start do not stop it
+  @param x Left side of the moving rect
+  @param y Top side of the moving rect
+  @param w Width of the moving rect
+  @param h Height of the moving rect
+  @param dx Displacement
+  @param dy
+  @param hit Returns the first contact: mFraction is the time of impact along the displacement, mX and mY the position
+  of the moving rect at that time and the normal points out of the hit side
+  @param ignore Proxy skipped, usually the one of the moving object
+  @return True if a rect was hit
+  */
+  bool SweepRect( float x, float y, float w, float h, float dx, float dy, RayHit &hit,
+                  ProxyId ignore = INVALID_PROXY ) const;
+
+  /**
+  Runs many queries on the JobManager and waits for them. Calling thread helps
+  @param regions count searched rects
+  @param results count vectors receiving the proxies of every region
+  @param count Number of queries
+  */
+  void QueryBatch( const SDL_Rect *regions, std::vector<ProxyId> *results, Uint32 count ) const;
+
+  /**
+  Runs many raycasts on the JobManager and waits for them
+  @param rays count segments
+  @param hits count closest hits
+  @param count Number of rays
+  */
+  void RayCastBatch( const Ray *rays, RayHit *hits, Uint32 count ) const;
+
+  /**
+  Getters
+  */
+  inline const SDL_Rect &GetRect( ProxyId proxy ) const {
+    return mNodes[proxy].mRect;
+  }
+  inline Uint64 GetUserData( ProxyId proxy ) const {
+    return mNodes[proxy].mUserData;
+  }
+  inline Uint32 GetProxyCount( void ) const {
+    return mProxyCount;
+  }
+  inline int GetHeight( void ) const {
+    return mRoot == NULL_NODE ? 0 : mNodes[mRoot].mHeight;
+  }
+
+private:
+
+  /**
+  Node pool
+  */
+  Uint32 AllocateNode( void );
+  void FreeNode( Uint32 node );
+
+  /**
+  Links a leaf into the tree or unlinks it
+  */
+  void InsertLeaf( Uint32 leaf );
+  void RemoveLeaf( Uint32 leaf );
+
+  /**
+  Refits boxes and heights from a node up to the root, rotating unbalanced nodes
+  */
+  void Refit( Uint32 node );
+
+  /**
+  Rotates a node if its children heights differ by more than one
+  @return Node now at the position of the given one
+  */
+  Uint32 Balance( Uint32 node );
+
+  /**
+  Sets the fat box of a leaf from its rect
+  */
+  void Fatten( Node &leaf, float displacementX, float displacementY ) const;
+
+  /**
+  Box helpers
+  */
+  static Box Union( const Box &a, const Box &b );
+  static float Perimeter( const Box &box );
+  static bool Contains( const Box &outer, const Box &inner );
+  static Box ToBox( const SDL_Rect &rect );
+
+  /**
+  Intersects a segment with a box
+  @return True if the segment enters the box before maxFraction. fraction and the normal are set on success
+  */
+  static bool IntersectSegment( const Box &box, const Ray &ray, float maxFraction, float &fraction, float &normalX,
+                                float &normalY );
+
+  /**
+  Time of impact of a point moving into the interior of a box. Starting inside or on the boundary moving along it is
+  not an impact
+  @return True if the point enters the box before maxFraction. fraction and the normal are set on success
+  */
+  static bool EnterBox( const Box &box, const Ray &ray, float maxFraction, float &fraction, float &normalX,
+                        float &normalY );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<Node>   mNodes;       ///< Node pool
+  Uint32              mRoot;        ///< Root node
+  Uint32              mFreeList;    ///< First free node
+  Uint32              mProxyCount;  ///< Leaves in the tree
+  float               mMargin;      ///< Fattening in pixels
+};
+
+/**********************************************************************************************************************/
+
+#endif
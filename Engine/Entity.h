@@ -0,0 +1,15 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+// Generational handles
+#include "SlotMap.h"
+
+/**********************************************************************************************************************/
+
+typedef SlotMapHandle Entity;                                     ///< Entity handle. Stale after the entity is destroyed
+
+static const Entity INVALID_ENTITY = INVALID_SLOT_MAP_HANDLE;     ///< Handle that never references an entity
+
+/**********************************************************************************************************************/
+
+#endif
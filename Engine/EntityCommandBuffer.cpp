@@ -0,0 +1,260 @@
+#include "EntityCommandBuffer.h"
+
+// Per-thread buffers
+#include "JobManager.h"
+
+// Invalid thread checks
+#include "AssertionManager.h"
+
+// Playback order
+#include <algorithm>
+
+// memcpy
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+EntityCommandBuffer::EntityCommandBuffer( void )
+  : mBuffers( JobManager::GetInstance().GetWorkerCount() + 1 )
+{
+}
+
+/**********************************************************************************************************************/
+
+EntityCommandBuffer::Source EntityCommandBuffer::SetSource( const Source &source )
+{
+  ThreadBuffer &buffer   = GetThreadBuffer();
+  const Source  previous = buffer.mSource;
+  buffer.mSource         = source;
+  return previous;
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::Destroy( Entity entity )
+{
+  Record( COMMAND_DESTROY, entity );
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::AddComponentRaw( Entity entity, ComponentTypeId type, const void *value )
+{
+  Command &command    = Record( COMMAND_ADD_COMPONENT, entity );
+  command.mComponent  = type;
+  command.mValueCount = 1;
+  WriteValue( GetThreadBuffer(), type, value );
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::RemoveComponentRaw( Entity entity, ComponentTypeId type )
+{
+  Command &command   = Record( COMMAND_REMOVE_COMPONENT, entity );
+  command.mComponent = type;
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::Playback( EntityWorld &world )
+{
+  // Entity commands sorted by handle, then source and sequence, so the order does not depend on thread scheduling
+  mOrder.clear();
+  for( Uint32 t = 0; t < mBuffers.size(); ++t ){
+    const std::vector<Command> &commands = mBuffers[t].mCommands;
+    for( Uint32 i = 0; i < commands.size(); ++i ){
+      if( commands[i].mType != COMMAND_SPAWN ){
+        const Entity &entity = commands[i].mEntity;
+        CommandRef    ref    = { ( static_cast<Uint64>( entity.mIndex ) << 32 ) | entity.mGeneration,
+                                 ( static_cast<Uint64>( commands[i].mSource ) << 32 ) | commands[i].mSequence, t, i };
+        mOrder.push_back( ref );
+      }
+    }
+  }
+  std::sort( mOrder.begin(), mOrder.end(), IsBefore );
+
+  // Destroys happen right away, other entities get their final component set
+  mChanges.clear();
+  for( Uint32 first = 0, last = 0; first < mOrder.size(); first = last ){
+    last = first + 1;
+    while( last < mOrder.size() && mOrder[last].mKey == mOrder[first].mKey ){
+      ++last;
+    }
+
+    const Entity entity = mBuffers[mOrder[first].mThread].mCommands[mOrder[first].mIndex].mEntity;
+    if( !world.IsAlive( entity ) ){
+      continue;
+    }
+
+    EntityChange change = { entity, world.GetComponentMask( entity ), 0, first, last };
+    change.mTargetMask  = change.mSourceMask;
+
+    bool destroyed = false;
+    for( Uint32 r = first; r < last && !destroyed; ++r ){
+      const Command       &command  = mBuffers[mOrder[r].mThread].mCommands[mOrder[r].mIndex];
+      const ComponentMask  bit      = static_cast<ComponentMask>( 1 ) << command.mComponent;
+      switch( command.mType ){
+      case COMMAND_DESTROY:
+        destroyed = true;
+        break;
+      case COMMAND_ADD_COMPONENT:
+        change.mTargetMask |= bit;
+        break;
+      case COMMAND_REMOVE_COMPONENT:
+        change.mTargetMask &= ~bit;
+        break;
+      }
+    }
+
+    if( destroyed ){
+      world.DestroyEntity( entity );
+    }
+    else{
+      mChanges.push_back( change );
+    }
+  }
+
+  // One archetype move per entity, grouped by source and destination archetype
+  std::stable_sort( mChanges.begin(), mChanges.end(), []( const EntityChange &a, const EntityChange &b ){
+    return a.mSourceMask != b.mSourceMask ? a.mSourceMask < b.mSourceMask : a.mTargetMask < b.mTargetMask;
+  } );
+  for( size_t c = 0; c < mChanges.size(); ++c ){
+    const EntityChange &change = mChanges[c];
+    world.SetComponentMask( change.mEntity, change.mTargetMask );
+    for( Uint32 r = change.mFirst; r < change.mLast; ++r ){
+      ApplyValues( world, change.mEntity, mOrder[r] );
+    }
+  }
+
+  // Spawns grouped by component set, so consecutive entities fill the same chunks, and in source order within a set so
+  // handles and chunk slots are the same every run
+  mOrder.clear();
+  for( Uint32 t = 0; t < mBuffers.size(); ++t ){
+    const std::vector<Command> &commands = mBuffers[t].mCommands;
+    for( Uint32 i = 0; i < commands.size(); ++i ){
+      if( commands[i].mType == COMMAND_SPAWN ){
+        CommandRef ref = { commands[i].mMask,
+                           ( static_cast<Uint64>( commands[i].mSource ) << 32 ) | commands[i].mSequence, t, i };
+        mOrder.push_back( ref );
+      }
+    }
+  }
+  std::sort( mOrder.begin(), mOrder.end(), IsBefore );
+  for( Uint32 first = 0, last = 0; first < mOrder.size(); first = last ){
+    last = first + 1;
+    while( last < mOrder.size() && mOrder[last].mKey == mOrder[first].mKey ){
+      ++last;
+    }
+
+    // One batch per set: handles and rows come out in the sorted order, then each gets its recorded values
+    mSpawned.resize( last - first );
+    world.CreateEntities( mOrder[first].mKey, last - first, &mSpawned[0] );
+    for( Uint32 s = first; s < last; ++s ){
+      ApplyValues( world, mSpawned[s - first], mOrder[s] );
+    }
+  }
+
+  Clear();
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::Clear( void )
+{
+  for( size_t t = 0; t < mBuffers.size(); ++t ){
+    mBuffers[t].mCommands.clear();
+    mBuffers[t].mData.clear();
+    mBuffers[t].mSource.mSequence = 0;
+  }
+}
+
+/**********************************************************************************************************************/
+
+size_t EntityCommandBuffer::GetCommandCount( void ) const
+{
+  size_t count = 0;
+  for( size_t t = 0; t < mBuffers.size(); ++t ){
+    count += mBuffers[t].mCommands.size();
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+EntityCommandBuffer::ThreadBuffer &EntityCommandBuffer::GetThreadBuffer( void )
+{
+  const unsigned index = JobManager::GetCurrentThreadIndex();
+  AssertMessage( index < mBuffers.size(), "Recording from a thread unknown to the command buffer" );
+  return mBuffers[index];
+}
+
+/**********************************************************************************************************************/
+
+EntityCommandBuffer::Command &EntityCommandBuffer::Record( CommandType type, Entity entity )
+{
+  ThreadBuffer &buffer = GetThreadBuffer();
+
+  Command command;
+  command.mEntity     = entity;
+  command.mMask       = 0;
+  command.mComponent  = 0;
+  command.mDataOffset = static_cast<Uint32>( buffer.mData.size() );
+  command.mValueCount = 0;
+  command.mSource     = buffer.mSource.mId;
+  command.mSequence   = buffer.mSource.mSequence++;
+  command.mType       = static_cast<Uint8>( type );
+
+  buffer.mCommands.push_back( command );
+  return buffer.mCommands.back();
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::WriteValue( ThreadBuffer &buffer, ComponentTypeId type, const void *value )
+{
+  const size_t size   = ComponentRegistry::GetInfo( type ).mSize;
+  const size_t offset = buffer.mData.size();
+
+  buffer.mData.resize( offset + sizeof(type) + size );
+  memcpy( &buffer.mData[offset], &type, sizeof(type) );
+  memcpy( &buffer.mData[offset + sizeof(type)], value, size );
+}
+
+/**********************************************************************************************************************/
+
+bool EntityCommandBuffer::IsBefore( const CommandRef &a, const CommandRef &b )
+{
+  // Thread and index only separate commands recorded outside any source
+  if( a.mKey != b.mKey ){
+    return a.mKey < b.mKey;
+  }
+  if( a.mOrder != b.mOrder ){
+    return a.mOrder < b.mOrder;
+  }
+  return a.mThread != b.mThread ? a.mThread < b.mThread : a.mIndex < b.mIndex;
+}
+
+/**********************************************************************************************************************/
+
+void EntityCommandBuffer::ApplyValues( EntityWorld &world, Entity entity, const CommandRef &ref ) const
+{
+  const ThreadBuffer  &buffer   = mBuffers[ref.mThread];
+  const Command       &command  = buffer.mCommands[ref.mIndex];
+
+  size_t offset = command.mDataOffset;
+  for( Uint32 v = 0; v < command.mValueCount; ++v ){
+    ComponentTypeId type;
+    memcpy( &type, &buffer.mData[offset], sizeof(type) );
+
+    const size_t size = ComponentRegistry::GetInfo( type ).mSize;
+    offset += sizeof(type);
+
+    // Skipped if removed later in the playback order. Overwritten through the world so the old value is released
+    if( world.GetComponentRaw( entity, type ) != NULL ){
+      world.AddComponentRaw( entity, type, &buffer.mData[offset] );
+    }
+    offset += size;
+  }
+}
+
+/**********************************************************************************************************************/
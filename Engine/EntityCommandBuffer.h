@@ -0,0 +1,254 @@
+#ifndef ENTITYCOMMANDBUFFER_H
+#define ENTITYCOMMANDBUFFER_H
+
+// Recorded changes target an entity world
+#include "EntityWorld.h"
+
+// Command storage
+#include <vector>
+
+/**
+Entity command buffer class
+Records structural changes (spawn, destroy, add and remove component) from any thread and applies them to the world
+later, at a sync point where nothing iterates it. Every thread writes only to its own buffer, selected by
+JobManager::GetCurrentThreadIndex, so recording takes no lock.
+Playback sorts the commands by entity: destroyed entities are removed first, then every other entity moves to its final
+archetype once, grouped by source and destination archetype, and spawned entities are created last with one
+EntityWorld::CreateEntities batch per component set. Commands on the same entity, and spawns with the same component
+set, apply in source order (the SystemScheduler uses the system registration index), then in the order the source
+recorded them, so the result never depends on which thread ran which system. A destroy always wins. Commands recorded
+outside any source come last, in thread index order; a source must record from the thread that set it
+*/
+class EntityCommandBuffer
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32 NO_SOURCE = 0xFFFFFFFF;   ///< Source of commands recorded outside SetSource
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Recording source of a thread: who records and how many commands it recorded so far
+  */
+  struct Source
+  {
+    Uint32  mId;          ///< Source id, lower applies first
+    Uint32  mSequence;    ///< Commands recorded by the source
+
+    explicit Source( Uint32 id = NO_SOURCE )
+      : mId(id), mSequence(0) { }
+  };
+
+private:
+
+  /**
+  Kind of recorded command
+  */
+  enum CommandType
+  {
+    COMMAND_SPAWN,
+    COMMAND_DESTROY,
+    COMMAND_ADD_COMPONENT,
+    COMMAND_REMOVE_COMPONENT
+  };
+
+  /**
+  Recorded command. Component values live in the data buffer of the recording thread
+  */
+  struct Command
+  {
+    Entity            mEntity;          ///< Target entity, INVALID_ENTITY for spawns
+    ComponentMask     mMask;            ///< Components of a spawned entity
+    ComponentTypeId   mComponent;       ///< Added or removed component type
+    Uint32            mDataOffset;      ///< First value byte in the data buffer
+    Uint32            mValueCount;      ///< Values stored for the command
+    Uint32            mSource;          ///< Source::mId of the recording source
+    Uint32            mSequence;        ///< Position in the commands of the source
+    Uint8             mType;            ///< CommandType
+  };
+
+  /**
+  Commands of one thread
+  */
+  struct ThreadBuffer
+  {
+    Uint8                 mPadBefore[64]; ///< Padding on both sides keeps buffers of different threads off the same
+                                          ///< cache line whatever the alignment std::allocator gives the vector
+    std::vector<Command>  mCommands;      ///< Commands in recording order
+    std::vector<Uint8>    mData;          ///< Component values: type id followed by the value bytes
+    Source                mSource;        ///< Source commands are recorded for
+    Uint8                 mPadAfter[64];  ///< See mPadBefore
+  };
+
+  /**
+  Playback order entry
+  */
+  struct CommandRef
+  {
+    Uint64    mKey;       ///< Sort key: entity index or spawn mask
+    Uint64    mOrder;     ///< Then source id and sequence
+    Uint32    mThread;    ///< Recording thread
+    Uint32    mIndex;     ///< Command index in the thread buffer
+  };
+
+  /**
+  Structural change of one entity during playback
+  */
+  struct EntityChange
+  {
+    Entity          mEntity;        ///< Changed entity
+    ComponentMask   mSourceMask;    ///< Components before playback
+    ComponentMask   mTargetMask;    ///< Components after playback
+    Uint32          mFirst;         ///< First command of the entity in the sorted order
+    Uint32          mLast;          ///< One past the last command
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Creates one buffer per JobManager thread, so the JobManager must exist
+  */
+  EntityCommandBuffer( void );
+
+  /**
+  Sets the source the calling thread records for, until set again. Call around the code of each source
+  @param source Source to record for, usually Source( id ) to start it
+  @return Previous source of the thread, to set back so nested sources resume where they were
+  */
+  Source SetSource( const Source &source );
+
+  /**
+  Records the creation of an entity
+  @param components Initial value of every component
+  */
+  template < class... Components >
+  void Spawn( const Components&... components );
+
+  /**
+  Records the destruction of an entity. Stale handles are ignored at playback
+  */
+  void Destroy( Entity entity );
+
+  /**
+  Records adding or overwriting a component
+  @param entity Target entity
+  @param type Component type
+  @param value Component value, copied when recorded
+  */
+  void AddComponentRaw( Entity entity, ComponentTypeId type, const void *value );
+
+  /**
+  Records removing a component
+  */
+  void RemoveComponentRaw( Entity entity, ComponentTypeId type );
+
+  /**
+  Typed versions of the component commands
+  */
+  template < class T > void AddComponent    ( Entity entity, const T &value );
+  template < class T > void RemoveComponent ( Entity entity );
+
+  /**
+  Applies every recorded command to the world and clears the buffers. Call it from one thread while no other thread
+  records or iterates the world
+  @param world World to change
+  */
+  void Playback( EntityWorld &world );
+
+  /**
+  Discards every recorded command
+  */
+  void Clear( void );
+
+  /**
+  Returns the number of recorded commands. Only exact while no thread records
+  */
+  size_t GetCommandCount( void ) const;
+
+private:
+
+  /**
+  Returns the buffer of the calling thread
+  */
+  ThreadBuffer &GetThreadBuffer( void );
+
+  /**
+  Appends a command to the buffer of the calling thread
+  @return Recorded command, valid until the next command of the same thread
+  */
+  Command &Record( CommandType type, Entity entity );
+
+  /**
+  Appends a component value to the data buffer
+  */
+  static void WriteValue( ThreadBuffer &buffer, ComponentTypeId type, const void *value );
+
+  /**
+  Returns true if a playback entry applies before another. A total order over the recorded commands
+  */
+  static bool IsBefore( const CommandRef &a, const CommandRef &b );
+
+  /**
+  Copies the values recorded by a command into the components of an entity. Types missing from the entity are skipped
+  */
+  void ApplyValues( EntityWorld &world, Entity entity, const CommandRef &ref ) const;
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<ThreadBuffer>   mBuffers;   ///< One buffer per JobManager thread index
+  std::vector<CommandRef>     mOrder;     ///< Playback scratch, kept to avoid reallocating every frame
+  std::vector<EntityChange>   mChanges;   ///< Playback scratch
+  std::vector<Entity>         mSpawned;   ///< Playback scratch, entities of one spawn batch
+};
+
+/**********************************************************************************************************************/
+// TEMPLATE METHODS
+/**********************************************************************************************************************/
+
+template < class... Components >
+void EntityCommandBuffer::Spawn( const Components&... components )
+{
+  Command &command    = Record( COMMAND_SPAWN, INVALID_ENTITY );
+  command.mMask        = EntityWorld::MaskOf<Components...>();
+  command.mValueCount  = sizeof...(Components);
+
+  ThreadBuffer &buffer = GetThreadBuffer();
+  const int expand[] = { 0, ( WriteValue( buffer, ComponentType<Components>::GetId(), &components ), 0 )... };
+  (void)expand;
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+void EntityCommandBuffer::AddComponent( Entity entity, const T &value )
+{
+  AddComponentRaw( entity, ComponentType<T>::GetId(), &value );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+void EntityCommandBuffer::RemoveComponent( Entity entity )
+{
+  RemoveComponentRaw( entity, ComponentType<T>::GetId() );
+}
+
+/**********************************************************************************************************************/
+
+#endif
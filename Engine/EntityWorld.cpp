@@ -0,0 +1,237 @@
+#include "EntityWorld.h"
+
+// Invalid entity checks
+#include "AssertionManager.h"
+
+// memcpy
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+EntityWorld::EntityWorld( void )
+{
+}
+
+/**********************************************************************************************************************/
+
+EntityWorld::~EntityWorld( void )
+{
+  for( size_t i = 0; i < mArchetypes.size(); ++i ){
+    const Archetype     &archetype  = *mArchetypes[i];
+    const ComponentMask  releases   = archetype.GetMask() & ComponentRegistry::GetReleaseMask();
+    for( ComponentTypeId type = 0; releases != 0 && type < ComponentRegistry::MAX_COMPONENT_TYPES; ++type ){
+      if( releases & ( static_cast<ComponentMask>( 1 ) << type ) ){
+        const ComponentRegistry::ReleaseFunction release = ComponentRegistry::GetInfo( type ).mRelease;
+        for( Uint32 c = 0; c < archetype.GetChunkCount(); ++c ){
+          release( archetype.GetComponentArray( c, archetype.GetComponentIndex( type ) ),
+                   archetype.GetChunk( c ).mCount );
+        }
+      }
+    }
+    delete mArchetypes[i];
+  }
+}
+
+/**********************************************************************************************************************/
+
+Entity EntityWorld::CreateEntity( ComponentMask mask )
+{
+  EntityRecord record;
+  record.mArchetype = GetOrCreateArchetype( mask );
+
+  Entity entity = mRecords.Create( record );
+
+  EntityRecord &created = *mRecords.Get( entity );
+  created.mArchetype->AddRow( entity, created.mChunk, created.mRow );
+  return entity;
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::CreateEntities( ComponentMask mask, Uint32 count, Entity *entities, const void *const *values )
+{
+  EntityRecord record;
+  record.mArchetype = GetOrCreateArchetype( mask );
+  record.mChunk     = 0;
+  record.mRow       = 0;
+
+  for( Uint32 i = 0; i < count; ++i ){
+    entities[i] = mRecords.Create( record );
+  }
+
+  Uint32 chunk;
+  Uint32 row;
+  record.mArchetype->AddRows( entities, count, values, chunk, row );
+
+  // Rows are consecutive, wrapping to the next chunk when one is full
+  const Uint32 capacity = record.mArchetype->GetChunkCapacity();
+  for( Uint32 i = 0; i < count; ++i ){
+    EntityRecord &created = *mRecords.Get( entities[i] );
+    created.mChunk        = chunk;
+    created.mRow          = row;
+    if( ++row == capacity ){
+      row = 0;
+      ++chunk;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::DestroyEntity( Entity entity )
+{
+  AssertMessage( IsAlive( entity ), "Destroying a stale entity handle" );
+  if( !IsAlive( entity ) ){
+    return;
+  }
+
+  const EntityRecord &record = *mRecords.Get( entity );
+  ReleaseComponents( record, record.mArchetype->GetMask() );
+  RemoveFromArchetype( record );
+  mRecords.Destroy( entity );
+}
+
+/**********************************************************************************************************************/
+
+bool EntityWorld::IsAlive( Entity entity ) const
+{
+  return mRecords.IsValid( entity );
+}
+
+/**********************************************************************************************************************/
+
+void *EntityWorld::GetComponentRaw( Entity entity, ComponentTypeId type ) const
+{
+  AssertMessage( IsAlive( entity ), "Accessing a stale entity handle" );
+  if( !IsAlive( entity ) ){
+    return NULL;
+  }
+
+  const EntityRecord &record = *mRecords.Get( entity );
+  if( record.mArchetype->GetComponentIndex( type ) < 0 ){
+    return NULL;
+  }
+  return record.mArchetype->GetComponent( record.mChunk, record.mRow, type );
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::AddComponentRaw( Entity entity, ComponentTypeId type, const void *value )
+{
+  AssertMessage( IsAlive( entity ), "Adding a component through a stale entity handle" );
+  if( !IsAlive( entity ) ){
+    return;
+  }
+
+  const EntityRecord &record  = *mRecords.Get( entity );
+  const ComponentMask bit     = static_cast<ComponentMask>( 1 ) << type;
+  if( ( record.mArchetype->GetMask() & bit ) == 0 ){
+    MoveEntity( entity, GetOrCreateArchetype( record.mArchetype->GetMask() | bit ) );
+  }
+  else{
+    ReleaseComponents( record, bit );
+  }
+
+  memcpy( record.mArchetype->GetComponent( record.mChunk, record.mRow, type ), value,
+          ComponentRegistry::GetInfo( type ).mSize );
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::RemoveComponentRaw( Entity entity, ComponentTypeId type )
+{
+  AssertMessage( IsAlive( entity ), "Removing a component through a stale entity handle" );
+  if( !IsAlive( entity ) ){
+    return;
+  }
+
+  const EntityRecord &record  = *mRecords.Get( entity );
+  const ComponentMask bit     = static_cast<ComponentMask>( 1 ) << type;
+  if( record.mArchetype->GetMask() & bit ){
+    MoveEntity( entity, GetOrCreateArchetype( record.mArchetype->GetMask() & ~bit ) );
+  }
+}
+
+/**********************************************************************************************************************/
+
+ComponentMask EntityWorld::GetComponentMask( Entity entity ) const
+{
+  return IsAlive( entity ) ? mRecords.Get( entity )->mArchetype->GetMask() : 0;
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::SetComponentMask( Entity entity, ComponentMask mask )
+{
+  AssertMessage( IsAlive( entity ), "Changing components through a stale entity handle" );
+  if( !IsAlive( entity ) ){
+    return;
+  }
+
+  if( mRecords.Get( entity )->mArchetype->GetMask() != mask ){
+    MoveEntity( entity, GetOrCreateArchetype( mask ) );
+  }
+}
+
+/**********************************************************************************************************************/
+
+Archetype *EntityWorld::GetOrCreateArchetype( ComponentMask mask )
+{
+  std::unordered_map<ComponentMask, Archetype*>::iterator found = mArchetypeLookup.find( mask );
+  if( found != mArchetypeLookup.end() ){
+    return found->second;
+  }
+
+  Archetype *archetype = new Archetype( mask );
+  mArchetypes.push_back( archetype );
+  mArchetypeLookup[mask] = archetype;
+  return archetype;
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::MoveEntity( Entity entity, Archetype *destination )
+{
+  const EntityRecord source = *mRecords.Get( entity );
+
+  Uint32 chunk;
+  Uint32 row;
+  destination->AddRow( entity, chunk, row );
+  destination->CopySharedComponents( *source.mArchetype, source.mChunk, source.mRow, chunk, row );
+
+  // Components the destination does not have are dropped
+  ReleaseComponents( source, source.mArchetype->GetMask() & ~destination->GetMask() );
+  RemoveFromArchetype( source );
+
+  EntityRecord &record  = *mRecords.Get( entity );
+  record.mArchetype     = destination;
+  record.mChunk         = chunk;
+  record.mRow           = row;
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::RemoveFromArchetype( const EntityRecord &record )
+{
+  Entity moved = record.mArchetype->RemoveRow( record.mChunk, record.mRow );
+  if( moved != INVALID_ENTITY ){
+    EntityRecord &movedRecord = *mRecords.Get( moved );
+    movedRecord.mChunk        = record.mChunk;
+    movedRecord.mRow          = record.mRow;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void EntityWorld::ReleaseComponents( const EntityRecord &record, ComponentMask types )
+{
+  const ComponentMask releases = types & ComponentRegistry::GetReleaseMask();
+  for( ComponentTypeId type = 0; releases != 0 && type < ComponentRegistry::MAX_COMPONENT_TYPES; ++type ){
+    if( releases & ( static_cast<ComponentMask>( 1 ) << type ) ){
+      void *component = record.mArchetype->GetComponent( record.mChunk, record.mRow, type );
+      ComponentRegistry::GetInfo( type ).mRelease( component, 1 );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
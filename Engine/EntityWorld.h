@@ -0,0 +1,327 @@
+#ifndef ENTITYWORLD_H
+#define ENTITYWORLD_H
+
+// Archetype chunk storage
+#include "Archetype.h"
+
+// Archetype lookup
+#include <unordered_map>
+#include <vector>
+
+/**
+Entity world class
+Entity-component storage. Entities with the same component set share an Archetype, and typed queries walk the chunks of
+every matching archetype linearly.
+Structural changes (create, destroy, add or remove components) invalidate component pointers and must not happen while
+a query is iterating; record them in an EntityCommandBuffer instead.
+Component values leaving the world (destroyed entity, removed or overwritten component, destroyed world) go through the
+release function of their type, see ComponentRegistry::SetReleaseFunction
+*/
+class EntityWorld
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Location of an entity
+  */
+  struct EntityRecord
+  {
+    Archetype  *mArchetype;   ///< Archetype storing the entity
+    Uint32      mChunk;       ///< Chunk index in the archetype
+    Uint32      mRow;         ///< Row index in the chunk
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  EntityWorld( void );
+
+  /**
+  Destructor. Destroys every entity, releasing their components
+  */
+  ~EntityWorld( void );
+
+  /**
+  Creates an entity with zeroed components
+  @param mask Components of the entity
+  @return New entity
+  */
+  Entity CreateEntity( ComponentMask mask = 0 );
+
+  /**
+  Creates an entity with the given component values
+  @param components Initial value of every component
+  @return New entity
+  */
+  template < class... Components >
+  Entity CreateEntity( const Components&... components );
+
+  /**
+  Creates entities sharing a component set in one batch. Components are filled with one memcpy per array and chunk
+  @param mask Components of the entities
+  @param count Number of entities
+  @param entities Returns the count new entities
+  @param values Initial component values indexed by component type id. NULL entries (or a NULL array) are zeroed
+  */
+  void CreateEntities( ComponentMask mask, Uint32 count, Entity *entities, const void *const *values = NULL );
+
+  /**
+  Destroys an entity. Every copy of its handle becomes stale
+  @param entity Entity to destroy
+  */
+  void DestroyEntity( Entity entity );
+
+  /**
+  Returns true if the entity exists. Never asserts, use it to test handles that may be stale
+  */
+  bool IsAlive( Entity entity ) const;
+
+  /**
+  Untyped component access, used by the typed versions and by systems working with runtime type ids
+  */
+  void  *GetComponentRaw    ( Entity entity, ComponentTypeId type ) const;
+  void   AddComponentRaw    ( Entity entity, ComponentTypeId type, const void *value );
+  void   RemoveComponentRaw ( Entity entity, ComponentTypeId type );
+
+  /**
+  Returns the component set of an entity
+  */
+  ComponentMask GetComponentMask( Entity entity ) const;
+
+  /**
+  Changes the component set of an entity with a single archetype move. Kept components keep their value, new ones
+  are zeroed
+  @param entity Entity to change
+  @param mask New component set
+  */
+  void SetComponentMask( Entity entity, ComponentMask mask );
+
+  /**
+  Typed component access
+  GetComponent returns NULL if the entity does not have the component. AddComponent overwrites an existing component
+  */
+  template < class T > T     *GetComponent    ( Entity entity ) const;
+  template < class T > bool   HasComponent    ( Entity entity ) const;
+  template < class T > void   AddComponent    ( Entity entity, const T &value );
+  template < class T > void   RemoveComponent ( Entity entity );
+
+  /**
+  Calls func( Components&... ) for every entity having all the components
+  */
+  template < class... Components, class Function >
+  void ForEach( Function func );
+
+  /**
+  Calls func( Entity, Components&... ) for every entity having all the components. Structural changes from inside
+  func must go through an EntityCommandBuffer
+  */
+  template < class... Components, class Function >
+  void ForEachEntity( Function func );
+
+  /**
+  Calls func( Uint32 count, Components*... ) once per chunk of every archetype having all the components.
+  Arrays hold count contiguous elements. Components may be const qualified for read-only access
+  */
+  template < class... Components, class Function >
+  void ForEachChunk( Function func );
+
+  /**
+  Returns the mask of a list of component types
+  */
+  template < class... Components >
+  static ComponentMask MaskOf( void );
+
+  /**
+  Returns the archetype for a component set, creating it if needed
+  @param mask Component set
+  @return Archetype
+  */
+  Archetype *GetOrCreateArchetype( ComponentMask mask );
+
+  /**
+  Getters
+  */
+  inline size_t GetEntityCount( void ) const {
+    return mRecords.GetSize();
+  }
+  inline size_t GetArchetypeCount( void ) const {
+    return mArchetypes.size();
+  }
+  inline Archetype &GetArchetype( size_t index ) const {
+    return *mArchetypes[index];
+  }
+
+private:
+
+  // Non copyable: owns archetypes
+  EntityWorld( const EntityWorld & );
+  EntityWorld &operator=( const EntityWorld & );
+
+  /**
+  Moves an entity to another archetype keeping the components both archetypes share
+  @param entity Entity to move
+  @param destination New archetype
+  */
+  void MoveEntity( Entity entity, Archetype *destination );
+
+  /**
+  Removes the row of an entity from its archetype and fixes the record of the row moved into the hole
+  @param record Record of the entity
+  */
+  void RemoveFromArchetype( const EntityRecord &record );
+
+  /**
+  Runs the release function of components of an entity
+  @param record Record of the entity
+  @param types Components to release. Types without release function are skipped
+  */
+  static void ReleaseComponents( const EntityRecord &record, ComponentMask types );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  SlotMap<EntityRecord>                           mRecords;         ///< Entity locations by entity handle
+  std::vector<Archetype*>                         mArchetypes;      ///< Archetypes in creation order
+  std::unordered_map<ComponentMask, Archetype*>   mArchetypeLookup; ///< Archetypes by component set
+};
+
+/**********************************************************************************************************************/
+// TEMPLATE METHODS
+/**********************************************************************************************************************/
+
+template < class... Components >
+ComponentMask EntityWorld::MaskOf( void )
+{
+  const ComponentMask masks[] = { 0, ComponentType<typename std::remove_const<Components>::type>::GetMask()... };
+
+  ComponentMask mask = 0;
+  for( size_t i = 0; i < sizeof(masks) / sizeof(masks[0]); ++i ){
+    mask |= masks[i];
+  }
+  return mask;
+}
+
+/**********************************************************************************************************************/
+
+template < class... Components >
+Entity EntityWorld::CreateEntity( const Components&... components )
+{
+  Entity entity = CreateEntity( MaskOf<Components...>() );
+
+  const EntityRecord &record = *mRecords.Get( entity );
+  const int expand[] = { 0, ( *static_cast<Components*>(
+    record.mArchetype->GetComponent( record.mChunk, record.mRow, ComponentType<Components>::GetId() ) ) = components, 0 )... };
+  (void)expand;
+
+  return entity;
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+T *EntityWorld::GetComponent( Entity entity ) const
+{
+  return static_cast<T*>( GetComponentRaw( entity, ComponentType<T>::GetId() ) );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+bool EntityWorld::HasComponent( Entity entity ) const
+{
+  return ( GetComponentMask( entity ) & ComponentType<T>::GetMask() ) != 0;
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+void EntityWorld::AddComponent( Entity entity, const T &value )
+{
+  AddComponentRaw( entity, ComponentType<T>::GetId(), &value );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+void EntityWorld::RemoveComponent( Entity entity )
+{
+  RemoveComponentRaw( entity, ComponentType<T>::GetId() );
+}
+
+/**********************************************************************************************************************/
+
+template < class... Components, class Function >
+void EntityWorld::ForEach( Function func )
+{
+  ForEachChunk<Components...>( [&func]( Uint32 count, Components*... arrays ){
+    for( Uint32 i = 0; i < count; ++i ){
+      func( arrays[i]... );
+    }
+  } );
+}
+
+/**********************************************************************************************************************/
+
+template < class... Components, class Function >
+void EntityWorld::ForEachEntity( Function func )
+{
+  const ComponentMask required = MaskOf<Components...>();
+
+  for( size_t a = 0; a < mArchetypes.size(); ++a ){
+    const Archetype &archetype = *mArchetypes[a];
+    if( ( archetype.GetMask() & required ) != required ){
+      continue;
+    }
+    for( Uint32 c = 0; c < archetype.GetChunkCount(); ++c ){
+      const Entity *entities  = archetype.GetEntities( c );
+      const Uint32  count     = archetype.GetChunk( c ).mCount;
+      auto rows = [&func, entities, count]( Components*... arrays ){
+        for( Uint32 i = 0; i < count; ++i ){
+          func( entities[i], arrays[i]... );
+        }
+      };
+      rows( archetype.GetArray<Components>( c )... );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+template < class... Components, class Function >
+void EntityWorld::ForEachChunk( Function func )
+{
+  const ComponentMask required = MaskOf<Components...>();
+
+  for( size_t a = 0; a < mArchetypes.size(); ++a ){
+    const Archetype &archetype = *mArchetypes[a];
+    if( ( archetype.GetMask() & required ) != required ){
+      continue;
+    }
+    for( Uint32 c = 0; c < archetype.GetChunkCount(); ++c ){
+      func( archetype.GetChunk( c ).mCount, archetype.GetArray<Components>( c )... );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+#endif
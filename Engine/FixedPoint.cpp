@@ -0,0 +1,114 @@
+#include "FixedPoint.h"
+
+/**********************************************************************************************************************/
+
+// Sine table over a quarter turn, both ends included. 16384 binary angle units per quarter, so 16 units per entry
+static const int    QUARTER_TABLE_BITS  = 10;
+static const int    QUARTER_TABLE_SIZE  = 1 << QUARTER_TABLE_BITS;
+static const int    INTERPOLATION_BITS  = 14 - QUARTER_TABLE_BITS;
+
+// pi / 2 with 30 fraction bits, the precision the table is generated with
+static const Sint64 HALF_PI_Q30         = 1686629713;
+static const int    Q30_BITS            = 30;
+
+/**
+Quarter wave sine table. Generated from the Taylor series in 30 bit fixed point, so it is identical on every machine
+without shipping a data file or trusting the platform sin
+*/
+struct SineTable
+{
+  Sint32 mValues[QUARTER_TABLE_SIZE + 1];
+
+  SineTable( void )
+  {
+    for( int i = 0; i <= QUARTER_TABLE_SIZE; ++i ){
+      const Sint64 x      = ( HALF_PI_Q30 * i + QUARTER_TABLE_SIZE / 2 ) / QUARTER_TABLE_SIZE;
+      const Sint64 square = ( x * x ) >> Q30_BITS;
+
+      // x - x^3/3! + x^5/5! - ... until the terms vanish. Terms stay below 2^31, so products fit in 64 bits
+      Sint64 term = x;
+      Sint64 sum  = x;
+      for( Sint64 n = 2; term != 0; n += 2 ){
+        term = -( ( term * square ) >> Q30_BITS ) / ( n * ( n + 1 ) );
+        sum += term;
+      }
+
+      // Round to 16 fraction bits
+      mValues[i] = static_cast<Sint32>( ( sum + ( 1 << ( Q30_BITS - Fixed::FRACTION_BITS - 1 ) ) ) >>
+                                        ( Q30_BITS - Fixed::FRACTION_BITS ) );
+    }
+  }
+};
+
+static const SineTable &GetSineTable( void )
+{
+  // Built on first use, thread safe
+  static const SineTable table;
+  return table;
+}
+
+/**********************************************************************************************************************/
+
+Fixed Fixed::FromFloat( float value )
+{
+  const float scaled = value * RAW_ONE;
+  return FromRaw( static_cast<Sint32>( scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f ) );
+}
+
+/**********************************************************************************************************************/
+
+Fixed Fixed::Sqrt( Fixed value )
+{
+  if( value.mRaw <= 0 ){
+    return Fixed();
+  }
+
+  // sqrt(raw / 2^16) * 2^16 = sqrt(raw * 2^16): integer square root bit by bit
+  Uint64 remainder  = static_cast<Uint64>( value.mRaw ) << FRACTION_BITS;
+  Uint64 root       = 0;
+  Uint64 bit        = static_cast<Uint64>( 1 ) << 62;
+  while( bit > remainder ){
+    bit >>= 2;
+  }
+  while( bit != 0 ){
+    if( remainder >= root + bit ){
+      remainder -= root + bit;
+      root       = ( root >> 1 ) + bit;
+    }
+    else{
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return FromRaw( static_cast<Sint32>( root ) );
+}
+
+/**********************************************************************************************************************/
+
+Fixed Fixed::Sin( Uint16 angle )
+{
+  const Sint32 *table = GetSineTable().mValues;
+
+  // The top two bits select the quarter, the rest is mirrored for the odd quarters
+  const int quarter = angle >> 14;
+  int       offset  = angle & 0x3FFF;
+  if( quarter & 1 ){
+    offset = 0x4000 - offset;
+  }
+
+  const int     index     = offset >> INTERPOLATION_BITS;
+  const int     fraction  = offset & ( ( 1 << INTERPOLATION_BITS ) - 1 );
+  const Sint32  low       = table[index];
+  const Sint32  high      = table[index < QUARTER_TABLE_SIZE ? index + 1 : index];
+  const Sint32  value     = low + ( ( high - low ) * fraction >> INTERPOLATION_BITS );
+  return FromRaw( quarter & 2 ? -value : value );
+}
+
+/**********************************************************************************************************************/
+
+Fixed Fixed::Cos( Uint16 angle )
+{
+  return Sin( static_cast<Uint16>( angle + 0x4000 ) );
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,221 @@
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+/**
+Fixed class
+16.16 signed fixed point number. Every operation is integer arithmetic with a defined rounding, so results are the same
+bit for bit on every compiler, optimization level and CPU. Products round down and quotients round toward zero. Floats
+only come in through FromFloat, which is meant for tools and data conversion, never for simulation code
+*/
+class Fixed
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const int      FRACTION_BITS = 16;                   ///< Bits after the point
+  static const Sint32   RAW_ONE       = 1 << FRACTION_BITS;   ///< Raw value of 1
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Zero
+  */
+  inline Fixed( void ) : mRaw(0) { }
+
+  /**
+  Factories
+  */
+  static inline Fixed FromRaw( Sint32 raw ){
+    Fixed value;
+    value.mRaw = raw;
+    return value;
+  }
+  static inline Fixed FromInt( int value ){
+    return FromRaw( static_cast<Sint32>( static_cast<Uint32>( value ) << FRACTION_BITS ) );
+  }
+  static Fixed FromFloat( float value );
+
+  /**
+  numerator / denominator rounded toward zero, for constants like 1 / 60 that must not go through floats
+  */
+  static inline Fixed FromRatio( int numerator, int denominator ){
+    return FromRaw( static_cast<Sint32>( static_cast<Sint64>( numerator ) * RAW_ONE / denominator ) );
+  }
+
+  /**
+  Conversions. ToInt rounds down
+  */
+  inline Sint32 GetRaw( void ) const {
+    return mRaw;
+  }
+  inline int ToInt( void ) const {
+    return mRaw >> FRACTION_BITS;
+  }
+  inline float ToFloat( void ) const {
+    return mRaw * ( 1.0f / RAW_ONE );
+  }
+
+  /**
+  Arithmetic. Overflow wraps: sums go through unsigned integers, where wrapping is defined behavior the optimizer
+  cannot exploit
+  */
+  inline Fixed operator+( Fixed other ) const {
+    return FromRaw( static_cast<Sint32>( static_cast<Uint32>( mRaw ) + static_cast<Uint32>( other.mRaw ) ) );
+  }
+  inline Fixed operator-( Fixed other ) const {
+    return FromRaw( static_cast<Sint32>( static_cast<Uint32>( mRaw ) - static_cast<Uint32>( other.mRaw ) ) );
+  }
+  inline Fixed operator-( void ) const {
+    return FromRaw( static_cast<Sint32>( 0u - static_cast<Uint32>( mRaw ) ) );
+  }
+  inline Fixed operator*( Fixed other ) const {
+    return FromRaw( static_cast<Sint32>( ( static_cast<Sint64>( mRaw ) * other.mRaw ) >> FRACTION_BITS ) );
+  }
+  inline Fixed operator/( Fixed other ) const {
+    return FromRaw( static_cast<Sint32>( static_cast<Sint64>( mRaw ) * RAW_ONE / other.mRaw ) );
+  }
+  inline Fixed &operator+=( Fixed other ){
+    return *this = *this + other;
+  }
+  inline Fixed &operator-=( Fixed other ){
+    return *this = *this - other;
+  }
+  inline Fixed &operator*=( Fixed other ){
+    return *this = *this * other;
+  }
+  inline Fixed &operator/=( Fixed other ){
+    return *this = *this / other;
+  }
+
+  /**
+  Comparisons
+  */
+  inline bool operator==( Fixed other ) const {
+    return mRaw == other.mRaw;
+  }
+  inline bool operator!=( Fixed other ) const {
+    return mRaw != other.mRaw;
+  }
+  inline bool operator<( Fixed other ) const {
+    return mRaw < other.mRaw;
+  }
+  inline bool operator<=( Fixed other ) const {
+    return mRaw <= other.mRaw;
+  }
+  inline bool operator>( Fixed other ) const {
+    return mRaw > other.mRaw;
+  }
+  inline bool operator>=( Fixed other ) const {
+    return mRaw >= other.mRaw;
+  }
+
+  /**
+  Square root, rounded down. Negative values give zero
+  */
+  static Fixed Sqrt( Fixed value );
+
+  /**
+  Sine and cosine of a binary angle: 65536 units per turn, so angles wrap for free. Values come from a quarter wave
+  table generated with integer arithmetic at startup and are linearly interpolated
+  */
+  static Fixed Sin( Uint16 angle );
+  static Fixed Cos( Uint16 angle );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  Sint32 mRaw;    ///< Value * 65536
+};
+
+/**********************************************************************************************************************/
+
+/**
+Fixed point 2D vector
+*/
+struct FixedVec2
+{
+  Fixed x;
+  Fixed y;
+
+  static inline FixedVec2 Make( Fixed x, Fixed y ){
+    FixedVec2 vector = { x, y };
+    return vector;
+  }
+
+  inline FixedVec2 operator+( const FixedVec2 &other ) const {
+    return Make( x + other.x, y + other.y );
+  }
+  inline FixedVec2 operator-( const FixedVec2 &other ) const {
+    return Make( x - other.x, y - other.y );
+  }
+  inline FixedVec2 operator*( Fixed scale ) const {
+    return Make( x * scale, y * scale );
+  }
+  inline FixedVec2 &operator+=( const FixedVec2 &other ){
+    return *this = *this + other;
+  }
+  inline FixedVec2 &operator-=( const FixedVec2 &other ){
+    return *this = *this - other;
+  }
+  inline bool operator==( const FixedVec2 &other ) const {
+    return x == other.x && y == other.y;
+  }
+  inline bool operator!=( const FixedVec2 &other ) const {
+    return !( *this == other );
+  }
+
+  inline Fixed Dot( const FixedVec2 &other ) const {
+    return x * other.x + y * other.y;
+  }
+  inline Fixed Length( void ) const {
+    return Fixed::Sqrt( Dot( *this ) );
+  }
+
+  /**
+  Unit vector pointing at a binary angle, 0 along +x and 16384 along +y
+  */
+  static inline FixedVec2 FromAngle( Uint16 angle ){
+    return Make( Fixed::Cos( angle ), Fixed::Sin( angle ) );
+  }
+};
+
+/**********************************************************************************************************************/
+
+/**
+Fixed point rect covering [x, x + w) x [y, y + h)
+*/
+struct FixedRect
+{
+  Fixed x;
+  Fixed y;
+  Fixed w;
+  Fixed h;
+
+  /**
+  Same semantics as SDL_HasIntersection: empty rects overlap nothing and touching sides do not overlap
+  */
+  inline bool Overlaps( const FixedRect &other ) const {
+    return w > Fixed() && h > Fixed() && other.w > Fixed() && other.h > Fixed() &&
+           x < other.x + other.w && other.x < x + w && y < other.y + other.h && other.y < y + h;
+  }
+  inline bool Contains( const FixedVec2 &point ) const {
+    return point.x >= x && point.x < x + w && point.y >= y && point.y < y + h;
+  }
+};
+
+/**********************************************************************************************************************/
+
+#endif
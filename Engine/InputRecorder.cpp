@@ -0,0 +1,315 @@
+#include "InputRecorder.h"
+
+// Assertions
+#include "AssertionManager.h"
+
+// memcmp, memcpy
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+// Header: magic, version, seed, tick rate, action count, tick count, checksum
+static const size_t HEADER_SIZE = 4 + 4 + 8 + 4 + 4 + 4 + 4;
+
+static void WriteLittleEndian( Uint8 *bytes, Uint64 value, int size )
+{
+  for( int i = 0; i < size; ++i ){
+    bytes[i] = static_cast<Uint8>( value >> ( 8 * i ) );
+  }
+}
+
+static Uint64 ReadLittleEndian( const Uint8 *bytes, int size )
+{
+  Uint64 value = 0;
+  for( int i = 0; i < size; ++i ){
+    value |= static_cast<Uint64>( bytes[i] ) << ( 8 * i );
+  }
+  return value;
+}
+
+static inline Uint32 ZigZag( Sint32 value )
+{
+  return ( static_cast<Uint32>( value ) << 1 ) ^ static_cast<Uint32>( value >> 31 );
+}
+
+static inline Sint32 UnZigZag( Uint32 value )
+{
+  return static_cast<Sint32>( value >> 1 ) ^ -static_cast<Sint32>( value & 1 );
+}
+
+/**********************************************************************************************************************/
+
+InputRecorder::InputRecorder( void )
+  : mSeed(0), mTickRate(0), mActionCount(0), mTickCount(0), mChecksum(0), mPendingRun(0), mReadOffset(0),
+    mRepeats(0), mPlayedTicks(0)
+{
+  memset( &mCurrent, 0, sizeof( mCurrent ) );
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::Begin( Uint64 seed, Uint32 tickRate, Uint32 actionCount )
+{
+  AssertMessage( actionCount <= ActionMap::MAX_ACTIONS, "Too many recorded actions" );
+
+  mData.clear();
+  memset( &mCurrent, 0, sizeof( mCurrent ) );
+  mSeed         = seed;
+  mTickRate     = tickRate;
+  mActionCount  = actionCount;
+  mTickCount    = 0;
+  mChecksum     = 0;
+  mPendingRun   = 0;
+  Rewind();
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::Record( const ActionMap &actions, int cursorX, int cursorY )
+{
+  // Compared with the previous tick. Before the first one that is the all zero state, also where playback starts
+  Uint8 flags = 0;
+  if( actions.GetDownMask() != mCurrent.mDown ){
+    flags |= CHANGE_DOWN;
+  }
+  if( cursorX != mCurrent.mCursorX || cursorY != mCurrent.mCursorY ){
+    flags |= CHANGE_CURSOR;
+  }
+
+  Uint64 changedValues = 0;
+  for( Uint32 i = 0; i < mActionCount; ++i ){
+    const float value = actions.GetValue( i );
+    changedValues |= static_cast<Uint64>( memcmp( &value, &mCurrent.mValues[i], sizeof( value ) ) != 0 ) << i;
+  }
+  if( changedValues != 0 ){
+    flags |= CHANGE_VALUES;
+  }
+
+  ++mTickCount;
+  if( flags == 0 ){
+    ++mPendingRun;
+    return;
+  }
+  FlushRun();
+
+  mData.push_back( flags );
+  if( flags & CHANGE_DOWN ){
+    WriteVarint( actions.GetDownMask() ^ mCurrent.mDown );
+    mCurrent.mDown = actions.GetDownMask();
+  }
+  if( flags & CHANGE_CURSOR ){
+    WriteVarint( ZigZag( cursorX - mCurrent.mCursorX ) );
+    WriteVarint( ZigZag( cursorY - mCurrent.mCursorY ) );
+    mCurrent.mCursorX = cursorX;
+    mCurrent.mCursorY = cursorY;
+  }
+  if( flags & CHANGE_VALUES ){
+    WriteVarint( changedValues );
+    for( Uint32 i = 0; i < mActionCount; ++i ){
+      if( changedValues >> i & 1 ){
+        const size_t offset = mData.size();
+        mCurrent.mValues[i] = actions.GetValue( i );
+        mData.resize( offset + sizeof( float ) );
+        memcpy( &mData[offset], &mCurrent.mValues[i], sizeof( float ) );
+      }
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::End( Uint32 checksum )
+{
+  FlushRun();
+  mChecksum = checksum;
+}
+
+/**********************************************************************************************************************/
+
+bool InputRecorder::Save( const std::string &path ) const
+{
+  AssertMessage( mPendingRun == 0, "Saving a recording that was not ended" );
+
+  Uint8 header[HEADER_SIZE];
+  WriteLittleEndian( header, FILE_MAGIC, 4 );
+  WriteLittleEndian( header + 4, FILE_VERSION, 4 );
+  WriteLittleEndian( header + 8, mSeed, 8 );
+  WriteLittleEndian( header + 16, mTickRate, 4 );
+  WriteLittleEndian( header + 20, mActionCount, 4 );
+  WriteLittleEndian( header + 24, mTickCount, 4 );
+  WriteLittleEndian( header + 28, mChecksum, 4 );
+
+  SDL_RWops *file = SDL_RWFromFile( path.c_str(), "wb" );
+  if( file == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to write input recording %s: %s", path.c_str(),
+                  SDL_GetError() );
+    return false;
+  }
+  bool written = SDL_RWwrite( file, header, HEADER_SIZE, 1 ) == 1 &&
+                 ( mData.empty() || SDL_RWwrite( file, &mData[0], mData.size(), 1 ) == 1 );
+  written = SDL_RWclose( file ) == 0 && written;
+  return written;
+}
+
+/**********************************************************************************************************************/
+
+bool InputRecorder::Load( const std::string &path )
+{
+  SDL_RWops *file = SDL_RWFromFile( path.c_str(), "rb" );
+  if( file == NULL ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Unable to read input recording %s: %s", path.c_str(),
+                  SDL_GetError() );
+    return false;
+  }
+
+  const Sint64 size = SDL_RWsize( file );
+  Uint8 header[HEADER_SIZE];
+  bool  valid = size >= static_cast<Sint64>( HEADER_SIZE ) && SDL_RWread( file, header, HEADER_SIZE, 1 ) == 1 &&
+                ReadLittleEndian( header, 4 ) == FILE_MAGIC && ReadLittleEndian( header + 4, 4 ) == FILE_VERSION &&
+                ReadLittleEndian( header + 20, 4 ) <= ActionMap::MAX_ACTIONS;
+  if( valid ){
+    mData.resize( static_cast<size_t>( size ) - HEADER_SIZE );
+    valid = mData.empty() || SDL_RWread( file, &mData[0], mData.size(), 1 ) == 1;
+  }
+  SDL_RWclose( file );
+
+  if( !valid ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Invalid input recording %s", path.c_str() );
+    mData.clear();
+    mTickCount = 0;
+    Rewind();
+    return false;
+  }
+
+  mSeed         = ReadLittleEndian( header + 8, 8 );
+  mTickRate     = static_cast<Uint32>( ReadLittleEndian( header + 16, 4 ) );
+  mActionCount  = static_cast<Uint32>( ReadLittleEndian( header + 20, 4 ) );
+  mTickCount    = static_cast<Uint32>( ReadLittleEndian( header + 24, 4 ) );
+  mChecksum     = static_cast<Uint32>( ReadLittleEndian( header + 28, 4 ) );
+  mPendingRun   = 0;
+  Rewind();
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::Rewind( void )
+{
+  memset( &mCurrent, 0, sizeof( mCurrent ) );
+  mReadOffset   = 0;
+  mRepeats      = 0;
+  mPlayedTicks  = 0;
+}
+
+/**********************************************************************************************************************/
+
+bool InputRecorder::Play( ActionMap &actions, int &cursorX, int &cursorY )
+{
+  if( mPlayedTicks >= mTickCount ){
+    return false;
+  }
+
+  if( mRepeats > 0 ){
+    --mRepeats;
+  }
+  else if( !ReadRecord() ){
+    SDL_LogError( SDL_LOG_CATEGORY_APPLICATION, "Input recording ends at tick %u of %u", mPlayedTicks, mTickCount );
+    mPlayedTicks = mTickCount;
+    return false;
+  }
+
+  ++mPlayedTicks;
+  actions.Apply( mCurrent.mDown, mCurrent.mValues, mActionCount );
+  cursorX = mCurrent.mCursorX;
+  cursorY = mCurrent.mCursorY;
+  return true;
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::FlushRun( void )
+{
+  if( mPendingRun > 0 ){
+    mData.push_back( 0 );
+    WriteVarint( mPendingRun );
+    mPendingRun = 0;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void InputRecorder::WriteVarint( Uint64 value )
+{
+  while( value >= 0x80 ){
+    mData.push_back( static_cast<Uint8>( value | 0x80 ) );
+    value >>= 7;
+  }
+  mData.push_back( static_cast<Uint8>( value ) );
+}
+
+/**********************************************************************************************************************/
+
+bool InputRecorder::ReadVarint( Uint64 &value )
+{
+  value = 0;
+  for( int shift = 0; shift < 64 && mReadOffset < mData.size(); shift += 7 ){
+    const Uint8 byte = mData[mReadOffset++];
+    value |= static_cast<Uint64>( byte & 0x7F ) << shift;
+    if( ( byte & 0x80 ) == 0 ){
+      return true;
+    }
+  }
+  return false;
+}
+
+/**********************************************************************************************************************/
+
+bool InputRecorder::ReadRecord( void )
+{
+  if( mReadOffset >= mData.size() ){
+    return false;
+  }
+
+  const Uint8 flags = mData[mReadOffset++];
+  Uint64      value;
+  if( flags == 0 ){
+    // The tick being played is the first of the run
+    if( !ReadVarint( value ) || value == 0 ){
+      return false;
+    }
+    mRepeats = static_cast<Uint32>( value - 1 );
+    return true;
+  }
+
+  if( flags & CHANGE_DOWN ){
+    if( !ReadVarint( value ) ){
+      return false;
+    }
+    mCurrent.mDown ^= value;
+  }
+  if( flags & CHANGE_CURSOR ){
+    Uint64 deltaY;
+    if( !ReadVarint( value ) || !ReadVarint( deltaY ) ){
+      return false;
+    }
+    mCurrent.mCursorX += UnZigZag( static_cast<Uint32>( value ) );
+    mCurrent.mCursorY += UnZigZag( static_cast<Uint32>( deltaY ) );
+  }
+  if( flags & CHANGE_VALUES ){
+    if( !ReadVarint( value ) ){
+      return false;
+    }
+    for( Uint32 i = 0; i < mActionCount; ++i ){
+      if( value >> i & 1 ){
+        if( mReadOffset + sizeof( float ) > mData.size() ){
+          return false;
+        }
+        memcpy( &mCurrent.mValues[i], &mData[mReadOffset], sizeof( float ) );
+        mReadOffset += sizeof( float );
+      }
+    }
+  }
+  return true;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,170 @@
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+// Recorded input state
+#include "ActionMap.h"
+
+// Recording storage
+#include <string>
+#include <vector>
+
+/**
+Input recorder class
+Records the input seen by every simulation tick and plays it back, so a session played once can be replayed without a
+window or a player, for profiling and regression runs. A tick is the action state, the action values and the cursor.
+Ticks equal to the previous one only extend a run, and a changed tick stores the changed fields only:
+  run:    0x00, varint extra repeats of the previous tick
+  change: field flags, then the XOR of the action mask, zigzag cursor deltas and the changed values as needed
+Holding a key for a second is a couple of bytes. The file also keeps the seed, the tick rate and the checksum of the
+last tick, so a replay can check it reached the same state
+*/
+class InputRecorder
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   FILE_MAGIC      = 0x52504E49;   ///< "INPR" little endian
+  static const Uint32   FILE_VERSION    = 2;            ///< 2: values quantized to fixed point by ActionMap
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Change record flags
+  */
+  enum ChangeFlags
+  {
+    CHANGE_DOWN   = 0x01,   ///< Action mask changed
+    CHANGE_CURSOR = 0x02,   ///< Cursor moved
+    CHANGE_VALUES = 0x04    ///< Action values changed
+  };
+
+  /**
+  Input of one tick
+  */
+  struct Snapshot
+  {
+    Uint64  mDown;                                ///< ActionMap::GetDownMask
+    Sint32  mCursorX;
+    Sint32  mCursorY;
+    float   mValues[ActionMap::MAX_ACTIONS];      ///< ActionMap::GetValue, first mActionCount used
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  InputRecorder( void );
+
+  /**
+  Starts a new recording, dropping the previous one
+  @param seed Seed of the recorded simulation
+  @param tickRate Ticks per second of the recorded simulation
+  @param actionCount Actions recorded per tick
+  */
+  void Begin( Uint64 seed, Uint32 tickRate, Uint32 actionCount );
+
+  /**
+  Records the input of one tick
+  @param actions Action state after its Update
+  @param cursorX Cursor position
+  @param cursorY
+  */
+  void Record( const ActionMap &actions, int cursorX, int cursorY );
+
+  /**
+  Ends the recording
+  @param checksum Checksum of the last recorded tick
+  */
+  void End( Uint32 checksum );
+
+  /**
+  File access. Save writes an ended recording
+  @return False if the file could not be written, or read and validated
+  */
+  bool Save( const std::string &path ) const;
+  bool Load( const std::string &path );
+
+  /**
+  Restarts playback from the first tick
+  */
+  void Rewind( void );
+
+  /**
+  Plays back the next tick
+  @param actions Receives the recorded action state, see ActionMap::Apply
+  @param cursorX Receives the cursor position
+  @param cursorY
+  @return False once every tick has been played
+  */
+  bool Play( ActionMap &actions, int &cursorX, int &cursorY );
+
+  /**
+  Getters
+  */
+  inline Uint64 GetSeed( void ) const {
+    return mSeed;
+  }
+  inline Uint32 GetTickRate( void ) const {
+    return mTickRate;
+  }
+  inline Uint32 GetTickCount( void ) const {
+    return mTickCount;
+  }
+  inline Uint32 GetChecksum( void ) const {
+    return mChecksum;
+  }
+  inline size_t GetDataSize( void ) const {
+    return mData.size();
+  }
+
+private:
+
+  /**
+  Writes the pending run of repeated ticks
+  */
+  void FlushRun( void );
+
+  /**
+  Variable length encoding, 7 bits per byte
+  */
+  void WriteVarint( Uint64 value );
+  bool ReadVarint( Uint64 &value );
+
+  /**
+  Decodes the next record into mCurrent
+  @return False at the end of the data or on malformed data
+  */
+  bool ReadRecord( void );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<Uint8>  mData;            ///< Encoded ticks
+  Snapshot            mCurrent;         ///< Last recorded or played tick
+  Uint64              mSeed;            ///< Simulation seed
+  Uint32              mTickRate;        ///< Simulation ticks per second
+  Uint32              mActionCount;     ///< Values per tick
+  Uint32              mTickCount;       ///< Recorded ticks
+  Uint32              mChecksum;        ///< Checksum of the last tick
+  Uint32              mPendingRun;      ///< Recorded repeats of mCurrent not written yet
+  size_t              mReadOffset;      ///< Playback position in mData
+  Uint32              mRepeats;         ///< Playback repeats of mCurrent left
+  Uint32              mPlayedTicks;     ///< Ticks played since Rewind
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,130 @@
+#include "JobManager.h"
+
+/**********************************************************************************************************************/
+
+// Index of the thread running the code. Main thread keeps the default value
+static thread_local unsigned sThreadIndex = JobManager::MAIN_THREAD_INDEX;
+
+/**********************************************************************************************************************/
+
+JobManager::JobManager( void )
+  : mUnfinishedJobs(0), mQuit(false)
+{
+  // Leave one hardware thread to the main thread
+  unsigned hardwareThreads = std::thread::hardware_concurrency();
+  unsigned workerCount     = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+
+  mWorkers.reserve( workerCount );
+  for( unsigned i = 0; i < workerCount; ++i ){
+    mWorkers.push_back( std::thread( &JobManager::WorkerLoop, this, i + 1 ) );
+  }
+}
+
+/**********************************************************************************************************************/
+
+JobManager::~JobManager( void )
+{
+  // Let workers drain the queue before quitting
+  WaitForAll();
+
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    mQuit = true;
+  }
+  mJobAdded.notify_all();
+
+  for( size_t i = 0; i < mWorkers.size(); ++i ){
+    mWorkers[i].join();
+  }
+}
+
+/**********************************************************************************************************************/
+
+void JobManager::AddJob( const Job &job, JobCounter *counter )
+{
+  {
+    std::lock_guard<std::mutex> lock( mMutex );
+    QueuedJob queued;
+    queued.mJob     = job;
+    queued.mCounter = counter;
+    mJobs.push_back( queued );
+    ++mUnfinishedJobs;
+    if( counter ){
+      ++counter->mPending;
+    }
+  }
+  mJobAdded.notify_one();
+}
+
+/**********************************************************************************************************************/
+
+void JobManager::WaitForAll( void )
+{
+  std::unique_lock<std::mutex> lock( mMutex );
+  while( mUnfinishedJobs > 0 ){
+    // Help with pending jobs instead of sleeping. If none is queued others are still running: wait for them
+    if( !ExecuteOneJob( lock ) ){
+      mJobFinished.wait( lock );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void JobManager::Wait( const JobCounter &counter )
+{
+  std::unique_lock<std::mutex> lock( mMutex );
+  while( !counter.IsDone() ){
+    if( !ExecuteOneJob( lock ) ){
+      mJobFinished.wait( lock );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+unsigned JobManager::GetCurrentThreadIndex( void )
+{
+  return sThreadIndex;
+}
+
+/**********************************************************************************************************************/
+
+void JobManager::WorkerLoop( unsigned threadIndex )
+{
+  sThreadIndex = threadIndex;
+
+  std::unique_lock<std::mutex> lock( mMutex );
+  while( !mQuit ){
+    if( !ExecuteOneJob( lock ) ){
+      mJobAdded.wait( lock );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+bool JobManager::ExecuteOneJob( std::unique_lock<std::mutex> &lock )
+{
+  if( mJobs.empty() ){
+    return false;
+  }
+
+  QueuedJob queued = mJobs.front();
+  mJobs.pop_front();
+
+  // Run job without holding the lock
+  lock.unlock();
+  queued.mJob();
+  lock.lock();
+
+  // Counters change under the lock so waiters cannot miss the notification
+  if( queued.mCounter ){
+    --queued.mCounter->mPending;
+  }
+  --mUnfinishedJobs;
+  mJobFinished.notify_all();
+  return true;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,161 @@
+#ifndef JOBMANAGER_H
+#define JOBMANAGER_H
+
+#include "Singleton.h"
+
+// Job storage
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Worker threads
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+Job manager class
+Owns a pool of worker threads and runs jobs pushed from any thread on them
+*/
+class JobManager : public Singleton <JobManager>
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  // Allow constructor calling only from Singleton
+  friend class Singleton <JobManager>;
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const unsigned MAIN_THREAD_INDEX = 0;  ///< Thread index of the thread that created the manager
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  typedef std::function<void( void )> Job;
+
+  /**
+  Counts unfinished jobs of a group so a caller can wait for that group only
+  */
+  class JobCounter
+  {
+    friend class JobManager;
+
+  public:
+    JobCounter( void )
+      : mPending(0) { }
+
+    /**
+    Returns true when every job added with this counter has finished
+    */
+    inline bool IsDone( void ) const {
+      return mPending.load() == 0;
+    }
+
+  private:
+    // Non copyable: jobs keep a pointer to it
+    JobCounter( const JobCounter & );
+    JobCounter &operator=( const JobCounter & );
+
+    std::atomic<unsigned> mPending;   ///< Jobs added and not finished yet
+  };
+
+private:
+
+  /**
+  Queued job
+  */
+  struct QueuedJob
+  {
+    Job         mJob;       ///< Job to execute
+    JobCounter *mCounter;   ///< Counter decremented when the job finishes, may be NULL
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Queues a job to be executed by the first free worker
+  @param job Job to execute. It must not throw
+  @param counter Optional counter tracking the job. Jobs may add more jobs to their own counter before finishing
+  */
+  void AddJob( const Job &job, JobCounter *counter = NULL );
+
+  /**
+  Blocks until every queued job has finished. The calling thread helps executing pending jobs while waiting
+  */
+  void WaitForAll( void );
+
+  /**
+  Blocks until every job of a counter has finished. The calling thread helps executing pending jobs while waiting
+  @param counter Counter to wait for
+  */
+  void Wait( const JobCounter &counter );
+
+  /**
+  Returns the number of worker threads (main thread not included)
+  @return Number of worker threads
+  */
+  inline unsigned GetWorkerCount( void ) const {
+    return static_cast<unsigned>( mWorkers.size() );
+  }
+
+  /**
+  Returns the index of the calling thread: MAIN_THREAD_INDEX for the main thread, 1..GetWorkerCount() for workers
+  Useful to index per-thread buffers without locking
+  @return Calling thread index
+  */
+  static unsigned GetCurrentThreadIndex( void );
+
+private:
+
+  // Constructor and destructor private for singleton (only one instance can be created)
+  /**
+  Private constructor for JobManager singleton. Spawns the worker threads
+  */
+  JobManager( void );
+
+  /**
+  Private destructor for JobManager singleton. Finishes pending jobs and joins the worker threads
+  */
+  /*virtual*/ ~JobManager( void ); // Avoid virtual if not strictly necessary (Singletons don't use inheritance)
+
+  /**
+  Worker thread main loop
+  @param threadIndex Index of the worker thread
+  */
+  void WorkerLoop( unsigned threadIndex );
+
+  /**
+  Pops and executes one job if available
+  @param lock Lock held over mMutex. It is released while the job runs
+  @return True if a job was executed
+  */
+  bool ExecuteOneJob( std::unique_lock<std::mutex> &lock );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<std::thread>  mWorkers;         ///< Worker threads
+  std::deque<QueuedJob>     mJobs;            ///< Jobs waiting for a worker
+  std::mutex                mMutex;           ///< Protects the job queue and counters
+  std::condition_variable   mJobAdded;        ///< Signaled when a job is queued or the manager quits
+  std::condition_variable   mJobFinished;     ///< Signaled every time a job finishes
+  unsigned                  mUnfinishedJobs;  ///< Jobs queued or running
+  bool                      mQuit;            ///< Workers must exit
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,27 @@
+#include "LateLatch.h"
+
+/**********************************************************************************************************************/
+
+LateLatch::LateLatch( void )
+  : mKeyboard(NULL), mKeyCount(0), mMouseButtons(0), mCursorX(0), mCursorY(0), mSampleTime(0), mEnabled(false)
+{
+}
+
+/**********************************************************************************************************************/
+
+bool LateLatch::Sample( void )
+{
+  if( !mEnabled ){
+    return false;
+  }
+
+  // Moves the OS messages that arrived during the frame into SDL, without dequeuing any SDL event
+  SDL_PumpEvents();
+
+  mKeyboard     = SDL_GetKeyboardState( &mKeyCount );
+  mMouseButtons = SDL_GetMouseState( &mCursorX, &mCursorY );
+  mSampleTime   = SDL_GetPerformanceCounter();
+  return true;
+}
+
+/**********************************************************************************************************************/
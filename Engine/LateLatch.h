@@ -0,0 +1,88 @@
+#ifndef LATELATCH_H
+#define LATELATCH_H
+
+// Event pump and device state
+#include <SDL.h>
+
+/**
+Late latch class
+Samples the keyboard and mouse again right before rendering, for state that is only drawn and must feel immediate,
+such as a cursor or a camera. Input seen by the simulation is still taken at the start of the frame: SDL_PumpEvents
+only refreshes the device state SDL keeps, the events stay queued for the next poll, so the simulation and any
+recording of it see exactly what they would without the latch. Disabled by default, Sample then does nothing
+*/
+class LateLatch
+{
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  LateLatch( void );
+
+  /**
+  Pumps pending OS events and samples the keyboard and mouse state
+  @return False if the latch is disabled, the sampled state is then unchanged
+  */
+  bool Sample( void );
+
+  /**
+  Returns true if a key was down at the last sample
+  */
+  inline bool IsKeyDown( SDL_Scancode scancode ) const {
+    return mKeyboard != NULL && scancode >= 0 && scancode < mKeyCount && mKeyboard[scancode] != 0;
+  }
+
+  /**
+  Returns true if a mouse button was down at the last sample
+  @param button SDL_BUTTON_LEFT...
+  */
+  inline bool IsMouseButtonDown( Uint8 button ) const {
+    return ( mMouseButtons & SDL_BUTTON( button ) ) != 0;
+  }
+
+  /**
+  Getters. GetSampleTime is the performance counter at the last sample
+  */
+  inline bool IsEnabled( void ) const {
+    return mEnabled;
+  }
+  inline int GetCursorX( void ) const {
+    return mCursorX;
+  }
+  inline int GetCursorY( void ) const {
+    return mCursorY;
+  }
+  inline Uint64 GetSampleTime( void ) const {
+    return mSampleTime;
+  }
+
+  /**
+  Setters
+  */
+  inline void SetEnabled( bool enabled ){
+    mEnabled = enabled;
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  const Uint8  *mKeyboard;        ///< SDL keyboard state, indexed by scancode
+  int           mKeyCount;        ///< Entries in mKeyboard
+  Uint32        mMouseButtons;    ///< SDL_BUTTON mask
+  int           mCursorX;         ///< Cursor position in the window
+  int           mCursorY;
+  Uint64        mSampleTime;      ///< Performance counter at the last sample
+  bool          mEnabled;         ///< Sample does nothing when false
+};
+
+/**********************************************************************************************************************/
+
+#endif
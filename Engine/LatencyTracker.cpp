@@ -0,0 +1,148 @@
+#include "LatencyTracker.h"
+
+// memset
+#include <cstring>
+
+// snprintf
+#include <cstdio>
+
+/**********************************************************************************************************************/
+
+LatencyTracker::Histogram::Histogram( void )
+{
+  Reset();
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::Histogram::Add( double milliseconds )
+{
+  const double bucket = milliseconds * BUCKETS_PER_MILLISECOND;
+  const Uint32 index  = bucket <= 0.0 ? 0 :
+                        bucket >= BUCKET_COUNT - 1 ? BUCKET_COUNT - 1 : static_cast<Uint32>( bucket );
+  ++mBuckets[index];
+  ++mCount;
+  mTotal += milliseconds;
+  mMax    = milliseconds > mMax ? milliseconds : mMax;
+}
+
+/**********************************************************************************************************************/
+
+double LatencyTracker::Histogram::GetPercentile( double fraction ) const
+{
+  if( mCount == 0 ){
+    return 0.0;
+  }
+
+  // Upper edge of the bucket holding the sample, capped by the longest sample for the overflow bucket
+  const Uint32 rank  = static_cast<Uint32>( fraction * ( mCount - 1 ) ) + 1;
+  Uint32       seen  = 0;
+  for( Uint32 i = 0; i < BUCKET_COUNT; ++i ){
+    seen += mBuckets[i];
+    if( seen >= rank ){
+      const double edge = static_cast<double>( i + 1 ) / BUCKETS_PER_MILLISECOND;
+      return edge < mMax ? edge : mMax;
+    }
+  }
+  return mMax;
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::Histogram::Reset( void )
+{
+  memset( mBuckets, 0, sizeof( mBuckets ) );
+  mCount  = 0;
+  mTotal  = 0.0;
+  mMax    = 0.0;
+}
+
+/**********************************************************************************************************************/
+
+LatencyTracker::LatencyTracker( void )
+  : mFrequency(SDL_GetPerformanceFrequency()), mLastPresent(0)
+{
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::OnInput( Uint32 timestamp )
+{
+  // The event timestamp is in milliseconds of SDL_GetTicks. Its age moves it to the performance counter
+  const Uint64 now      = SDL_GetPerformanceCounter();
+  const Uint32 age      = SDL_GetTicks() - timestamp;
+  const Uint64 ageTicks = static_cast<Uint64>( age ) * mFrequency / 1000;
+
+  PendingInput input;
+  input.mQueued   = ageTicks < now ? now - ageTicks : 0;
+  input.mHandled  = now;
+  input.mConsumed = 0;
+  mHandled.push_back( input );
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::OnUpdate( void )
+{
+  const Uint64 now = SDL_GetPerformanceCounter();
+  for( size_t i = 0; i < mHandled.size(); ++i ){
+    mHandled[i].mConsumed = now;
+    mConsumed.push_back( mHandled[i] );
+  }
+  mHandled.clear();
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::OnPresent( void )
+{
+  const Uint64 now = SDL_GetPerformanceCounter();
+  for( size_t i = 0; i < mConsumed.size(); ++i ){
+    const PendingInput &input = mConsumed[i];
+    mLatencies.Add( ToMilliseconds( now - input.mQueued ) );
+    mQueueTimes.Add( ToMilliseconds( input.mHandled - input.mQueued ) );
+    mWaitTimes.Add( ToMilliseconds( input.mConsumed - input.mHandled ) );
+    mRenderTimes.Add( ToMilliseconds( now - input.mConsumed ) );
+  }
+  mConsumed.clear();
+
+  if( mLastPresent != 0 ){
+    mFrameTimes.Add( ToMilliseconds( now - mLastPresent ) );
+  }
+  mLastPresent = now;
+}
+
+/**********************************************************************************************************************/
+
+std::string LatencyTracker::GetReport( void ) const
+{
+  std::string report;
+  char        line[256];
+
+  snprintf( line, sizeof(line), "Frame time    %6u frames  p50 %6.1f  p90 %6.1f  p99 %6.1f  max %6.1f ms\n",
+            mFrameTimes.GetCount(), mFrameTimes.GetPercentile( 0.5 ), mFrameTimes.GetPercentile( 0.9 ),
+            mFrameTimes.GetPercentile( 0.99 ), mFrameTimes.GetMax() );
+  report += line;
+  snprintf( line, sizeof(line), "Input latency %6u inputs  p50 %6.1f  p90 %6.1f  p99 %6.1f  max %6.1f ms\n",
+            mLatencies.GetCount(), mLatencies.GetPercentile( 0.5 ), mLatencies.GetPercentile( 0.9 ),
+            mLatencies.GetPercentile( 0.99 ), mLatencies.GetMax() );
+  report += line;
+  snprintf( line, sizeof(line), "  mean queue %.1f ms, wait for update %.1f ms, update to present %.1f ms\n",
+            mQueueTimes.GetMean(), mWaitTimes.GetMean(), mRenderTimes.GetMean() );
+  report += line;
+
+  return report;
+}
+
+/**********************************************************************************************************************/
+
+void LatencyTracker::ResetStats( void )
+{
+  mFrameTimes.Reset();
+  mLatencies.Reset();
+  mQueueTimes.Reset();
+  mWaitTimes.Reset();
+  mRenderTimes.Reset();
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,171 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+// Performance counter, fixed size types
+#include <SDL.h>
+
+// Inputs in flight and report
+#include <string>
+#include <vector>
+
+/**
+Latency tracker class
+Follows input events from the moment SDL queued them to the SDL_RenderPresent that shows their effect, and measures
+frame times at the same point. Every input goes through three stages:
+  queue:  SDL timestamp to handling, time spent waiting in the event queue
+  wait:   handling to the start of the Update that consumes it
+  render: start of that Update to the end of the present that follows
+Latencies and frame times are kept as histograms with 0.1 ms buckets, so percentiles cost no sorting and recording never
+allocates once the in-flight arrays have grown
+*/
+class LatencyTracker
+{
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32   BUCKETS_PER_MILLISECOND   = 10;
+  static const Uint32   BUCKET_COUNT              = 2000;   ///< 200 ms, longer samples go to the last bucket
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Distribution of durations
+  */
+  class Histogram
+  {
+  public:
+
+    /**
+    Constructor
+    */
+    Histogram( void );
+
+    /**
+    Adds a sample
+    @param milliseconds Duration
+    */
+    void Add( double milliseconds );
+
+    /**
+    Returns the duration below which a fraction of the samples are, to the bucket size. 0 without samples
+    @param fraction 0.5 for the median
+    */
+    double GetPercentile( double fraction ) const;
+
+    /**
+    Removes every sample
+    */
+    void Reset( void );
+
+    /**
+    Getters
+    */
+    inline Uint32 GetCount( void ) const {
+      return mCount;
+    }
+    inline double GetMean( void ) const {
+      return mCount > 0 ? mTotal / mCount : 0.0;
+    }
+    inline double GetMax( void ) const {
+      return mMax;
+    }
+
+  private:
+
+    Uint32  mBuckets[BUCKET_COUNT];   ///< Samples per 0.1 ms
+    Uint32  mCount;                   ///< Samples
+    double  mTotal;                   ///< Sum of the samples
+    double  mMax;                     ///< Longest sample
+  };
+
+private:
+
+  /**
+  Input between two stages. Times are performance counter values
+  */
+  struct PendingInput
+  {
+    Uint64  mQueued;    ///< When SDL queued the event
+    Uint64  mHandled;   ///< When the game handled it
+    Uint64  mConsumed;  ///< Start of the Update that read it
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  LatencyTracker( void );
+
+  /**
+  Call when an input event that can change the simulation is handled
+  @param timestamp SDL timestamp of the event, in SDL_GetTicks milliseconds
+  */
+  void OnInput( Uint32 timestamp );
+
+  /**
+  Call at the start of an Update: the inputs handled until now are consumed by it
+  */
+  void OnUpdate( void );
+
+  /**
+  Call right after SDL_RenderPresent: consumed inputs are now visible and a frame ended
+  */
+  void OnPresent( void );
+
+  /**
+  Returns a readable summary of frame times and input latencies
+  */
+  std::string GetReport( void ) const;
+
+  /**
+  Removes every sample. Inputs in flight are kept
+  */
+  void ResetStats( void );
+
+  /**
+  Getters
+  */
+  inline const Histogram &GetFrameTimes( void ) const {
+    return mFrameTimes;
+  }
+  inline const Histogram &GetLatencies( void ) const {
+    return mLatencies;
+  }
+
+private:
+
+  /**
+  Converts a performance counter interval to milliseconds
+  */
+  inline double ToMilliseconds( Uint64 ticks ) const {
+    return ticks * 1000.0 / mFrequency;
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<PendingInput> mHandled;         ///< Handled, waiting for an Update
+  std::vector<PendingInput> mConsumed;        ///< Consumed, waiting for a present
+  Histogram                 mFrameTimes;      ///< Present to present
+  Histogram                 mLatencies;       ///< Queued to present
+  Histogram                 mQueueTimes;      ///< Queued to handled
+  Histogram                 mWaitTimes;       ///< Handled to consumed
+  Histogram                 mRenderTimes;     ///< Consumed to present
+  Uint64                    mFrequency;       ///< Performance counter ticks per second
+  Uint64                    mLastPresent;     ///< Time of the previous present, 0 before the first
+};
+
+/**********************************************************************************************************************/
+
+#endif
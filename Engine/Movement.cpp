@@ -0,0 +1,113 @@
+#include "Movement.h"
+
+// SSE2 is always available on x64 and is the Visual Studio default on x86
+#if defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) || defined(__SSE2__)
+  #define MOVEMENT_USE_SSE2
+  #include <emmintrin.h>
+#endif
+
+// Damping factor
+#include <cmath>
+
+/**********************************************************************************************************************/
+
+/**
+Velocity scale of one step. Shared by every path so SIMD and scalar results match
+*/
+static inline float DampingFactor( float coefficient, float deltaTime )
+{
+  return std::exp( -coefficient * deltaTime );
+}
+
+/**********************************************************************************************************************/
+
+void Movement::Integrate( Position *positions, Velocity *velocities, const Acceleration *accelerations,
+                          const Damping *damping, Uint32 count, float deltaTime )
+{
+  Uint32 first = 0;
+
+#ifdef MOVEMENT_USE_SSE2
+  if( count == 0 ){
+    return;
+  }
+
+  // Components are plain float pairs: view the arrays as interleaved x,y floats
+  float       *position     = reinterpret_cast<float*>( positions );
+  float       *velocity     = reinterpret_cast<float*>( velocities );
+  const float *acceleration = reinterpret_cast<const float*>( accelerations );
+  const float *coefficient  = reinterpret_cast<const float*>( damping );
+
+  const __m128 dt = _mm_set1_ps( deltaTime );
+
+  // Entities of a chunk usually share their damping: exp is only computed again when four coefficients differ from the
+  // last one seen, checked with one compare instead of a pass over the array
+  __m128 lastCoefficient  = _mm_set1_ps( coefficient[0] );
+  __m128 lastFactor       = _mm_set1_ps( DampingFactor( coefficient[0], deltaTime ) );
+
+  // Four entities per iteration: two registers of x,y pairs per array
+  const Uint32 simdCount = count & ~3u;
+  for( Uint32 i = 0; i < simdCount; i += 4 ){
+    // Damping of entities i..i+3, then duplicated for x and y lanes
+    __m128 factor = lastFactor;
+    if( _mm_movemask_ps( _mm_cmpeq_ps( _mm_loadu_ps( coefficient + i ), lastCoefficient ) ) != 0xF ){
+      const float last = DampingFactor( coefficient[i + 3], deltaTime );
+      factor           = _mm_setr_ps( DampingFactor( coefficient[i], deltaTime ),
+                                      DampingFactor( coefficient[i + 1], deltaTime ),
+                                      DampingFactor( coefficient[i + 2], deltaTime ), last );
+      lastCoefficient  = _mm_set1_ps( coefficient[i + 3] );
+      lastFactor       = _mm_set1_ps( last );
+    }
+    const __m128 factorLo = _mm_unpacklo_ps( factor, factor );
+    const __m128 factorHi = _mm_unpackhi_ps( factor, factor );
+
+    const Uint32 lane = i * 2;
+    __m128 velocityLo = _mm_loadu_ps( velocity + lane );
+    __m128 velocityHi = _mm_loadu_ps( velocity + lane + 4 );
+
+    velocityLo = _mm_mul_ps( _mm_add_ps( velocityLo, _mm_mul_ps( _mm_loadu_ps( acceleration + lane     ), dt ) ), factorLo );
+    velocityHi = _mm_mul_ps( _mm_add_ps( velocityHi, _mm_mul_ps( _mm_loadu_ps( acceleration + lane + 4 ), dt ) ), factorHi );
+
+    _mm_storeu_ps( velocity + lane,     velocityLo );
+    _mm_storeu_ps( velocity + lane + 4, velocityHi );
+    _mm_storeu_ps( position + lane,     _mm_add_ps( _mm_loadu_ps( position + lane     ), _mm_mul_ps( velocityLo, dt ) ) );
+    _mm_storeu_ps( position + lane + 4, _mm_add_ps( _mm_loadu_ps( position + lane + 4 ), _mm_mul_ps( velocityHi, dt ) ) );
+  }
+  first = simdCount;
+#endif
+
+  IntegrateScalar( positions + first, velocities + first, accelerations + first, damping + first, count - first,
+                   deltaTime );
+}
+
+/**********************************************************************************************************************/
+
+void Movement::IntegrateScalar( Position *positions, Velocity *velocities, const Acceleration *accelerations,
+                                const Damping *damping, Uint32 count, float deltaTime )
+{
+  float lastCoefficient = 0.0f;
+  float factor          = 1.0f;
+  for( Uint32 i = 0; i < count; ++i ){
+    if( i == 0 || damping[i].coefficient != lastCoefficient ){
+      lastCoefficient = damping[i].coefficient;
+      factor          = DampingFactor( lastCoefficient, deltaTime );
+    }
+
+    velocities[i].x = ( velocities[i].x + accelerations[i].x * deltaTime ) * factor;
+    velocities[i].y = ( velocities[i].y + accelerations[i].y * deltaTime ) * factor;
+    positions[i].x += velocities[i].x * deltaTime;
+    positions[i].y += velocities[i].y * deltaTime;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void Movement::IntegrateFixed( FixedPosition *positions, const FixedVelocity *velocities, Uint32 count,
+                               Fixed tickDuration )
+{
+  for( Uint32 i = 0; i < count; ++i ){
+    positions[i].x += velocities[i].x * tickDuration;
+    positions[i].y += velocities[i].y * tickDuration;
+  }
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,151 @@
+#include "Prefab.h"
+
+// Alignment checks
+#include "AssertionManager.h"
+
+// max_align_t
+#include <cstddef>
+
+// memcpy
+#include <cstring>
+
+/**********************************************************************************************************************/
+
+const Uint32 ComponentValues::NO_OFFSET;
+
+/**********************************************************************************************************************/
+
+ComponentValues::ComponentValues( void )
+  : mMask(0)
+{
+  for( unsigned i = 0; i < ComponentRegistry::MAX_COMPONENT_TYPES; ++i ){
+    mOffsets[i] = NO_OFFSET;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ComponentValues::Set( ComponentTypeId type, const void *value )
+{
+  const ComponentRegistry::ComponentInfo &info = ComponentRegistry::GetInfo( type );
+
+  if( mOffsets[type] == NO_OFFSET ){
+    // The vector storage is only aligned for fundamental types
+    AssertMessage( info.mAlignment <= alignof(std::max_align_t), "Component alignment too large for a value set" );
+
+    const size_t offset = ( mData.size() + info.mAlignment - 1 ) & ~( info.mAlignment - 1 );
+    mData.resize( offset + info.mSize );
+    mOffsets[type]  = static_cast<Uint32>( offset );
+    mMask          |= static_cast<ComponentMask>( 1 ) << type;
+  }
+
+  memcpy( &mData[mOffsets[type]], value, info.mSize );
+}
+
+/**********************************************************************************************************************/
+
+const void *ComponentValues::Get( ComponentTypeId type ) const
+{
+  return mOffsets[type] == NO_OFFSET ? NULL : &mData[mOffsets[type]];
+}
+
+/**********************************************************************************************************************/
+
+void *ComponentValues::Get( ComponentTypeId type )
+{
+  return mOffsets[type] == NO_OFFSET ? NULL : &mData[mOffsets[type]];
+}
+
+/**********************************************************************************************************************/
+
+/**
+Release function of SharedComponents: drops the block references of entities leaving a world
+*/
+static void ReleaseSharedBlocks( void *components, Uint32 count )
+{
+  SharedComponents *shared = static_cast<SharedComponents*>( components );
+  for( Uint32 i = 0; i < count; ++i ){
+    if( shared[i].mBlock != NULL ){
+      shared[i].mBlock->Release();
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+Prefab::Prefab( void )
+  : mShared( new SharedComponentBlock( ComponentValues() ) )
+{
+  // Instances only exist once a prefab does
+  ComponentRegistry::SetReleaseFunction( ComponentType<SharedComponents>::GetId(), ReleaseSharedBlocks );
+}
+
+/**********************************************************************************************************************/
+
+Prefab::~Prefab( void )
+{
+  mShared->Release();
+}
+
+/**********************************************************************************************************************/
+
+void Prefab::Spawn( EntityWorld &world, Uint32 count, Entity *entities )
+{
+  if( count == 0 ){
+    return;
+  }
+  if( entities == NULL ){
+    mSpawned.resize( count );
+    entities = &mSpawned[0];
+  }
+
+  const void *values[ComponentRegistry::MAX_COMPONENT_TYPES] = { NULL };
+  for( ComponentTypeId type = 0; type < ComponentRegistry::MAX_COMPONENT_TYPES; ++type ){
+    values[type] = mInstance.Get( type );
+  }
+
+  SharedComponents shared = { mShared };
+  values[ComponentType<SharedComponents>::GetId()] = &shared;
+  mShared->AddRef( static_cast<int>( count ) );
+
+  world.CreateEntities( mInstance.GetMask() | ComponentType<SharedComponents>::GetMask(), count, entities, values );
+}
+
+/**********************************************************************************************************************/
+
+const void *Prefab::GetSharedRaw( const EntityWorld &world, Entity entity, ComponentTypeId type )
+{
+  const SharedComponents *shared = world.GetComponent<SharedComponents>( entity );
+  return shared != NULL && shared->mBlock != NULL ? shared->mBlock->GetValues().Get( type ) : NULL;
+}
+
+/**********************************************************************************************************************/
+
+void *Prefab::EditSharedRaw( EntityWorld &world, Entity entity, ComponentTypeId type )
+{
+  SharedComponents *shared = world.GetComponent<SharedComponents>( entity );
+  if( shared == NULL || shared->mBlock == NULL || shared->mBlock->GetValues().Get( type ) == NULL ){
+    return NULL;
+  }
+
+  // Copy on write: the instance gets its own block
+  if( shared->mBlock->IsShared() ){
+    SharedComponentBlock *copy = new SharedComponentBlock( shared->mBlock->GetValues() );
+    shared->mBlock->Release();
+    shared->mBlock = copy;
+  }
+  return shared->mBlock->GetMutableValues().Get( type );
+}
+
+/**********************************************************************************************************************/
+
+void Prefab::DetachShared( void )
+{
+  if( mShared->IsShared() ){
+    SharedComponentBlock *copy = new SharedComponentBlock( mShared->GetValues() );
+    mShared->Release();
+    mShared = copy;
+  }
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,263 @@
+#ifndef PREFAB_H
+#define PREFAB_H
+
+// Instances are entities
+#include "EntityWorld.h"
+
+// Block reference count
+#include <atomic>
+#include <vector>
+
+/**********************************************************************************************************************/
+
+/**
+Component values class
+A set of component values stored as raw bytes, one value per component type
+*/
+class ComponentValues
+{
+public:
+
+  /**
+  Constructor. Creates an empty set
+  */
+  ComponentValues( void );
+
+  /**
+  Sets the value of a component, adding it to the set if needed
+  @param type Component type
+  @param value Value copied into the set
+  */
+  void Set( ComponentTypeId type, const void *value );
+
+  /**
+  Returns the value of a component or NULL if the set does not have it
+  */
+  const void *Get( ComponentTypeId type ) const;
+  void       *Get( ComponentTypeId type );
+
+  /**
+  Typed versions
+  */
+  template < class T > inline void Set( const T &value ) {
+    Set( ComponentType<T>::GetId(), &value );
+  }
+  template < class T > inline const T *Get( void ) const {
+    return static_cast<const T*>( Get( ComponentType<T>::GetId() ) );
+  }
+
+  /**
+  Returns the components in the set
+  */
+  inline ComponentMask GetMask( void ) const {
+    return mMask;
+  }
+
+private:
+
+  static const Uint32 NO_OFFSET = 0xFFFFFFFF;
+
+  std::vector<Uint8>  mData;                                            ///< Values, each aligned for its type
+  Uint32              mOffsets[ComponentRegistry::MAX_COMPONENT_TYPES]; ///< Value offset by type or NO_OFFSET
+  ComponentMask       mMask;                                            ///< Components in the set
+};
+
+/**********************************************************************************************************************/
+
+/**
+Shared component block class
+Reference counted component values shared by many entities. A block referenced more than once is immutable: writers
+copy it first (see Prefab::EditShared)
+*/
+class SharedComponentBlock
+{
+public:
+
+  /**
+  Constructor. The creator holds the only reference
+  @param values Initial values
+  */
+  explicit SharedComponentBlock( const ComponentValues &values )
+    : mValues(values), mRefCount(1) { }
+
+  /**
+  Reference counting. The block deletes itself when the last reference is released
+  */
+  inline void AddRef( int count = 1 ) {
+    mRefCount += count;
+  }
+  inline void Release( void ) {
+    if( --mRefCount == 0 ){
+      delete this;
+    }
+  }
+
+  /**
+  Returns true if more than one owner references the block
+  */
+  inline bool IsShared( void ) const {
+    return mRefCount.load() > 1;
+  }
+
+  /**
+  Getters. Mutable values may only be used while the block is not shared
+  */
+  inline const ComponentValues &GetValues( void ) const {
+    return mValues;
+  }
+  inline ComponentValues &GetMutableValues( void ) {
+    return mValues;
+  }
+
+private:
+
+  // Non copyable: referenced by pointer
+  SharedComponentBlock( const SharedComponentBlock & );
+  SharedComponentBlock &operator=( const SharedComponentBlock & );
+
+  ComponentValues     mValues;    ///< Shared values
+  std::atomic<int>    mRefCount;  ///< Owners of the block
+};
+
+/**********************************************************************************************************************/
+
+/**
+Component referencing the shared block of a prefab instance. The entity reference is released by the world when the
+component leaves it, however the entity is destroyed
+*/
+struct SharedComponents
+{
+  SharedComponentBlock *mBlock;   ///< Shared values, one reference held by the entity. NULL for zeroed components
+};
+
+/**********************************************************************************************************************/
+
+/**
+Prefab class
+Entity template. Instance components are copied into every spawned entity; shared components (texture, size,
+animation set...) live once in a SharedComponentBlock that instances reference through their SharedComponents
+component, so they cost one pointer per entity. Editing a shared value of one instance copies the block first.
+Spawning fills whole chunks with memcpy. Instances are destroyed like any entity: the world releases their block
+reference through the release function of SharedComponents
+*/
+class Prefab
+{
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Creates an empty prefab
+  */
+  Prefab( void );
+
+  /**
+  Destructor. Spawned instances keep their shared block alive
+  */
+  ~Prefab( void );
+
+  /**
+  Sets a component copied into every instance
+  */
+  template < class T > void SetInstanceValue( const T &value );
+
+  /**
+  Sets a shared component. Already spawned instances keep the previous values
+  */
+  template < class T > void SetSharedValue( const T &value );
+
+  /**
+  Spawns instances in one batch
+  @param world World receiving the instances
+  @param count Number of instances
+  @param entities Returns the count new entities. May be NULL
+  */
+  void Spawn( EntityWorld &world, Uint32 count, Entity *entities = NULL );
+
+  /**
+  Returns a shared component of an instance or NULL if it does not have it
+  */
+  template < class T > static const T *GetShared( const EntityWorld &world, Entity entity );
+
+  /**
+  Returns a writable shared component of an instance, copying its block first if other entities reference it
+  @return Component or NULL if the instance does not have it
+  */
+  template < class T > static T *EditShared( EntityWorld &world, Entity entity );
+
+  /**
+  Getters
+  */
+  inline const ComponentValues &GetInstanceValues( void ) const {
+    return mInstance;
+  }
+  inline const ComponentValues &GetSharedValues( void ) const {
+    return mShared->GetValues();
+  }
+
+private:
+
+  // Non copyable: owns a block reference
+  Prefab( const Prefab & );
+  Prefab &operator=( const Prefab & );
+
+  /**
+  Untyped versions of the shared component access
+  */
+  static const void *GetSharedRaw( const EntityWorld &world, Entity entity, ComponentTypeId type );
+  static void       *EditSharedRaw( EntityWorld &world, Entity entity, ComponentTypeId type );
+
+  /**
+  Gives the prefab its own copy of the shared block if instances reference it
+  */
+  void DetachShared( void );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  ComponentValues         mInstance;  ///< Per instance components
+  SharedComponentBlock   *mShared;    ///< Shared components of new instances
+  std::vector<Entity>     mSpawned;   ///< Spawn scratch when the caller does not want the handles
+};
+
+/**********************************************************************************************************************/
+// TEMPLATE METHODS
+/**********************************************************************************************************************/
+
+template < class T >
+void Prefab::SetInstanceValue( const T &value )
+{
+  mInstance.Set( value );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+void Prefab::SetSharedValue( const T &value )
+{
+  DetachShared();
+  mShared->GetMutableValues().Set( value );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+const T *Prefab::GetShared( const EntityWorld &world, Entity entity )
+{
+  return static_cast<const T*>( GetSharedRaw( world, entity, ComponentType<T>::GetId() ) );
+}
+
+/**********************************************************************************************************************/
+
+template < class T >
+T *Prefab::EditShared( EntityWorld &world, Entity entity )
+{
+  return static_cast<T*>( EditSharedRaw( world, entity, ComponentType<T>::GetId() ) );
+}
+
+/**********************************************************************************************************************/
+
+#endif
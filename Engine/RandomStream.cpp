@@ -0,0 +1,71 @@
+#include "RandomStream.h"
+
+/**********************************************************************************************************************/
+
+static const Uint64 PCG_MULTIPLIER = 6364136223846793005ULL;
+
+/**********************************************************************************************************************/
+
+RandomStream::RandomStream( Uint64 seed, Uint64 stream )
+{
+  Seed( seed, stream );
+}
+
+/**********************************************************************************************************************/
+
+void RandomStream::Seed( Uint64 seed, Uint64 stream )
+{
+  // Reference PCG32 seeding
+  mState      = 0;
+  mIncrement  = ( stream << 1 ) | 1;
+  Next();
+  mState     += seed;
+  Next();
+}
+
+/**********************************************************************************************************************/
+
+Uint32 RandomStream::Next( void )
+{
+  // XSH RR output: xorshift the high bits and rotate by the top five
+  const Uint64 state      = mState;
+  mState                  = state * PCG_MULTIPLIER + mIncrement;
+  const Uint32 xorshifted = static_cast<Uint32>( ( ( state >> 18 ) ^ state ) >> 27 );
+  const Uint32 rotation   = static_cast<Uint32>( state >> 59 );
+  return ( xorshifted >> rotation ) | ( xorshifted << ( ( 32 - rotation ) & 31 ) );
+}
+
+/**********************************************************************************************************************/
+
+Uint32 RandomStream::NextBelow( Uint32 bound )
+{
+  if( bound == 0 ){
+    return 0;
+  }
+
+  // Reject the lowest 2^32 % bound values so every result is equally likely
+  const Uint32 threshold = ( 0u - bound ) % bound;
+  for( ;; ){
+    const Uint32 value = Next();
+    if( value >= threshold ){
+      return value % bound;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+int RandomStream::NextRange( int minimum, int maximum )
+{
+  const Uint32 span = static_cast<Uint32>( maximum ) - static_cast<Uint32>( minimum ) + 1;
+  return static_cast<int>( static_cast<Uint32>( minimum ) + ( span == 0 ? Next() : NextBelow( span ) ) );
+}
+
+/**********************************************************************************************************************/
+
+Fixed RandomStream::NextFixed( void )
+{
+  return Fixed::FromRaw( static_cast<Sint32>( Next() >> ( 32 - Fixed::FRACTION_BITS ) ) );
+}
+
+/**********************************************************************************************************************/
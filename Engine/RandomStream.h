@@ -0,0 +1,75 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+// Fixed point results
+#include "FixedPoint.h"
+
+/**
+Random stream class
+Seeded PCG32 generator. A seed and a stream number fully define the sequence, which is the same on every platform, and
+different stream numbers give independent sequences for the same seed. Giving every subsystem its own stream keeps one
+subsystem drawing more numbers from shifting the sequence of the others
+*/
+class RandomStream
+{
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param seed Starting point of the sequence
+  @param stream Sequence selector
+  */
+  explicit RandomStream( Uint64 seed = 0, Uint64 stream = 0 );
+
+  /**
+  Restarts the stream
+  */
+  void Seed( Uint64 seed, Uint64 stream = 0 );
+
+  /**
+  Next 32 random bits
+  */
+  Uint32 Next( void );
+
+  /**
+  Uniform integer in [0, bound), without modulo bias
+  */
+  Uint32 NextBelow( Uint32 bound );
+
+  /**
+  Uniform integer in [minimum, maximum], both included
+  */
+  int NextRange( int minimum, int maximum );
+
+  /**
+  Uniform fixed point value in [0, 1)
+  */
+  Fixed NextFixed( void );
+
+  /**
+  Internal state, for checksums and snapshots
+  */
+  inline Uint64 GetState( void ) const {
+    return mState;
+  }
+  inline Uint64 GetIncrement( void ) const {
+    return mIncrement;
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  Uint64 mState;        ///< Linear congruential state
+  Uint64 mIncrement;    ///< Odd increment derived from the stream number
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,264 @@
+#include "ScaledSpriteCache.h"
+
+// Surface release notifications
+#include "TextureManager.h"
+
+/**********************************************************************************************************************/
+
+ScaledSpriteCache::ScaledSpriteCache( size_t byteBudget )
+  : mByteBudget(byteBudget), mUsedBytes(0), mHits(0), mMisses(0)
+{
+  TextureManager *textureManager = TextureManager::GetInstancePtr();
+  if( textureManager ){
+    textureManager->AddSurfaceListener( OnSurfaceFreed, this );
+  }
+}
+
+/**********************************************************************************************************************/
+
+ScaledSpriteCache::~ScaledSpriteCache( void )
+{
+  TextureManager *textureManager = TextureManager::GetInstancePtr();
+  if( textureManager ){
+    textureManager->RemoveSurfaceListener( OnSurfaceFreed, this );
+  }
+  Clear();
+}
+
+/**********************************************************************************************************************/
+
+int ScaledSpriteCache::Blit( SDL_Surface *image, SDL_Surface *destination, SDL_Rect *destinationRect, ScaleFilter filter )
+{
+  if( image == NULL || destination == NULL ){
+    return SDL_SetError( "ScaledSpriteCache::Blit passed a NULL surface" );
+  }
+
+  const int width   = destinationRect ? destinationRect->w : destination->w;
+  const int height  = destinationRect ? destinationRect->h : destination->h;
+  if( width <= 0 || height <= 0 ){
+    return 0;
+  }
+
+  // No scaling needed
+  if( width == image->w && height == image->h ){
+    return SDL_BlitSurface( image, NULL, destination, destinationRect );
+  }
+
+  Key key;
+  key.mImage  = image;
+  key.mWidth  = width;
+  key.mHeight = height;
+  key.mFilter = filter;
+
+  EntryMap::iterator found = mLookup.find( key );
+  if( found != mLookup.end() ){
+    ++mHits;
+    // Move to most recently used position
+    mEntries.splice( mEntries.begin(), mEntries, found->second );
+    return SDL_BlitSurface( found->second->mScaled, NULL, destination, destinationRect );
+  }
+
+  ++mMisses;
+  SDL_Surface *scaled = CreateScaled( image, width, height, filter );
+  if( scaled == NULL ){
+    return -1;
+  }
+
+  const size_t bytes = static_cast<size_t>( scaled->pitch ) * static_cast<size_t>( scaled->h );
+  if( bytes > mByteBudget ){
+    // Does not fit even in an empty cache: use it once
+    int result = SDL_BlitSurface( scaled, NULL, destination, destinationRect );
+    SDL_FreeSurface( scaled );
+    return result;
+  }
+
+  MakeRoom( bytes );
+
+  Entry entry;
+  entry.mKey    = key;
+  entry.mScaled = scaled;
+  entry.mBytes  = bytes;
+  mEntries.push_front( entry );
+  mLookup[key]  = mEntries.begin();
+  mUsedBytes   += bytes;
+
+  return SDL_BlitSurface( scaled, NULL, destination, destinationRect );
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::Invalidate( const SDL_Surface *image )
+{
+  EntryList::iterator it = mEntries.begin();
+  while( it != mEntries.end() ){
+    EntryList::iterator current = it++;
+    if( current->mKey.mImage == image ){
+      Remove( current );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::Clear( void )
+{
+  while( !mEntries.empty() ){
+    Remove( mEntries.begin() );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::SetByteBudget( size_t byteBudget )
+{
+  mByteBudget = byteBudget;
+  MakeRoom( 0 );
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::OnSurfaceFreed( const SDL_Surface *surface, void *cache )
+{
+  static_cast<ScaledSpriteCache*>( cache )->Invalidate( surface );
+}
+
+/**********************************************************************************************************************/
+
+SDL_Surface *ScaledSpriteCache::CreateScaled( SDL_Surface *image, int width, int height, ScaleFilter filter )
+{
+  // Blit modifiers are applied when the scaled copy is drawn, not when it is created
+  Uint8         alphaMod;
+  Uint8         redMod;
+  Uint8         greenMod;
+  Uint8         blueMod;
+  SDL_BlendMode blendMode;
+  SDL_GetSurfaceAlphaMod( image, &alphaMod );
+  SDL_GetSurfaceColorMod( image, &redMod, &greenMod, &blueMod );
+  SDL_GetSurfaceBlendMode( image, &blendMode );
+
+  SDL_Surface *scaled = NULL;
+
+  if( filter == SCALE_FILTER_LINEAR ){
+    // Filter in ARGB8888. Conversion turns a color key into alpha
+    SDL_Surface *source = SDL_ConvertSurfaceFormat( image, SDL_PIXELFORMAT_ARGB8888, 0 );
+    if( source == NULL ){
+      return NULL;
+    }
+
+    scaled = SDL_CreateRGBSurfaceWithFormat( 0, width, height, 32, SDL_PIXELFORMAT_ARGB8888 );
+    if( scaled ){
+      ScaleLinear( source, scaled );
+      SDL_GetSurfaceBlendMode( source, &blendMode );
+    }
+    SDL_FreeSurface( source );
+  }
+  else{
+    scaled = SDL_CreateRGBSurfaceWithFormat( 0, width, height, image->format->BitsPerPixel, image->format->format );
+    if( scaled ){
+      if( image->format->palette ){
+        SDL_SetSurfacePalette( scaled, image->format->palette );
+      }
+
+      // Copy raw pixels: no blending, color key or modulation while scaling
+      Uint32    colorKey;
+      const int hasColorKey = SDL_GetColorKey( image, &colorKey ) == 0;
+      SDL_SetColorKey( image, SDL_FALSE, 0 );
+      SDL_SetSurfaceBlendMode( image, SDL_BLENDMODE_NONE );
+      SDL_SetSurfaceAlphaMod( image, 255 );
+      SDL_SetSurfaceColorMod( image, 255, 255, 255 );
+
+      SDL_BlitScaled( image, NULL, scaled, NULL );
+
+      SDL_SetSurfaceColorMod( image, redMod, greenMod, blueMod );
+      SDL_SetSurfaceAlphaMod( image, alphaMod );
+      SDL_SetSurfaceBlendMode( image, blendMode );
+      if( hasColorKey ){
+        SDL_SetColorKey( image, SDL_TRUE, colorKey );
+        SDL_SetColorKey( scaled, SDL_TRUE, colorKey );
+      }
+    }
+  }
+
+  if( scaled ){
+    SDL_SetSurfaceBlendMode( scaled, blendMode );
+    SDL_SetSurfaceAlphaMod( scaled, alphaMod );
+    SDL_SetSurfaceColorMod( scaled, redMod, greenMod, blueMod );
+  }
+  return scaled;
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::ScaleLinear( const SDL_Surface *source, SDL_Surface *destination )
+{
+  // 16.16 fixed point source coordinates sampled at pixel centers
+  const Sint64 stepX  = ( static_cast<Sint64>( source->w ) << 16 ) / destination->w;
+  const Sint64 stepY  = ( static_cast<Sint64>( source->h ) << 16 ) / destination->h;
+  const int    maxX   = source->w - 1;
+  const int    maxY   = source->h - 1;
+
+  for( int y = 0; y < destination->h; ++y ){
+    Sint64 sampleY = stepY * y + stepY / 2 - 0x8000;
+    if( sampleY < 0 ){
+      sampleY = 0;
+    }
+    const int     y0        = SDL_min( static_cast<int>( sampleY >> 16 ), maxY );
+    const int     y1        = SDL_min( y0 + 1, maxY );
+    const Uint32  weightY   = static_cast<Uint32>( ( sampleY >> 8 ) & 0xFF );
+    const Uint32 *row0      = reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( source->pixels ) + y0 * source->pitch );
+    const Uint32 *row1      = reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( source->pixels ) + y1 * source->pitch );
+    Uint32       *output    = reinterpret_cast<Uint32*>( static_cast<Uint8*>( destination->pixels ) + y * destination->pitch );
+
+    for( int x = 0; x < destination->w; ++x ){
+      Sint64 sampleX = stepX * x + stepX / 2 - 0x8000;
+      if( sampleX < 0 ){
+        sampleX = 0;
+      }
+      const int     x0      = SDL_min( static_cast<int>( sampleX >> 16 ), maxX );
+      const int     x1      = SDL_min( x0 + 1, maxX );
+      const Uint32  weightX = static_cast<Uint32>( ( sampleX >> 8 ) & 0xFF );
+
+      const Uint32 p00 = row0[x0];
+      const Uint32 p01 = row0[x1];
+      const Uint32 p10 = row1[x0];
+      const Uint32 p11 = row1[x1];
+
+      // Blend the four channels with 8 bit weights
+      Uint32 result = 0;
+      for( int shift = 0; shift < 32; shift += 8 ){
+        const Uint32 c00 = ( p00 >> shift ) & 0xFF;
+        const Uint32 c01 = ( p01 >> shift ) & 0xFF;
+        const Uint32 c10 = ( p10 >> shift ) & 0xFF;
+        const Uint32 c11 = ( p11 >> shift ) & 0xFF;
+        const Uint32 top    = c00 * ( 256 - weightX ) + c01 * weightX;
+        const Uint32 bottom = c10 * ( 256 - weightX ) + c11 * weightX;
+        const Uint32 value  = ( top * ( 256 - weightY ) + bottom * weightY ) >> 16;
+        result |= value << shift;
+      }
+      output[x] = result;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::MakeRoom( size_t bytes )
+{
+  while( !mEntries.empty() && mUsedBytes + bytes > mByteBudget ){
+    EntryList::iterator last = mEntries.end();
+    --last;
+    Remove( last );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void ScaledSpriteCache::Remove( EntryList::iterator entry )
+{
+  mUsedBytes -= entry->mBytes;
+  SDL_FreeSurface( entry->mScaled );
+  mLookup.erase( entry->mKey );
+  mEntries.erase( entry );
+}
+
+/**********************************************************************************************************************/
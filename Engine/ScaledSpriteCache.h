@@ -0,0 +1,212 @@
+#ifndef SCALEDSPRITECACHE_H
+#define SCALEDSPRITECACHE_H
+
+// SDL surfaces
+#include <SDL.h>
+
+// Cache storage
+#include <list>
+#include <unordered_map>
+
+/**
+Scaled sprite cache class
+Keeps pre-scaled copies of surfaces keyed by (image, target size, filter) so repeated scaled blits become plain copies.
+Entries are evicted in least recently used order when the byte budget is exceeded. The cache listens to
+TextureManager and drops the copies of its surfaces before they are freed, so a surface reallocated at the address of
+a freed one never hits a stale copy
+*/
+class ScaledSpriteCache
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const size_t DEFAULT_BYTE_BUDGET = 8 * 1024 * 1024;  ///< Default memory used by scaled copies
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Filter used when scaling
+  */
+  enum ScaleFilter
+  {
+    SCALE_FILTER_NEAREST,   ///< Same result as SDL_BlitScaled
+    SCALE_FILTER_LINEAR     ///< Bilinear filtering
+  };
+
+private:
+
+  /**
+  Cache key
+  */
+  struct Key
+  {
+    const SDL_Surface  *mImage;     ///< Source surface
+    int                 mWidth;     ///< Target width
+    int                 mHeight;    ///< Target height
+    ScaleFilter         mFilter;    ///< Filter used
+
+    inline bool operator==( const Key &other ) const {
+      return mImage == other.mImage && mWidth == other.mWidth && mHeight == other.mHeight && mFilter == other.mFilter;
+    }
+  };
+
+  /**
+  Hash for cache keys
+  */
+  struct KeyHash
+  {
+    inline size_t operator()( const Key &key ) const {
+      size_t hash = std::hash<const void*>()( key.mImage );
+      hash ^= ( static_cast<size_t>( key.mWidth  ) * 73856093u ) ^ ( static_cast<size_t>( key.mHeight ) * 19349663u );
+      hash ^= static_cast<size_t>( key.mFilter ) * 83492791u;
+      return hash;
+    }
+  };
+
+  /**
+  Cached scaled copy
+  */
+  struct Entry
+  {
+    Key           mKey;       ///< Key of the copy
+    SDL_Surface  *mScaled;    ///< Scaled surface
+    size_t        mBytes;     ///< Memory used by the scaled pixels
+  };
+
+  typedef std::list<Entry>                                            EntryList;
+  typedef std::unordered_map<Key, EntryList::iterator, KeyHash>       EntryMap;
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Registers with TextureManager when it exists
+  @param byteBudget Maximum memory used by scaled copies
+  */
+  explicit ScaledSpriteCache( size_t byteBudget = DEFAULT_BYTE_BUDGET );
+
+  /**
+  Destructor. Frees every scaled copy
+  */
+  ~ScaledSpriteCache( void );
+
+  /**
+  Scaled blit through the cache. Drop-in replacement for SDL_BlitScaled with a full source rect
+  @param image Source surface. Its pixels must not change while cached. Surfaces not kept by TextureManager must be
+  invalidated before they are freed
+  @param destination Destination surface
+  @param destinationRect Destination rect, NULL to fill the destination
+  @param filter Filter used for scaling
+  @return 0 on success, negative on error as SDL_BlitSurface
+  */
+  int Blit( SDL_Surface *image, SDL_Surface *destination, SDL_Rect *destinationRect,
+            ScaleFilter filter = SCALE_FILTER_NEAREST );
+
+  /**
+  Removes every scaled copy of an image. Called for TextureManager surfaces, other images must call it before they
+  are freed or modified
+  @param image Source surface
+  */
+  void Invalidate( const SDL_Surface *image );
+
+  /**
+  Removes every scaled copy
+  */
+  void Clear( void );
+
+  /**
+  Set and get for the byte budget. Lowering it evicts entries immediately
+  */
+  inline size_t GetByteBudget( void ) const {
+    return mByteBudget;
+  }
+  void SetByteBudget( size_t byteBudget );
+
+  /**
+  Statistics getters
+  */
+  inline size_t GetUsedBytes( void ) const {
+    return mUsedBytes;
+  }
+  inline Uint64 GetHits( void ) const {
+    return mHits;
+  }
+  inline Uint64 GetMisses( void ) const {
+    return mMisses;
+  }
+  inline float GetHitRate( void ) const {
+    Uint64 lookups = mHits + mMisses;
+    return lookups ? static_cast<float>( mHits ) / static_cast<float>( lookups ) : 0.0f;
+  }
+  inline void ResetStats( void ){
+    mHits   = 0;
+    mMisses = 0;
+  }
+
+private:
+
+  // Non copyable: entries own surfaces
+  ScaledSpriteCache( const ScaledSpriteCache & );
+  ScaledSpriteCache &operator=( const ScaledSpriteCache & );
+
+  /**
+  TextureManager listener: invalidates a surface about to be freed
+  @param surface Surface about to be freed
+  @param cache The cache
+  */
+  static void OnSurfaceFreed( const SDL_Surface *surface, void *cache );
+
+  /**
+  Creates a scaled copy of an image
+  @param image Source surface
+  @param width Target width
+  @param height Target height
+  @param filter Filter used for scaling
+  @return New surface or NULL on error
+  */
+  static SDL_Surface *CreateScaled( SDL_Surface *image, int width, int height, ScaleFilter filter );
+
+  /**
+  Bilinear scaling between two ARGB8888 surfaces
+  */
+  static void ScaleLinear( const SDL_Surface *source, SDL_Surface *destination );
+
+  /**
+  Evicts least recently used entries until the given amount of bytes fits into the budget
+  @param bytes Bytes that must fit
+  */
+  void MakeRoom( size_t bytes );
+
+  /**
+  Removes an entry and frees its surface
+  @param entry Entry to remove
+  */
+  void Remove( EntryList::iterator entry );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  EntryList   mEntries;       ///< Entries in most recently used first order
+  EntryMap    mLookup;        ///< Entries by key
+  size_t      mByteBudget;    ///< Maximum bytes used by scaled copies
+  size_t      mUsedBytes;     ///< Bytes used by scaled copies
+  Uint64      mHits;          ///< Blits served from the cache
+  Uint64      mMisses;        ///< Blits that had to scale
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -4,6 +4,9 @@
 // For asserts
 #include <string>
 
+// For MessageBox
+#include "TypesWindows.h"
+
 /**
 Class Singleton
 Base class to create singletons controlling construction and destruction of singleton
@@ -0,0 +1,246 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+// Stale handle detection
+#include "AssertionManager.h"
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+// Slot and dense storage
+#include <vector>
+
+/**********************************************************************************************************************/
+
+/**
+Slot map handle
+32 bit slot index plus 32 bit generation. The generation changes every time the slot is freed, so handles to destroyed
+elements are detected instead of silently referencing whatever reused the slot
+*/
+struct SlotMapHandle
+{
+  Uint32 mIndex;        ///< Slot index
+  Uint32 mGeneration;   ///< Generation of the slot when the handle was created
+
+  inline bool operator==( const SlotMapHandle &other ) const {
+    return mIndex == other.mIndex && mGeneration == other.mGeneration;
+  }
+  inline bool operator!=( const SlotMapHandle &other ) const {
+    return !( *this == other );
+  }
+
+  /**
+  Packs the handle into 64 bits (index in the low half) for hashing, sorting or serialization
+  */
+  inline Uint64 GetKey( void ) const {
+    return ( static_cast<Uint64>( mGeneration ) << 32 ) | mIndex;
+  }
+};
+
+static const SlotMapHandle INVALID_SLOT_MAP_HANDLE = { 0xFFFFFFFF, 0 };  ///< Handle that never references an element
+
+/**********************************************************************************************************************/
+
+/**
+Slot map class
+Stores elements densely packed for iteration and gives out generational handles to them. Create, Destroy and lookup are
+O(1): destroyed elements are replaced by the last element and their slot goes to a free list for reuse
+*/
+template < class T >
+class SlotMap
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+  static const Uint32 END_OF_FREE_LIST  = 0xFFFFFFFF;  ///< Free list terminator
+  static const Uint32 MAX_GENERATION    = 0xFFFFFFFE;  ///< Freed slots reaching it are retired instead of wrapping
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  /**
+  Indirection from handle index to dense position
+  */
+  struct Slot
+  {
+    Uint32 mDenseIndex;   ///< Position of the element in the dense array, or next free slot if free
+    Uint32 mGeneration;   ///< Current generation. Odd while the slot is in use
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  SlotMap( void )
+    : mFreeHead(END_OF_FREE_LIST), mFreeTail(END_OF_FREE_LIST) { }
+
+  /**
+  Adds an element
+  @param value Element to copy in
+  @return Handle to the element
+  */
+  SlotMapHandle Create( const T &value )
+  {
+    Uint32 index;
+    if( mFreeHead != END_OF_FREE_LIST ){
+      index     = mFreeHead;
+      mFreeHead = mSlots[index].mDenseIndex;
+      if( mFreeHead == END_OF_FREE_LIST ){
+        mFreeTail = END_OF_FREE_LIST;
+      }
+    }
+    else{
+      index = static_cast<Uint32>( mSlots.size() );
+      Slot slot;
+      slot.mGeneration = 0;
+      mSlots.push_back( slot );
+    }
+
+    Slot &slot        = mSlots[index];
+    slot.mDenseIndex  = static_cast<Uint32>( mDense.size() );
+    ++slot.mGeneration;
+
+    mDense.push_back( value );
+    mDenseToSlot.push_back( index );
+
+    SlotMapHandle handle;
+    handle.mIndex       = index;
+    handle.mGeneration  = slot.mGeneration;
+    return handle;
+  }
+
+  /**
+  Removes an element. Its handle and every copy of it become stale
+  @param handle Element to remove
+  */
+  void Destroy( SlotMapHandle handle )
+  {
+    AssertMessage( IsValid( handle ), "Destroying through a stale or invalid slot map handle" );
+    if( !IsValid( handle ) ){
+      return;
+    }
+
+    Slot        &slot       = mSlots[handle.mIndex];
+    const Uint32 denseIndex = slot.mDenseIndex;
+    const Uint32 lastIndex  = static_cast<Uint32>( mDense.size() - 1 );
+
+    // Keep dense storage packed by moving the last element into the hole
+    if( denseIndex != lastIndex ){
+      mDense[denseIndex]                          = mDense[lastIndex];
+      mDenseToSlot[denseIndex]                    = mDenseToSlot[lastIndex];
+      mSlots[mDenseToSlot[denseIndex]].mDenseIndex = denseIndex;
+    }
+    mDense.pop_back();
+    mDenseToSlot.pop_back();
+
+    // Even generation marks the slot free. Slots that ran out of generations are never reused
+    ++slot.mGeneration;
+    if( slot.mGeneration == MAX_GENERATION ){
+      return;
+    }
+
+    // Append to the tail so a slot rests as long as possible before reuse
+    slot.mDenseIndex = END_OF_FREE_LIST;
+    if( mFreeTail != END_OF_FREE_LIST ){
+      mSlots[mFreeTail].mDenseIndex = handle.mIndex;
+    }
+    else{
+      mFreeHead = handle.mIndex;
+    }
+    mFreeTail = handle.mIndex;
+  }
+
+  /**
+  Returns true if the handle references an existing element. Never asserts
+  */
+  inline bool IsValid( SlotMapHandle handle ) const
+  {
+    return handle.mIndex < mSlots.size() && mSlots[handle.mIndex].mGeneration == handle.mGeneration
+           && ( handle.mGeneration & 1 ) != 0;
+  }
+
+  /**
+  Returns the element referenced by a handle. Asserts on stale handles
+  @param handle Element handle
+  @return Element or NULL if the handle is stale or invalid
+  */
+  inline T *Get( SlotMapHandle handle )
+  {
+    AssertMessage( IsValid( handle ), "Stale or invalid slot map handle" );
+    return IsValid( handle ) ? &mDense[mSlots[handle.mIndex].mDenseIndex] : NULL;
+  }
+  inline const T *Get( SlotMapHandle handle ) const
+  {
+    AssertMessage( IsValid( handle ), "Stale or invalid slot map handle" );
+    return IsValid( handle ) ? &mDense[mSlots[handle.mIndex].mDenseIndex] : NULL;
+  }
+
+  /**
+  Returns the handle of the element at a dense position
+  @param denseIndex Position in the dense array
+  @return Handle of the element
+  */
+  inline SlotMapHandle GetHandle( size_t denseIndex ) const
+  {
+    SlotMapHandle handle;
+    handle.mIndex       = mDenseToSlot[denseIndex];
+    handle.mGeneration  = mSlots[handle.mIndex].mGeneration;
+    return handle;
+  }
+
+  /**
+  Removes every element. Outstanding handles become stale
+  */
+  void Clear( void )
+  {
+    while( !mDense.empty() ){
+      Destroy( GetHandle( mDense.size() - 1 ) );
+    }
+  }
+
+  /**
+  Dense storage access for linear iteration. Order changes on Destroy
+  */
+  inline size_t GetSize( void ) const {
+    return mDense.size();
+  }
+  inline T *GetData( void ) {
+    return mDense.empty() ? NULL : &mDense[0];
+  }
+  inline const T *GetData( void ) const {
+    return mDense.empty() ? NULL : &mDense[0];
+  }
+  inline T &operator[]( size_t denseIndex ) {
+    return mDense[denseIndex];
+  }
+  inline const T &operator[]( size_t denseIndex ) const {
+    return mDense[denseIndex];
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  std::vector<Slot>     mSlots;         ///< Slots indexed by handle index
+  std::vector<T>        mDense;         ///< Packed elements
+  std::vector<Uint32>   mDenseToSlot;   ///< Slot of every packed element
+  Uint32                mFreeHead;      ///< First free slot
+  Uint32                mFreeTail;      ///< Last free slot
+};
+
+/**********************************************************************************************************************/
+
+#endif
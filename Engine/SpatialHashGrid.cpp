@@ -0,0 +1,234 @@
+#include "SpatialHashGrid.h"
+
+// Invalid proxy checks
+#include "AssertionManager.h"
+
+/**********************************************************************************************************************/
+
+SpatialHashGrid::SpatialHashGrid( int cellSize, Uint32 bucketCount )
+  : mCellSize(cellSize), mBucketMask(0), mEntryCount(0), mQueryStamp(0)
+{
+  AssertMessage( cellSize > 0, "Spatial hash cell size must be positive" );
+
+  Uint32 buckets = 1;
+  while( buckets < bucketCount ){
+    buckets <<= 1;
+  }
+  mBuckets.resize( buckets );
+  mBucketMask = buckets - 1;
+}
+
+/**********************************************************************************************************************/
+
+ProxyId SpatialHashGrid::Insert( const SDL_Rect &rect, Uint64 userData )
+{
+  ProxyId id;
+  if( !mFreeProxies.empty() ){
+    id = mFreeProxies.back();
+    mFreeProxies.pop_back();
+  }
+  else{
+    id = static_cast<ProxyId>( mProxies.size() );
+    mProxies.push_back( Proxy() );
+    mRects.push_back( rect );
+  }
+
+  Proxy &proxy      = mProxies[id];
+  proxy.mUserData   = userData;
+  proxy.mQueryStamp = mQueryStamp;
+  proxy.mAlive      = true;
+  mRects[id]        = rect;
+  ComputeCells( rect, proxy );
+  AddToCells( id );
+
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::Move( ProxyId id, const SDL_Rect &rect )
+{
+  AssertMessage( id < mProxies.size() && mProxies[id].mAlive, "Moving an invalid proxy" );
+  if( id >= mProxies.size() || !mProxies[id].mAlive ){
+    return;
+  }
+
+  Proxy &proxy = mProxies[id];
+  mRects[id]   = rect;
+
+  Proxy moved = proxy;
+  ComputeCells( rect, moved );
+  if( moved.mMinCellX == proxy.mMinCellX && moved.mMinCellY == proxy.mMinCellY &&
+      moved.mMaxCellX == proxy.mMaxCellX && moved.mMaxCellY == proxy.mMaxCellY ){
+    return;
+  }
+
+  RemoveFromCells( id );
+  proxy = moved;
+  AddToCells( id );
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::Remove( ProxyId id )
+{
+  AssertMessage( id < mProxies.size() && mProxies[id].mAlive, "Removing an invalid proxy" );
+  if( id >= mProxies.size() || !mProxies[id].mAlive ){
+    return;
+  }
+
+  RemoveFromCells( id );
+  mProxies[id].mAlive = false;
+  mFreeProxies.push_back( id );
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::Clear( void )
+{
+  for( size_t i = 0; i < mBuckets.size(); ++i ){
+    mBuckets[i].clear();
+  }
+  mProxies.clear();
+  mRects.clear();
+  mFreeProxies.clear();
+  mEntryCount = 0;
+}
+
+/**********************************************************************************************************************/
+
+Uint32 SpatialHashGrid::Query( const SDL_Rect &region, ProxyId *results, Uint32 capacity )
+{
+  Proxy area;
+  ComputeCells( region, area );
+
+  // Stamps skip objects already found through another cell
+  ++mQueryStamp;
+  Uint32 count = 0;
+  for( int y = area.mMinCellY; y <= area.mMaxCellY; ++y ){
+    for( int x = area.mMinCellX; x <= area.mMaxCellX; ++x ){
+      const std::vector<CellEntry> &bucket = mBuckets[GetBucket( x, y )];
+      for( size_t i = 0; i < bucket.size(); ++i ){
+        Proxy &proxy = mProxies[bucket[i].mProxy];
+        if( proxy.mQueryStamp == mQueryStamp || bucket[i].mCellX != x || bucket[i].mCellY != y ){
+          continue;
+        }
+        proxy.mQueryStamp = mQueryStamp;
+        if( RectsOverlap( mRects[bucket[i].mProxy], region ) ){
+          if( count < capacity ){
+            results[count] = bucket[i].mProxy;
+          }
+          ++count;
+        }
+      }
+    }
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+Uint32 SpatialHashGrid::FindPairs( BroadphasePair *pairs, Uint32 capacity ) const
+{
+  Uint32 count = 0;
+  for( size_t b = 0; b < mBuckets.size(); ++b ){
+    // Most buckets hold one entry at the target load, skip them before reading any rect
+    const std::vector<CellEntry> &bucket = mBuckets[b];
+    if( bucket.size() < 2 ){
+      continue;
+    }
+    for( size_t i = 0; i < bucket.size(); ++i ){
+      const CellEntry &first  = bucket[i];
+      const SDL_Rect  &a      = mRects[first.mProxy];
+
+      for( size_t j = i + 1; j < bucket.size(); ++j ){
+        // Buckets also hold other cells hashed to the same place
+        const CellEntry &second = bucket[j];
+        if( second.mCellX != first.mCellX || second.mCellY != first.mCellY ){
+          continue;
+        }
+
+        // Report the pair from the first cell the two objects share only
+        const SDL_Rect &b = mRects[second.mProxy];
+        if( !RectsOverlap( a, b ) ||
+            first.mCellX != ToCell( a.x > b.x ? a.x : b.x ) || first.mCellY != ToCell( a.y > b.y ? a.y : b.y ) ){
+          continue;
+        }
+
+        if( count < capacity ){
+          pairs[count].mA = first.mProxy < second.mProxy ? first.mProxy : second.mProxy;
+          pairs[count].mB = first.mProxy < second.mProxy ? second.mProxy : first.mProxy;
+        }
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::ComputeCells( const SDL_Rect &rect, Proxy &cells ) const
+{
+  // Empty rects still get a cell so they can be moved and removed like the others
+  cells.mMinCellX = ToCell( rect.x );
+  cells.mMinCellY = ToCell( rect.y );
+  cells.mMaxCellX = ToCell( rect.w > 0 ? rect.x + rect.w - 1 : rect.x );
+  cells.mMaxCellY = ToCell( rect.h > 0 ? rect.y + rect.h - 1 : rect.y );
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::AddToCells( ProxyId id )
+{
+  const Proxy &proxy = mProxies[id];
+  for( int y = proxy.mMinCellY; y <= proxy.mMaxCellY; ++y ){
+    for( int x = proxy.mMinCellX; x <= proxy.mMaxCellX; ++x ){
+      CellEntry entry = { id, x, y };
+      mBuckets[GetBucket( x, y )].push_back( entry );
+      ++mEntryCount;
+    }
+  }
+
+  if( mEntryCount > static_cast<Uint64>( mBucketMask + 1 ) * MAX_BUCKET_LOAD ){
+    Rehash( ( mBucketMask + 1 ) * 2 );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::RemoveFromCells( ProxyId id )
+{
+  const Proxy &proxy = mProxies[id];
+  for( int y = proxy.mMinCellY; y <= proxy.mMaxCellY; ++y ){
+    for( int x = proxy.mMinCellX; x <= proxy.mMaxCellX; ++x ){
+      std::vector<CellEntry> &bucket = mBuckets[GetBucket( x, y )];
+      for( size_t i = 0; i < bucket.size(); ++i ){
+        if( bucket[i].mProxy == id && bucket[i].mCellX == x && bucket[i].mCellY == y ){
+          bucket[i] = bucket.back();
+          bucket.pop_back();
+          --mEntryCount;
+          break;
+        }
+      }
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void SpatialHashGrid::Rehash( Uint32 bucketCount )
+{
+  std::vector< std::vector<CellEntry> > buckets( bucketCount );
+  mBuckets.swap( buckets );
+  mBucketMask = bucketCount - 1;
+
+  for( size_t b = 0; b < buckets.size(); ++b ){
+    for( size_t i = 0; i < buckets[b].size(); ++i ){
+      const CellEntry &entry = buckets[b][i];
+      mBuckets[GetBucket( entry.mCellX, entry.mCellY )].push_back( entry );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
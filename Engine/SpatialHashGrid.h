@@ -0,0 +1,186 @@
+#ifndef SPATIALHASHGRID_H
+#define SPATIALHASHGRID_H
+
+// Proxy and pair types
+#include "Broadphase.h"
+
+// Proxy and bucket storage
+#include <vector>
+
+/**
+Spatial hash grid class
+Broadphase over axis aligned rects. Space is cut in square cells and every rect is stored in the cells it covers; cells
+are hashed into buckets so the grid has no bounds. The bucket table doubles when it holds more than MAX_BUCKET_LOAD
+cell entries per bucket, so unrelated cells rarely share a bucket whatever the object count. Only rects sharing a cell
+are tested against each other, and a pair is reported from the first cell of its overlap only, so every pair appears
+once. Moving a rect inside the cells it already covers does not touch the buckets
+*/
+class SpatialHashGrid
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const int      DEFAULT_CELL_SIZE     = 64;     ///< Pixels. Best around the size of a typical object
+  static const Uint32   DEFAULT_BUCKET_COUNT  = 4096;   ///< Initial bucket count, power of two
+  static const Uint32   MAX_BUCKET_LOAD       = 1;      ///< Average cell entries per bucket before the table doubles
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Registered object. Rects are kept in their own array so pair tests read less memory
+  */
+  struct Proxy
+  {
+    int       mMinCellX;    ///< Covered cells, inclusive
+    int       mMinCellY;
+    int       mMaxCellX;
+    int       mMaxCellY;
+    Uint64    mUserData;    ///< Caller data, usually an entity key
+    Uint32    mQueryStamp;  ///< Last query that returned the proxy
+    bool      mAlive;       ///< Slot in use
+  };
+
+  /**
+  Proxy stored in a cell
+  */
+  struct CellEntry
+  {
+    ProxyId   mProxy;
+    int       mCellX;
+    int       mCellY;
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param cellSize Cell side in pixels
+  @param bucketCount Initial number of hash buckets, rounded up to a power of two
+  */
+  explicit SpatialHashGrid( int cellSize = DEFAULT_CELL_SIZE, Uint32 bucketCount = DEFAULT_BUCKET_COUNT );
+
+  /**
+  Adds a rect
+  @param rect Rect of the object
+  @param userData Caller data returned by GetUserData
+  @return Proxy id of the object
+  */
+  ProxyId Insert( const SDL_Rect &rect, Uint64 userData = 0 );
+
+  /**
+  Changes the rect of an object. Buckets are only updated if the covered cells change
+  */
+  void Move( ProxyId proxy, const SDL_Rect &rect );
+
+  /**
+  Removes an object. The id may be reused by the next Insert
+  */
+  void Remove( ProxyId proxy );
+
+  /**
+  Removes every object
+  */
+  void Clear( void );
+
+  /**
+  Finds the objects overlapping a region
+  @param region Searched rect
+  @param results Buffer receiving the proxies
+  @param capacity Size of the buffer
+  @return Number of overlapping objects. Only the first capacity ones are written
+  */
+  Uint32 Query( const SDL_Rect &region, ProxyId *results, Uint32 capacity );
+
+  /**
+  Finds every pair of overlapping objects
+  @param pairs Buffer receiving the pairs, preallocated by the caller
+  @param capacity Size of the buffer
+  @return Number of overlapping pairs. Only the first capacity ones are written, call again with a larger buffer if
+  the result is greater than capacity
+  */
+  Uint32 FindPairs( BroadphasePair *pairs, Uint32 capacity ) const;
+
+  /**
+  Getters
+  */
+  inline const SDL_Rect &GetRect( ProxyId proxy ) const {
+    return mRects[proxy];
+  }
+  inline Uint64 GetUserData( ProxyId proxy ) const {
+    return mProxies[proxy].mUserData;
+  }
+  inline Uint32 GetProxyCount( void ) const {
+    return static_cast<Uint32>( mProxies.size() - mFreeProxies.size() );
+  }
+  inline int GetCellSize( void ) const {
+    return mCellSize;
+  }
+  inline Uint32 GetBucketCount( void ) const {
+    return mBucketMask + 1;
+  }
+
+private:
+
+  /**
+  Returns the cell containing a coordinate, rounding toward negative infinity
+  */
+  inline int ToCell( int coordinate ) const {
+    return coordinate >= 0 ? coordinate / mCellSize : -( ( -coordinate - 1 ) / mCellSize ) - 1;
+  }
+
+  /**
+  Returns the bucket of a cell
+  */
+  inline Uint32 GetBucket( int cellX, int cellY ) const {
+    return ( static_cast<Uint32>( cellX ) * 73856093u ^ static_cast<Uint32>( cellY ) * 19349663u ) & mBucketMask;
+  }
+
+  /**
+  Computes the cells covered by a rect
+  */
+  void ComputeCells( const SDL_Rect &rect, Proxy &cells ) const;
+
+  /**
+  Adds or removes a proxy in the buckets of all its cells
+  */
+  void AddToCells( ProxyId id );
+  void RemoveFromCells( ProxyId id );
+
+  /**
+  Redistributes the cell entries into a new bucket table
+  @param bucketCount New number of buckets, power of two
+  */
+  void Rehash( Uint32 bucketCount );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<Proxy>                    mProxies;       ///< Proxies by id
+  std::vector<SDL_Rect>                 mRects;         ///< Rects by proxy id
+  std::vector<ProxyId>                  mFreeProxies;   ///< Released ids
+  std::vector< std::vector<CellEntry> > mBuckets;       ///< Cell entries by bucket
+  int                                   mCellSize;      ///< Cell side in pixels
+  Uint32                                mBucketMask;    ///< Bucket count - 1
+  Uint32                                mEntryCount;    ///< Cell entries in all buckets
+  Uint32                                mQueryStamp;    ///< Query counter
+};
+
+/**********************************************************************************************************************/
+
+#endif
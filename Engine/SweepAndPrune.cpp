@@ -0,0 +1,215 @@
+#include "SweepAndPrune.h"
+
+// Invalid proxy checks
+#include "AssertionManager.h"
+
+// Full sort after mass inserts
+#include <algorithm>
+
+/**********************************************************************************************************************/
+
+// Sort keys of the endpoints of a rect along one axis. Empty rects end right after they start
+static inline Sint64 StartKey( int start )
+{
+  return static_cast<Sint64>( start ) * 2 + 1;
+}
+
+static inline Sint64 EndKey( int start, int size )
+{
+  return size > 0 ? ( static_cast<Sint64>( start ) + size ) * 2 : StartKey( start ) + 1;
+}
+
+/**********************************************************************************************************************/
+
+SweepAndPrune::SweepAndPrune( void )
+  : mInserted(0)
+{
+  mAxes[0].mVariance  = 0.0;
+  mAxes[1].mVariance  = 0.0;
+  mSwapCount[0]       = 0;
+  mSwapCount[1]       = 0;
+}
+
+/**********************************************************************************************************************/
+
+ProxyId SweepAndPrune::Insert( const SDL_Rect &rect, Uint64 userData )
+{
+  ProxyId id;
+  if( !mFreeProxies.empty() ){
+    id = mFreeProxies.back();
+    mFreeProxies.pop_back();
+  }
+  else{
+    id = static_cast<ProxyId>( mProxies.size() );
+    mProxies.push_back( Proxy() );
+    mRects.push_back( rect );
+  }
+
+  mProxies[id].mUserData  = userData;
+  mProxies[id].mAlive     = true;
+  mRects[id]              = rect;
+
+  const Endpoint endpoints[4] = { { StartKey( rect.x ), id }, { EndKey( rect.x, rect.w ), id },
+                                  { StartKey( rect.y ), id }, { EndKey( rect.y, rect.h ), id } };
+  mAxes[0].mEndpoints.push_back( endpoints[0] );
+  mAxes[0].mEndpoints.push_back( endpoints[1] );
+  mAxes[1].mEndpoints.push_back( endpoints[2] );
+  mAxes[1].mEndpoints.push_back( endpoints[3] );
+  mInserted += 2;
+
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+void SweepAndPrune::Move( ProxyId id, const SDL_Rect &rect )
+{
+  AssertMessage( id < mProxies.size() && mProxies[id].mAlive, "Moving an invalid proxy" );
+  if( id >= mProxies.size() || !mProxies[id].mAlive ){
+    return;
+  }
+  mRects[id] = rect;
+}
+
+/**********************************************************************************************************************/
+
+void SweepAndPrune::Remove( ProxyId id )
+{
+  AssertMessage( id < mProxies.size() && mProxies[id].mAlive, "Removing an invalid proxy" );
+  if( id >= mProxies.size() || !mProxies[id].mAlive ){
+    return;
+  }
+
+  mProxies[id].mAlive = false;
+  mRemoved.push_back( id );
+}
+
+/**********************************************************************************************************************/
+
+void SweepAndPrune::Clear( void )
+{
+  mAxes[0].mEndpoints.clear();
+  mAxes[1].mEndpoints.clear();
+  mProxies.clear();
+  mRects.clear();
+  mFreeProxies.clear();
+  mRemoved.clear();
+  mInserted = 0;
+}
+
+/**********************************************************************************************************************/
+
+void SweepAndPrune::Update( void )
+{
+  // The y axis is sorted on a worker while this thread sorts x. Both only read the proxies
+  JobManager &jobManager = JobManager::GetInstance();
+  jobManager.AddJob( [this]( void ){ UpdateAxis( 1 ); }, &mCounter );
+  UpdateAxis( 0 );
+  jobManager.Wait( mCounter );
+
+  mFreeProxies.insert( mFreeProxies.end(), mRemoved.begin(), mRemoved.end() );
+  mRemoved.clear();
+  mInserted = 0;
+}
+
+/**********************************************************************************************************************/
+
+Uint32 SweepAndPrune::FindPairs( BroadphasePair *pairs, Uint32 capacity )
+{
+  AssertMessage( mInserted == 0 && mRemoved.empty(), "SweepAndPrune::Update must run before FindPairs" );
+
+  // Sweeping the most spread out axis keeps the active list short
+  const std::vector<Endpoint> &endpoints = mAxes[mAxes[1].mVariance > mAxes[0].mVariance ? 1 : 0].mEndpoints;
+
+  mActive.clear();
+  mActiveIndex.resize( mProxies.size() );
+
+  Uint32 count = 0;
+  for( size_t e = 0; e < endpoints.size(); ++e ){
+    const ProxyId proxy = endpoints[e].mProxy;
+
+    if( endpoints[e].mKey & 1 ){
+      // Every open interval overlaps this one on the swept axis
+      const ActiveEntry entry = { mRects[proxy], proxy };
+      for( size_t a = 0; a < mActive.size(); ++a ){
+        const ProxyId other = mActive[a].mProxy;
+        if( RectsOverlap( entry.mRect, mActive[a].mRect ) ){
+          if( count < capacity ){
+            pairs[count].mA = proxy < other ? proxy : other;
+            pairs[count].mB = proxy < other ? other : proxy;
+          }
+          ++count;
+        }
+      }
+      mActiveIndex[proxy] = static_cast<Uint32>( mActive.size() );
+      mActive.push_back( entry );
+    }
+    else{
+      const Uint32 index                  = mActiveIndex[proxy];
+      mActive[index]                      = mActive.back();
+      mActiveIndex[mActive[index].mProxy] = index;
+      mActive.pop_back();
+    }
+  }
+  return count;
+}
+
+/**********************************************************************************************************************/
+
+void SweepAndPrune::UpdateAxis( int axis )
+{
+  std::vector<Endpoint> &endpoints = mAxes[axis].mEndpoints;
+
+  // Refresh the keys from the current rects and drop removed proxies. The order is kept, so the array stays almost
+  // sorted when objects moved a little
+  double  sum         = 0.0;
+  double  sumSquares  = 0.0;
+  size_t  count       = 0;
+  for( size_t read = 0; read < endpoints.size(); ++read ){
+    Endpoint endpoint = endpoints[read];
+    if( !mProxies[endpoint.mProxy].mAlive ){
+      continue;
+    }
+
+    const SDL_Rect &rect  = mRects[endpoint.mProxy];
+    const int       start = axis == 0 ? rect.x : rect.y;
+    const int       size  = axis == 0 ? rect.w : rect.h;
+    if( endpoint.mKey & 1 ){
+      endpoint.mKey = StartKey( start );
+
+      const double center = start + size * 0.5;
+      sum        += center;
+      sumSquares += center * center;
+    }
+    else{
+      endpoint.mKey = EndKey( start, size );
+    }
+    endpoints[count++] = endpoint;
+  }
+  endpoints.resize( count );
+
+  const size_t proxies = count / 2;
+  mAxes[axis].mVariance = proxies > 0 ? sumSquares / proxies - ( sum / proxies ) * ( sum / proxies ) : 0.0;
+
+  // Mass inserts append far from the final position: a full sort is cheaper then
+  Uint32 swaps = 0;
+  if( static_cast<size_t>( mInserted ) * 8 > count ){
+    std::sort( endpoints.begin(), endpoints.end(),
+               []( const Endpoint &a, const Endpoint &b ){ return a.mKey < b.mKey; } );
+  }
+  else{
+    for( size_t i = 1; i < count; ++i ){
+      const Endpoint endpoint = endpoints[i];
+      size_t         j        = i;
+      while( j > 0 && endpoints[j - 1].mKey > endpoint.mKey ){
+        endpoints[j] = endpoints[j - 1];
+        --j;
+      }
+      swaps += static_cast<Uint32>( i - j );
+      endpoints[j] = endpoint;
+    }
+  }
+  mSwapCount[axis] = swaps;
+}
+
+/**********************************************************************************************************************/
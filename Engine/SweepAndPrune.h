@@ -0,0 +1,162 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+// Proxy and pair types
+#include "Broadphase.h"
+
+// Parallel axis sort
+#include "JobManager.h"
+
+// Endpoint arrays
+#include <vector>
+
+/**
+Sweep and prune class
+Broadphase over axis aligned rects keeping the rect endpoints sorted on both axes. Objects that move a little between
+frames barely change the order, so Update fixes the arrays with an insertion sort in close to linear time; the two axes
+are sorted in parallel. FindPairs sweeps the axis where objects are most spread out and reports the same pairs as
+SpatialHashGrid
+*/
+class SweepAndPrune
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Start or end of a rect on one axis
+  */
+  struct Endpoint
+  {
+    Sint64    mKey;     ///< Coordinate * 2 + 1 for starts, so ends sort first on ties and touching rects do not overlap
+    ProxyId   mProxy;   ///< Owner
+  };
+
+  /**
+  Sorted endpoints of one axis
+  */
+  struct Axis
+  {
+    std::vector<Endpoint>   mEndpoints;   ///< Sorted by key after Update
+    double                  mVariance;    ///< Spread of the rect centers, computed by Update
+  };
+
+  /**
+  Object whose interval is open during a sweep. The rect is copied so the inner loop reads contiguous memory
+  */
+  struct ActiveEntry
+  {
+    SDL_Rect  mRect;
+    ProxyId   mProxy;
+  };
+
+  /**
+  Registered object
+  */
+  struct Proxy
+  {
+    Uint64    mUserData;    ///< Caller data, usually an entity key
+    bool      mAlive;       ///< Slot in use
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  SweepAndPrune( void );
+
+  /**
+  Adds a rect. It is sorted into the axes by the next Update
+  @param rect Rect of the object
+  @param userData Caller data returned by GetUserData
+  @return Proxy id of the object
+  */
+  ProxyId Insert( const SDL_Rect &rect, Uint64 userData = 0 );
+
+  /**
+  Changes the rect of an object. Takes effect on the next Update
+  */
+  void Move( ProxyId proxy, const SDL_Rect &rect );
+
+  /**
+  Removes an object. Its endpoints are dropped by the next Update, the id is reused after that
+  */
+  void Remove( ProxyId proxy );
+
+  /**
+  Removes every object
+  */
+  void Clear( void );
+
+  /**
+  Sorts the endpoints of both axes after moves, inserts and removes. Must be called before FindPairs
+  */
+  void Update( void );
+
+  /**
+  Finds every pair of overlapping objects
+  @param pairs Buffer receiving the pairs, preallocated by the caller
+  @param capacity Size of the buffer
+  @return Number of overlapping pairs. Only the first capacity ones are written, call again with a larger buffer if
+  the result is greater than capacity
+  */
+  Uint32 FindPairs( BroadphasePair *pairs, Uint32 capacity );
+
+  /**
+  Getters
+  */
+  inline const SDL_Rect &GetRect( ProxyId proxy ) const {
+    return mRects[proxy];
+  }
+  inline Uint64 GetUserData( ProxyId proxy ) const {
+    return mProxies[proxy].mUserData;
+  }
+  inline Uint32 GetProxyCount( void ) const {
+    return static_cast<Uint32>( mProxies.size() - mFreeProxies.size() - mRemoved.size() );
+  }
+  inline Uint32 GetLastSwapCount( void ) const {
+    return mSwapCount[0] + mSwapCount[1];
+  }
+
+private:
+
+  /**
+  Refreshes, compacts and sorts one axis
+  @param axis 0 for x, 1 for y
+  */
+  void UpdateAxis( int axis );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  Axis                      mAxes[2];       ///< Endpoints along x and y
+  std::vector<Proxy>        mProxies;       ///< Proxies by id
+  std::vector<SDL_Rect>     mRects;         ///< Rects by proxy id
+  std::vector<ProxyId>      mFreeProxies;   ///< Ids free for reuse
+  std::vector<ProxyId>      mRemoved;       ///< Ids removed since the last Update, endpoints still in the axes
+  std::vector<ActiveEntry>  mActive;        ///< Sweep scratch: objects whose interval is open
+  std::vector<Uint32>       mActiveIndex;   ///< Sweep scratch: position of each proxy in mActive
+  Uint32                    mInserted;      ///< Endpoints appended since the last Update
+  Uint32                    mSwapCount[2];  ///< Insertion sort moves of the last Update per axis
+  JobManager::JobCounter    mCounter;       ///< Parallel axis sort
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+// Component access declarations
+#include "EntityWorld.h"
+
+/**
+System class
+Base class for gameplay systems run by the SystemScheduler. Every system declares in its constructor which components
+it reads and writes; the scheduler runs systems concurrently only when their declarations do not conflict.
+Update must only touch the declared components and must not make structural changes to the world
+*/
+class System
+{
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param name Name shown in timing reports
+  */
+  explicit System( const char *name )
+    : mName(name), mReads(0), mWrites(0) { }
+
+  /**
+  Destructor
+  */
+  virtual ~System( void ) { }
+
+  /**
+  Runs the system
+  @param world World holding the entities
+  @param deltaTime Seconds simulated by this update
+  */
+  virtual void Update( EntityWorld &world, float deltaTime ) = 0;
+
+  /**
+  Getters
+  */
+  inline const char *GetName( void ) const {
+    return mName;
+  }
+  inline ComponentMask GetReads( void ) const {
+    return mReads;
+  }
+  inline ComponentMask GetWrites( void ) const {
+    return mWrites;
+  }
+
+  /**
+  Returns true if the two systems cannot run at the same time
+  @param other System to compare with
+  @return True if one writes a component the other reads or writes
+  */
+  inline bool ConflictsWith( const System &other ) const {
+    return ( mWrites & ( other.mReads | other.mWrites ) ) != 0 || ( other.mWrites & mReads ) != 0;
+  }
+
+protected:
+
+  /**
+  Access declarations. Call from the constructor of the derived system
+  */
+  template < class... Components >
+  inline void Reads( void ) {
+    mReads |= EntityWorld::MaskOf<Components...>();
+  }
+  template < class... Components >
+  inline void Writes( void ) {
+    mWrites |= EntityWorld::MaskOf<Components...>();
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+private:
+
+  const char     *mName;    ///< Name for reports
+  ComponentMask   mReads;   ///< Components read
+  ComponentMask   mWrites;  ///< Components written
+};
+
+/**********************************************************************************************************************/
+
+#endif
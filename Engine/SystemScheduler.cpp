@@ -0,0 +1,214 @@
+#include "SystemScheduler.h"
+
+// Timings
+#include <SDL_timer.h>
+
+// Report formatting
+#include <cstdio>
+
+/**********************************************************************************************************************/
+
+SystemScheduler::SystemScheduler( EntityWorld &world )
+  : mWorld(world), mRemaining(NULL), mRuns(0), mGraphDirty(true), mParallel(true)
+{
+}
+
+/**********************************************************************************************************************/
+
+SystemScheduler::~SystemScheduler( void )
+{
+  delete[] mRemaining;
+}
+
+/**********************************************************************************************************************/
+
+void SystemScheduler::AddSystem( System *system )
+{
+  Node node;
+  node.mSystem          = system;
+  node.mDependencyCount = 0;
+  node.mLastTicks       = 0;
+  node.mTotalTicks      = 0;
+  mNodes.push_back( node );
+
+  mGraphDirty = true;
+}
+
+/**********************************************************************************************************************/
+
+void SystemScheduler::Run( float deltaTime )
+{
+  if( mNodes.empty() ){
+    return;
+  }
+  if( mGraphDirty ){
+    BuildGraph();
+  }
+
+  if( !mParallel ){
+    // Registration order is a valid topological order
+    for( unsigned i = 0; i < mNodes.size(); ++i ){
+      Node   &node  = mNodes[i];
+      Uint64  start = SDL_GetPerformanceCounter();
+
+      const EntityCommandBuffer::Source previous = mCommands.SetSource( EntityCommandBuffer::Source( i ) );
+      node.mSystem->Update( mWorld, deltaTime );
+      mCommands.SetSource( previous );
+      node.mLastTicks   = SDL_GetPerformanceCounter() - start;
+      node.mTotalTicks += node.mLastTicks;
+    }
+  }
+  else{
+    for( unsigned i = 0; i < mNodes.size(); ++i ){
+      mRemaining[i].store( mNodes[i].mDependencyCount );
+    }
+
+    // Roots start right away, the rest are queued by the node that completes their dependencies
+    JobManager &jobManager = JobManager::GetInstance();
+    for( unsigned i = 0; i < mNodes.size(); ++i ){
+      if( mNodes[i].mDependencyCount == 0 ){
+        jobManager.AddJob( [this, i, deltaTime]( void ){ RunNode( i, deltaTime ); }, &mCounter );
+      }
+    }
+    jobManager.Wait( mCounter );
+  }
+
+  // Sync point: no system is iterating anymore
+  mCommands.Playback( mWorld );
+
+  ++mRuns;
+}
+
+/**********************************************************************************************************************/
+
+float SystemScheduler::GetAverageMilliseconds( size_t index ) const
+{
+  if( mRuns == 0 ){
+    return 0.0f;
+  }
+  return static_cast<float>( mNodes[index].mTotalTicks * 1000.0 / SDL_GetPerformanceFrequency() / mRuns );
+}
+
+/**********************************************************************************************************************/
+
+std::vector<size_t> SystemScheduler::GetCriticalPath( float &milliseconds ) const
+{
+  std::vector<size_t> path;
+  milliseconds = 0.0f;
+  if( mNodes.empty() ){
+    return path;
+  }
+
+  // Longest path ending at each node. Dependencies always have lower indices, so one forward pass is enough
+  std::vector<float>  finish( mNodes.size(), 0.0f );
+  std::vector<size_t> previous( mNodes.size(), mNodes.size() );
+  for( size_t i = 0; i < mNodes.size(); ++i ){
+    finish[i] += GetAverageMilliseconds( i );
+    for( size_t d = 0; d < mNodes[i].mDependents.size(); ++d ){
+      size_t dependent = mNodes[i].mDependents[d];
+      if( finish[i] > finish[dependent] || previous[dependent] == mNodes.size() ){
+        finish[dependent]   = finish[i];
+        previous[dependent] = i;
+      }
+    }
+  }
+
+  size_t last = 0;
+  for( size_t i = 1; i < mNodes.size(); ++i ){
+    if( finish[i] > finish[last] ){
+      last = i;
+    }
+  }
+  milliseconds = finish[last];
+
+  for( size_t node = last; node != mNodes.size(); node = previous[node] ){
+    path.insert( path.begin(), node );
+  }
+  return path;
+}
+
+/**********************************************************************************************************************/
+
+std::string SystemScheduler::GetReport( void ) const
+{
+  std::string report;
+  char        line[256];
+
+  for( size_t i = 0; i < mNodes.size(); ++i ){
+    snprintf( line, sizeof(line), "%-24s %8.3f ms\n", mNodes[i].mSystem->GetName(), GetAverageMilliseconds( i ) );
+    report += line;
+  }
+
+  float               criticalMilliseconds;
+  std::vector<size_t> criticalPath = GetCriticalPath( criticalMilliseconds );
+
+  report += "Critical path:";
+  for( size_t i = 0; i < criticalPath.size(); ++i ){
+    report += i ? " -> " : " ";
+    report += mNodes[criticalPath[i]].mSystem->GetName();
+  }
+  snprintf( line, sizeof(line), " (%.3f ms)\n", criticalMilliseconds );
+  report += line;
+
+  return report;
+}
+
+/**********************************************************************************************************************/
+
+void SystemScheduler::ResetStats( void )
+{
+  for( size_t i = 0; i < mNodes.size(); ++i ){
+    mNodes[i].mTotalTicks = 0;
+  }
+  mRuns = 0;
+}
+
+/**********************************************************************************************************************/
+
+void SystemScheduler::BuildGraph( void )
+{
+  for( size_t i = 0; i < mNodes.size(); ++i ){
+    mNodes[i].mDependents.clear();
+    mNodes[i].mDependencyCount = 0;
+  }
+
+  for( unsigned j = 1; j < mNodes.size(); ++j ){
+    for( unsigned i = 0; i < j; ++i ){
+      if( mNodes[i].mSystem->ConflictsWith( *mNodes[j].mSystem ) ){
+        mNodes[i].mDependents.push_back( j );
+        ++mNodes[j].mDependencyCount;
+      }
+    }
+  }
+
+  delete[] mRemaining;
+  mRemaining  = new std::atomic<unsigned>[mNodes.size()];
+  mGraphDirty = false;
+}
+
+/**********************************************************************************************************************/
+
+void SystemScheduler::RunNode( unsigned index, float deltaTime )
+{
+  Node   &node  = mNodes[index];
+  Uint64  start = SDL_GetPerformanceCounter();
+
+  // Commands are ordered by system, not by thread. A system nested in a Wait of another on this thread gets its own
+  // source and hands the thread back
+  const EntityCommandBuffer::Source previous = mCommands.SetSource( EntityCommandBuffer::Source( index ) );
+  node.mSystem->Update( mWorld, deltaTime );
+  mCommands.SetSource( previous );
+  node.mLastTicks   = SDL_GetPerformanceCounter() - start;
+  node.mTotalTicks += node.mLastTicks;
+
+  // The last dependency to finish queues the dependent
+  for( size_t d = 0; d < node.mDependents.size(); ++d ){
+    unsigned dependent = node.mDependents[d];
+    if( --mRemaining[dependent] == 0 ){
+      JobManager::GetInstance().AddJob( [this, dependent, deltaTime]( void ){ RunNode( dependent, deltaTime ); },
+                                        &mCounter );
+    }
+  }
+}
+
+/**********************************************************************************************************************/
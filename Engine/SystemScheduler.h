@@ -0,0 +1,167 @@
+#ifndef SYSTEMSCHEDULER_H
+#define SYSTEMSCHEDULER_H
+
+// Scheduled systems
+#include "System.h"
+
+// Deferred structural changes
+#include "EntityCommandBuffer.h"
+
+// Parallel execution
+#include "JobManager.h"
+
+// Graph storage
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+System scheduler class
+Builds a dependency graph from the component access declared by each system: a system depends on every earlier
+registered system it conflicts with. Systems whose dependencies are done run concurrently on the JobManager, so
+conflicting systems always run in registration order and results do not depend on thread timing.
+Systems record structural changes in the scheduler command buffer, tagged with their registration index; they are
+played back once every system finished, in registration order.
+Keeps per-system timings and the critical path of the graph
+*/
+class SystemScheduler
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+private:
+
+  /**
+  Graph node of a system
+  */
+  struct Node
+  {
+    System                *mSystem;           ///< Scheduled system, not owned
+    std::vector<unsigned>  mDependents;       ///< Nodes waiting for this one
+    unsigned               mDependencyCount;  ///< Nodes this one waits for
+    Uint64                 mLastTicks;        ///< Duration of the last run in performance counter ticks
+    Uint64                 mTotalTicks;       ///< Accumulated duration since the last ResetStats
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  @param world World passed to every system
+  */
+  explicit SystemScheduler( EntityWorld &world );
+
+  /**
+  Destructor
+  */
+  ~SystemScheduler( void );
+
+  /**
+  Adds a system after the already added ones. The graph is rebuilt on the next Run
+  @param system System to schedule. Not owned, must outlive the scheduler
+  */
+  void AddSystem( System *system );
+
+  /**
+  Runs every system once, waits for all of them and plays back the command buffer
+  @param deltaTime Seconds simulated by this update
+  */
+  void Run( float deltaTime );
+
+  /**
+  Set and get for parallel execution. When disabled systems run one after another in registration order on the
+  calling thread, which gives the same results
+  */
+  inline bool GetParallel( void ) const {
+    return mParallel;
+  }
+  inline void SetParallel( bool parallel ){
+    mParallel = parallel;
+  }
+
+  /**
+  Returns the average duration of a system since the last ResetStats
+  @param index System index in registration order
+  @return Milliseconds
+  */
+  float GetAverageMilliseconds( size_t index ) const;
+
+  /**
+  Returns the systems of the longest dependency chain by average duration
+  @param milliseconds Returns the average duration of the chain
+  @return Indices of the systems on the critical path in execution order
+  */
+  std::vector<size_t> GetCriticalPath( float &milliseconds ) const;
+
+  /**
+  Returns a printable report with the average time of every system and the critical path
+  @return Report text
+  */
+  std::string GetReport( void ) const;
+
+  /**
+  Resets timing statistics
+  */
+  void ResetStats( void );
+
+  /**
+  Getters
+  */
+  inline size_t GetSystemCount( void ) const {
+    return mNodes.size();
+  }
+  inline const System &GetSystem( size_t index ) const {
+    return *mNodes[index].mSystem;
+  }
+  inline EntityCommandBuffer &GetCommandBuffer( void ) {
+    return mCommands;
+  }
+
+private:
+
+  // Non copyable: jobs reference the scheduler
+  SystemScheduler( const SystemScheduler & );
+  SystemScheduler &operator=( const SystemScheduler & );
+
+  /**
+  Builds the dependency graph from the access declarations
+  */
+  void BuildGraph( void );
+
+  /**
+  Runs a system and queues its dependents that became ready. Runs on any thread
+  @param index Node to run
+  @param deltaTime Seconds simulated by this update
+  */
+  void RunNode( unsigned index, float deltaTime );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  EntityWorld                &mWorld;           ///< World passed to every system
+  std::vector<Node>           mNodes;           ///< Systems in registration order
+  std::atomic<unsigned>      *mRemaining;       ///< Per node dependencies not finished during the current run
+  JobManager::JobCounter      mCounter;         ///< Jobs of the current run
+  EntityCommandBuffer         mCommands;        ///< Structural changes recorded by systems during the current run
+  Uint32                      mRuns;            ///< Runs since the last ResetStats
+  bool                        mGraphDirty;      ///< Graph must be rebuilt before the next run
+  bool                        mParallel;        ///< Run on the JobManager
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,330 @@
+#include "TextureManager.h"
+
+// Decoding runs on workers
+#include "JobManager.h"
+
+/**********************************************************************************************************************/
+
+const float TextureManager::DEFAULT_UPLOAD_BUDGET = 2.0f;
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureManager( void )
+  : mUploadBudget(DEFAULT_UPLOAD_BUDGET)
+{
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::~TextureManager( void )
+{
+  // Textures must have been released with the renderer alive. Only free the remaining surfaces here
+  for( size_t i = 0; i < mDecoded.size(); ++i ){
+    SDL_FreeSurface( mDecoded[i].mSurface );
+    delete mDecoded[i].mMask;
+  }
+  for( size_t i = 0; i < mEntries.size(); ++i ){
+    FreeSurface( mEntries[i] );
+    delete mEntries[i].mMask;
+  }
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureId TextureManager::LoadTextureAsync( const std::string &path, bool keepSurface, bool buildMask )
+{
+  TextureId id = AllocateEntry( path, keepSurface, buildMask );
+  QueueDecode( id, FileData(), NULL, 0 );
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureId TextureManager::LoadTextureFromMemoryAsync( const std::string &path, std::vector<Uint8> &data,
+                                                                      bool keepSurface, bool buildMask )
+{
+  FileData contents( new std::vector<Uint8>() );
+  contents->swap( data );
+
+  TextureId id = AllocateEntry( path, keepSurface, buildMask );
+  if( contents->empty() ){
+    mEntries[id].mState = TEXTURE_STATE_FAILED;
+    return id;
+  }
+  QueueDecode( id, contents, &( *contents )[0], contents->size() );
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureId TextureManager::LoadTextureFromMemoryAsync( const std::string &path, const Uint8 *data,
+                                                                      size_t size, bool keepSurface, bool buildMask )
+{
+  TextureId id = AllocateEntry( path, keepSurface, buildMask );
+  if( data == NULL || size == 0 ){
+    mEntries[id].mState = TEXTURE_STATE_FAILED;
+    return id;
+  }
+  QueueDecode( id, FileData(), data, size );
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureId TextureManager::AllocateEntry( const std::string &path, bool keepSurface, bool buildMask )
+{
+  // Reuse a released slot if possible
+  TextureId id;
+  if( !mFreeIds.empty() ){
+    id = mFreeIds.back();
+    mFreeIds.pop_back();
+  }
+  else{
+    id = static_cast<TextureId>( mEntries.size() );
+    mEntries.push_back( TextureEntry() );
+  }
+
+  TextureEntry &entry = mEntries[id];
+  entry.mPath         = path;
+  entry.mState        = TEXTURE_STATE_LOADING;
+  entry.mKeepSurface  = keepSurface;
+  entry.mBuildMask    = buildMask;
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::ReloadTextureAsync( TextureId id )
+{
+  if( !IsValidId( id ) || mEntries[id].mState == TEXTURE_STATE_FREE ){
+    return;
+  }
+
+  // Keep READY state so the old texture is drawn until the new one is uploaded
+  if( mEntries[id].mTexture == NULL ){
+    mEntries[id].mState = TEXTURE_STATE_LOADING;
+  }
+  QueueDecode( id, FileData(), NULL, 0 );
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::ProcessUploads( SDL_Renderer *renderer )
+{
+  const Uint64 start  = SDL_GetPerformanceCounter();
+  const Uint64 budget = static_cast<Uint64>( mUploadBudget * 0.001 * SDL_GetPerformanceFrequency() );
+
+  do{
+    DecodedImage image;
+    {
+      std::lock_guard<std::mutex> lock( mDecodedMutex );
+      if( mDecoded.empty() ){
+        return;
+      }
+      image = mDecoded.front();
+      mDecoded.pop_front();
+    }
+
+    Upload( renderer, image );
+  }while( SDL_GetPerformanceCounter() - start < budget );
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::ReleaseTexture( TextureId id )
+{
+  if( !IsValidId( id ) || mEntries[id].mState == TEXTURE_STATE_FREE ){
+    return;
+  }
+
+  TextureEntry &entry = mEntries[id];
+  if( entry.mTexture ){
+    SDL_DestroyTexture( entry.mTexture );
+  }
+  FreeSurface( entry );
+  delete entry.mMask;
+
+  // Keep the request serial so in-flight decodes for the old slot are recognized as stale
+  unsigned request = entry.mRequest + 1;
+  entry            = TextureEntry();
+  entry.mRequest   = request;
+
+  mFreeIds.push_back( id );
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::ReleaseAll( void )
+{
+  for( TextureId id = 0; id < static_cast<TextureId>( mEntries.size() ); ++id ){
+    ReleaseTexture( id );
+  }
+}
+
+/**********************************************************************************************************************/
+
+SDL_Texture *TextureManager::GetTexture( TextureId id ) const
+{
+  return IsValidId( id ) ? mEntries[id].mTexture : NULL;
+}
+
+/**********************************************************************************************************************/
+
+SDL_Surface *TextureManager::GetSurface( TextureId id ) const
+{
+  return IsValidId( id ) ? mEntries[id].mSurface : NULL;
+}
+
+/**********************************************************************************************************************/
+
+const CollisionMask *TextureManager::GetCollisionMask( TextureId id ) const
+{
+  return IsValidId( id ) ? mEntries[id].mMask : NULL;
+}
+
+/**********************************************************************************************************************/
+
+TextureManager::TextureState TextureManager::GetState( TextureId id ) const
+{
+  return IsValidId( id ) ? mEntries[id].mState : TEXTURE_STATE_FREE;
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::AddSurfaceListener( SurfaceListener function, void *userData )
+{
+  SurfaceListenerEntry listener = { function, userData };
+  mSurfaceListeners.push_back( listener );
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::RemoveSurfaceListener( SurfaceListener function, void *userData )
+{
+  for( size_t i = 0; i < mSurfaceListeners.size(); ++i ){
+    if( mSurfaceListeners[i].mFunction == function && mSurfaceListeners[i].mUserData == userData ){
+      mSurfaceListeners.erase( mSurfaceListeners.begin() + i );
+      return;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+size_t TextureManager::GetPendingUploadCount( void )
+{
+  std::lock_guard<std::mutex> lock( mDecodedMutex );
+  return mDecoded.size();
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::QueueDecode( TextureId id, const FileData &owner, const Uint8 *data, size_t size )
+{
+  TextureEntry &entry = mEntries[id];
+  ++entry.mRequest;
+
+  // Workers only get copies: slots may be reallocated while they decode
+  std::string path      = entry.mPath;
+  unsigned    request   = entry.mRequest;
+  bool        buildMask = entry.mBuildMask;
+
+  JobManager::GetInstance().AddJob( [this, id, request, path, buildMask, owner, data, size]( void ){
+    DecodedImage image;
+    image.mId       = id;
+    image.mRequest  = request;
+    image.mSurface  = DecodeImage( path, data, size );
+    image.mMask     = buildMask && image.mSurface ? new CollisionMask( image.mSurface ) : NULL;
+
+    std::lock_guard<std::mutex> lock( mDecodedMutex );
+    mDecoded.push_back( image );
+  } );
+}
+
+/**********************************************************************************************************************/
+
+SDL_Surface *TextureManager::DecodeImage( const std::string &path, const Uint8 *data, size_t size )
+{
+  SDL_Surface *loaded = data == NULL ? SDL_LoadBMP( path.c_str() ) :
+                                       SDL_LoadBMP_RW( SDL_RWFromConstMem( data, static_cast<int>( size ) ), 1 );
+  if( loaded == NULL ){
+    return NULL;
+  }
+
+  // Convert to the format renderers use natively so texture creation is a plain copy
+  SDL_Surface *converted = SDL_ConvertSurfaceFormat( loaded, SDL_PIXELFORMAT_ARGB8888, 0 );
+  SDL_FreeSurface( loaded );
+  return converted;
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::Upload( SDL_Renderer *renderer, const DecodedImage &image )
+{
+  // Drop decodes of released or reloaded slots
+  if( !IsValidId( image.mId ) || mEntries[image.mId].mRequest != image.mRequest ){
+    SDL_FreeSurface( image.mSurface );
+    delete image.mMask;
+    return;
+  }
+
+  TextureEntry &entry = mEntries[image.mId];
+  if( image.mSurface == NULL ){
+    // Keep showing the previous texture on failed reloads
+    if( entry.mTexture == NULL ){
+      entry.mState = TEXTURE_STATE_FAILED;
+    }
+    return;
+  }
+
+  // Update in place when the existing texture matches, otherwise create a new one
+  Uint32  format;
+  int     width;
+  int     height;
+  if( entry.mTexture
+      && SDL_QueryTexture( entry.mTexture, &format, NULL, &width, &height ) == 0
+      && format == image.mSurface->format->format && width == image.mSurface->w && height == image.mSurface->h ){
+    SDL_UpdateTexture( entry.mTexture, NULL, image.mSurface->pixels, image.mSurface->pitch );
+  }
+  else{
+    SDL_Texture *texture = SDL_CreateTextureFromSurface( renderer, image.mSurface );
+    if( texture ){
+      if( entry.mTexture ){
+        SDL_DestroyTexture( entry.mTexture );
+      }
+      entry.mTexture = texture;
+    }
+  }
+  entry.mState = entry.mTexture ? TEXTURE_STATE_READY : TEXTURE_STATE_FAILED;
+
+  // Reloads replace the mask along with the texture
+  if( image.mMask ){
+    delete entry.mMask;
+    entry.mMask = image.mMask;
+  }
+
+  // Keep the surface only for software rendering
+  FreeSurface( entry );
+  if( entry.mKeepSurface ){
+    entry.mSurface = image.mSurface;
+  }
+  else{
+    SDL_FreeSurface( image.mSurface );
+  }
+}
+
+/**********************************************************************************************************************/
+
+void TextureManager::FreeSurface( TextureEntry &entry )
+{
+  if( entry.mSurface == NULL ){
+    return;
+  }
+  for( size_t i = 0; i < mSurfaceListeners.size(); ++i ){
+    mSurfaceListeners[i].mFunction( entry.mSurface, mSurfaceListeners[i].mUserData );
+  }
+  SDL_FreeSurface( entry.mSurface );
+  entry.mSurface = NULL;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,289 @@
+#ifndef TEXTUREMANAGER_H
+#define TEXTUREMANAGER_H
+
+#include "Singleton.h"
+
+// Masks built while decoding
+#include "CollisionMask.h"
+
+// SDL textures and surfaces
+#include <SDL.h>
+
+// Texture storage
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Ready queue shared with workers
+#include <mutex>
+
+/**
+Texture manager class
+Loads textures asynchronously: image decode and pixel format conversion run on JobManager workers and finished surfaces
+wait in a queue until the render thread turns them into SDL_Textures under a per-frame time budget
+*/
+class TextureManager : public Singleton <TextureManager>
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  // Allow constructor calling only from Singleton
+  friend class Singleton <TextureManager>;
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const int    INVALID_TEXTURE_ID    = -1;     ///< Id returned when no texture could be requested
+  static const float  DEFAULT_UPLOAD_BUDGET;          ///< Default milliseconds per frame spent creating textures
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  typedef int TextureId;
+
+  /**
+  Function called before a kept surface is freed, see AddSurfaceListener
+  @param surface Surface about to be freed
+  @param userData Pointer given at registration
+  */
+  typedef void ( *SurfaceListener )( const SDL_Surface *surface, void *userData );
+
+  /**
+  Lifetime of a texture slot
+  */
+  enum TextureState
+  {
+    TEXTURE_STATE_FREE,       ///< Slot not in use
+    TEXTURE_STATE_LOADING,    ///< Decoding on a worker or waiting for upload
+    TEXTURE_STATE_READY,      ///< Texture created and usable
+    TEXTURE_STATE_FAILED      ///< File could not be loaded or texture could not be created
+  };
+
+private:
+
+  /**
+  Texture slot. Only accessed from the render thread
+  */
+  struct TextureEntry
+  {
+    std::string     mPath;          ///< File the texture is loaded from
+    SDL_Texture    *mTexture;       ///< Uploaded texture, NULL until ready
+    SDL_Surface    *mSurface;       ///< Decoded surface, kept only if requested
+    CollisionMask  *mMask;          ///< Collision mask, built only if requested
+    TextureState    mState;         ///< Current state
+    unsigned        mRequest;       ///< Serial of the last request. Stale decodes are dropped
+    bool            mKeepSurface;   ///< Keep the decoded surface after upload (software rendering)
+    bool            mBuildMask;     ///< Build a collision mask from the alpha channel when decoding
+
+    TextureEntry( void )
+      : mTexture(NULL), mSurface(NULL), mMask(NULL), mState(TEXTURE_STATE_FREE), mRequest(0), mKeepSurface(false),
+        mBuildMask(false) { }
+  };
+
+  /**
+  Registered surface listener
+  */
+  struct SurfaceListenerEntry
+  {
+    SurfaceListener   mFunction;
+    void             *mUserData;
+  };
+
+  /**
+  File contents shared with the decode job
+  */
+  typedef std::shared_ptr< std::vector<Uint8> > FileData;
+
+  /**
+  Decode result waiting for upload
+  */
+  struct DecodedImage
+  {
+    TextureId       mId;            ///< Destination slot
+    unsigned        mRequest;       ///< Request serial the decode belongs to
+    SDL_Surface    *mSurface;       ///< Converted surface, NULL if decoding failed
+    CollisionMask  *mMask;          ///< Mask built from the surface, NULL if not requested
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Requests a texture load. Decoding starts immediately on a worker thread
+  @param path Path of the BMP file to load
+  @param keepSurface Keep the decoded surface available through GetSurface after upload
+  @param buildMask Build a collision mask from the alpha channel on the worker, available through GetCollisionMask
+  @return Id of the texture. Usable once its state is TEXTURE_STATE_READY
+  */
+  TextureId LoadTextureAsync( const std::string &path, bool keepSurface = false, bool buildMask = false );
+
+  /**
+  Requests a texture from a file already read, such as one streamed by AssetStreamer. Only decoding runs on the worker
+  @param path Path the data was read from. Reloads read it again
+  @param data BMP file contents. Swapped out, the vector is left empty
+  @param keepSurface See LoadTextureAsync
+  @param buildMask See LoadTextureAsync
+  @return Id of the texture. Usable once its state is TEXTURE_STATE_READY
+  */
+  TextureId LoadTextureFromMemoryAsync( const std::string &path, std::vector<Uint8> &data, bool keepSurface = false,
+                                        bool buildMask = false );
+
+  /**
+  Requests a texture from memory that is not copied, such as an asset in a mapped AssetArchive. The memory must stay
+  valid until the decode jobs are done, see JobManager::WaitForAll
+  @param path Path the data comes from. Reloads read it
+  @param data BMP file contents
+  @param size Size of the contents
+  @param keepSurface See LoadTextureAsync
+  @param buildMask See LoadTextureAsync
+  @return Id of the texture. Usable once its state is TEXTURE_STATE_READY
+  */
+  TextureId LoadTextureFromMemoryAsync( const std::string &path, const Uint8 *data, size_t size,
+                                        bool keepSurface = false, bool buildMask = false );
+
+  /**
+  Reloads a texture from its file. The current texture stays usable and is updated in place when size matches
+  @param id Texture to reload
+  */
+  void ReloadTextureAsync( TextureId id );
+
+  /**
+  Creates or updates textures for decoded images until the frame budget is spent. Call once per frame on the render
+  thread. At least one image is processed per call so loading always progresses
+  @param renderer Renderer owning the textures
+  */
+  void ProcessUploads( SDL_Renderer *renderer );
+
+  /**
+  Releases a texture and its slot. Pending decodes for it are discarded
+  @param id Texture to release
+  */
+  void ReleaseTexture( TextureId id );
+
+  /**
+  Releases every texture. Must be called before the renderer is destroyed
+  */
+  void ReleaseAll( void );
+
+  /**
+  Set and get for the per-frame upload budget in milliseconds
+  */
+  inline float GetUploadBudget( void ) const {
+    return mUploadBudget;
+  }
+  inline void SetUploadBudget( float milliseconds ){
+    mUploadBudget = milliseconds;
+  }
+
+  /**
+  Getters for texture slots. Invalid ids return NULL and TEXTURE_STATE_FREE
+  */
+  SDL_Texture  *GetTexture( TextureId id ) const;
+  SDL_Surface  *GetSurface( TextureId id ) const;
+  TextureState  GetState  ( TextureId id ) const;
+
+  /**
+  Returns the collision mask of a texture, NULL if it was not requested or the texture is not ready
+  */
+  const CollisionMask *GetCollisionMask( TextureId id ) const;
+
+  /**
+  Registers a function called before every kept surface is freed, by a release or by a reload replacing it. Caches
+  keyed on surface pointers drop their entries there, before another surface can be allocated at the same address
+  @param function Function to call
+  @param userData Pointer passed to the function
+  */
+  void AddSurfaceListener( SurfaceListener function, void *userData );
+
+  /**
+  Unregisters a function registered with the same user data
+  */
+  void RemoveSurfaceListener( SurfaceListener function, void *userData );
+
+  /**
+  Returns the number of decoded images waiting for upload
+  @return Images waiting for the render thread
+  */
+  size_t GetPendingUploadCount( void );
+
+private:
+
+  // Constructor and destructor private for singleton (only one instance can be created)
+  /**
+  Private constructor for TextureManager singleton
+  */
+  TextureManager( void );
+
+  /**
+  Private destructor for TextureManager singleton
+  */
+  /*virtual*/ ~TextureManager( void ); // Avoid virtual if not strictly necessary (Singletons don't use inheritance)
+
+  /**
+  Takes a free slot and sets it up for loading
+  @return Id of the slot
+  */
+  TextureId AllocateEntry( const std::string &path, bool keepSurface, bool buildMask );
+
+  /**
+  Queues the decode of a slot on a worker thread
+  @param id Slot to decode into
+  @param owner Keeps the contents alive until decoded, empty for memory the caller keeps valid
+  @param data File contents to decode, NULL to read the file of the slot
+  @param size Size of the contents
+  */
+  void QueueDecode( TextureId id, const FileData &owner, const Uint8 *data, size_t size );
+
+  /**
+  Decodes and converts an image. Runs on a worker thread
+  @param path File to load when data is NULL
+  @param data File contents, or NULL
+  @param size Size of the contents
+  @return Surface in the upload pixel format or NULL on failure
+  */
+  static SDL_Surface *DecodeImage( const std::string &path, const Uint8 *data, size_t size );
+
+  /**
+  Creates or updates the texture of a slot from a decoded image. Runs on the render thread
+  @param renderer Renderer owning the textures
+  @param image Decoded image. Its surface ownership is taken
+  */
+  void Upload( SDL_Renderer *renderer, const DecodedImage &image );
+
+  /**
+  Notifies the surface listeners and frees the kept surface of a slot
+  @param entry Slot whose surface is freed
+  */
+  void FreeSurface( TextureEntry &entry );
+
+  /**
+  Returns true if the id references an existing slot
+  */
+  inline bool IsValidId( TextureId id ) const {
+    return id >= 0 && id < static_cast<TextureId>( mEntries.size() );
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<TextureEntry>           mEntries;           ///< Texture slots indexed by id
+  std::vector<TextureId>              mFreeIds;           ///< Released slots for reuse
+  std::deque<DecodedImage>            mDecoded;           ///< Decoded images waiting for upload
+  std::mutex                          mDecodedMutex;      ///< Protects mDecoded
+  float                               mUploadBudget;      ///< Milliseconds per frame spent in ProcessUploads
+  std::vector<SurfaceListenerEntry>   mSurfaceListeners;  ///< Called before a kept surface is freed
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,260 @@
+#include "TileCollisionMap.h"
+
+// Invalid size checks
+#include "AssertionManager.h"
+
+// Lowest and highest set bits
+#include "BitScan.h"
+
+/**********************************************************************************************************************/
+
+// Bits first to last of a word, both included and in [0, 63]
+static inline Uint64 BitRange( int first, int last )
+{
+  return ( ~static_cast<Uint64>( 0 ) << first ) & ( ~static_cast<Uint64>( 0 ) >> ( 63 - last ) );
+}
+
+/**********************************************************************************************************************/
+
+TileCollisionMap::TileCollisionMap( int width, int height, int tileSize )
+  : mWidth(width), mHeight(height), mWordsPerRow(( width + WORD_BITS - 1 ) / WORD_BITS), mTileSize(tileSize),
+    mTileShift(-1)
+{
+  AssertMessage( width > 0 && height > 0 && tileSize > 0, "Tile collision map sizes must be positive" );
+  mBits.resize( static_cast<size_t>( mWordsPerRow ) * height, 0 );
+
+  // Power of two sizes turn pixel to tile conversions into shifts
+  if( ( tileSize & ( tileSize - 1 ) ) == 0 ){
+    mTileShift = 0;
+    while( ( 1 << mTileShift ) < tileSize ){
+      ++mTileShift;
+    }
+  }
+}
+
+/**********************************************************************************************************************/
+
+void TileCollisionMap::SetSolid( int tileX, int tileY, bool solid )
+{
+  if( tileX < 0 || tileY < 0 || tileX >= mWidth || tileY >= mHeight ){
+    return;
+  }
+
+  Uint64      &word = mBits[static_cast<size_t>( tileY ) * mWordsPerRow + tileX / WORD_BITS];
+  const Uint64 bit  = static_cast<Uint64>( 1 ) << ( tileX % WORD_BITS );
+  word = solid ? word | bit : word & ~bit;
+}
+
+/**********************************************************************************************************************/
+
+bool TileCollisionMap::IsSolid( int tileX, int tileY ) const
+{
+  if( tileX < 0 || tileY < 0 || tileX >= mWidth || tileY >= mHeight ){
+    return false;
+  }
+  return ( mBits[static_cast<size_t>( tileY ) * mWordsPerRow + tileX / WORD_BITS] >> ( tileX % WORD_BITS ) ) & 1;
+}
+
+/**********************************************************************************************************************/
+
+bool TileCollisionMap::Overlaps( float x, float y, float w, float h ) const
+{
+  return FindFirstColumn( FirstTile( y ), LastTile( y, h ), FirstTile( x ), LastTile( x, w ) ) >= 0;
+}
+
+/**********************************************************************************************************************/
+
+TileCollisionMap::MoveResult TileCollisionMap::Move( float x, float y, float w, float h, float dx, float dy ) const
+{
+  MoveResult result = { x + dx, y, false, false };
+
+  // Horizontal: only the columns the front side enters are tested, all the rows of the box at once
+  const int firstRow  = FirstTile( y );
+  const int lastRow   = LastTile( y, h );
+  int       firstColumn = FirstTile( x );
+  int       lastColumn  = LastTile( x, w );
+  if( dx > 0.0f ){
+    const int column = FindFirstColumn( firstRow, lastRow, lastColumn + 1, LastTile( result.mX, w ) );
+    if( column >= 0 ){
+      result.mX     = static_cast<float>( column * mTileSize ) - w;
+      result.mHitX  = true;
+    }
+  }
+  else if( dx < 0.0f ){
+    const int column = FindLastColumn( firstRow, lastRow, FirstTile( result.mX ), firstColumn - 1 );
+    if( column >= 0 ){
+      result.mX     = static_cast<float>( ( column + 1 ) * mTileSize );
+      result.mHitX  = true;
+    }
+  }
+
+  // Vertical, at the new horizontal position: rows are tested in the direction of the movement and the first one
+  // with a solid tile under the box stops it. Rows outside the map are empty and skipped
+  result.mY = y + dy;
+  if( result.mX != x ){
+    firstColumn = FirstTile( result.mX );
+    lastColumn  = LastTile( result.mX, w );
+  }
+  if( dy > 0.0f ){
+    const int row = FindFirstRow( lastRow + 1, LastTile( result.mY, h ), firstColumn, lastColumn );
+    if( row >= 0 ){
+      result.mY     = static_cast<float>( row * mTileSize ) - h;
+      result.mHitY  = true;
+    }
+  }
+  else if( dy < 0.0f ){
+    const int row = FindLastRow( FirstTile( result.mY ), firstRow - 1, firstColumn, lastColumn );
+    if( row >= 0 ){
+      result.mY     = static_cast<float>( ( row + 1 ) * mTileSize );
+      result.mHitY  = true;
+    }
+  }
+
+  return result;
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::FindFirstColumn( int firstRow, int lastRow, int firstColumn, int lastColumn ) const
+{
+  if( !ClampSpan( firstRow, lastRow, firstColumn, lastColumn ) ){
+    return -1;
+  }
+
+  // The masked words of every row are merged, so one scan finds the first column blocked in any of them
+  for( int word = firstColumn / WORD_BITS, lastWord = lastColumn / WORD_BITS; word <= lastWord; ++word ){
+    const int     base  = word * WORD_BITS;
+    const Uint64  mask  = BitRange( SDL_max( firstColumn - base, 0 ), SDL_min( lastColumn - base, WORD_BITS - 1 ) );
+    const Uint64 *bits  = &mBits[static_cast<size_t>( firstRow ) * mWordsPerRow + word];
+    Uint64        found = 0;
+    for( int row = firstRow; row <= lastRow; ++row, bits += mWordsPerRow ){
+      found |= *bits;
+    }
+    found &= mask;
+    if( found ){
+      return base + LowestBit( found );
+    }
+  }
+  return -1;
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::FindLastColumn( int firstRow, int lastRow, int firstColumn, int lastColumn ) const
+{
+  if( !ClampSpan( firstRow, lastRow, firstColumn, lastColumn ) ){
+    return -1;
+  }
+
+  for( int word = lastColumn / WORD_BITS, firstWord = firstColumn / WORD_BITS; word >= firstWord; --word ){
+    const int     base  = word * WORD_BITS;
+    const Uint64  mask  = BitRange( SDL_max( firstColumn - base, 0 ), SDL_min( lastColumn - base, WORD_BITS - 1 ) );
+    const Uint64 *bits  = &mBits[static_cast<size_t>( firstRow ) * mWordsPerRow + word];
+    Uint64        found = 0;
+    for( int row = firstRow; row <= lastRow; ++row, bits += mWordsPerRow ){
+      found |= *bits;
+    }
+    found &= mask;
+    if( found ){
+      return base + HighestBit( found );
+    }
+  }
+  return -1;
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::FindFirstRow( int firstRow, int lastRow, int firstColumn, int lastColumn ) const
+{
+  if( !ClampSpan( firstRow, lastRow, firstColumn, lastColumn ) ){
+    return -1;
+  }
+
+  // The masks only depend on the columns, so they are built once for every row crossed
+  const int     firstWord = firstColumn / WORD_BITS;
+  const int     lastWord  = lastColumn / WORD_BITS;
+  const Uint64  firstMask = BitRange( firstColumn - firstWord * WORD_BITS, firstWord == lastWord ?
+                                      lastColumn - firstWord * WORD_BITS : WORD_BITS - 1 );
+  const Uint64  lastMask  = BitRange( 0, lastColumn - lastWord * WORD_BITS );
+  for( int row = firstRow; row <= lastRow; ++row ){
+    if( RowHasSolid( row, firstWord, lastWord, firstMask, lastMask ) ){
+      return row;
+    }
+  }
+  return -1;
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::FindLastRow( int firstRow, int lastRow, int firstColumn, int lastColumn ) const
+{
+  if( !ClampSpan( firstRow, lastRow, firstColumn, lastColumn ) ){
+    return -1;
+  }
+
+  const int     firstWord = firstColumn / WORD_BITS;
+  const int     lastWord  = lastColumn / WORD_BITS;
+  const Uint64  firstMask = BitRange( firstColumn - firstWord * WORD_BITS, firstWord == lastWord ?
+                                      lastColumn - firstWord * WORD_BITS : WORD_BITS - 1 );
+  const Uint64  lastMask  = BitRange( 0, lastColumn - lastWord * WORD_BITS );
+  for( int row = lastRow; row >= firstRow; --row ){
+    if( RowHasSolid( row, firstWord, lastWord, firstMask, lastMask ) ){
+      return row;
+    }
+  }
+  return -1;
+}
+
+/**********************************************************************************************************************/
+
+bool TileCollisionMap::RowHasSolid( int row, int firstWord, int lastWord, Uint64 firstMask, Uint64 lastMask ) const
+{
+  const Uint64 *bits = &mBits[static_cast<size_t>( row ) * mWordsPerRow];
+  if( firstWord == lastWord ){
+    return ( bits[firstWord] & firstMask ) != 0;
+  }
+
+  Uint64 found = ( bits[firstWord] & firstMask ) | ( bits[lastWord] & lastMask );
+  for( int word = firstWord + 1; word < lastWord; ++word ){
+    found |= bits[word];
+  }
+  return found != 0;
+}
+
+/**********************************************************************************************************************/
+
+bool TileCollisionMap::ClampSpan( int &firstRow, int &lastRow, int &firstColumn, int &lastColumn ) const
+{
+  firstRow    = SDL_max( firstRow, 0 );
+  lastRow     = SDL_min( lastRow, mHeight - 1 );
+  firstColumn = SDL_max( firstColumn, 0 );
+  lastColumn  = SDL_min( lastColumn, mWidth - 1 );
+  return firstRow <= lastRow && firstColumn <= lastColumn;
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::FirstTile( float start ) const
+{
+  // floor(start / size) is floor(floor(start) / size) for integer sizes, so the division is done on integers
+  int pixel = static_cast<int>( start );
+  pixel -= start < static_cast<float>( pixel ) ? 1 : 0;
+  return ToTile( pixel );
+}
+
+/**********************************************************************************************************************/
+
+int TileCollisionMap::LastTile( float start, float size ) const
+{
+  // The box covers [start, start + size): a side exactly on a tile border does not touch the next tile. This is
+  // ceil(end / size) - 1, which is floor((ceil(end) - 1) / size) for integer sizes
+  if( size <= 0.0f ){
+    return FirstTile( start );
+  }
+  const float end   = start + size;
+  int         pixel = static_cast<int>( end );
+  pixel += end > static_cast<float>( pixel ) ? 1 : 0;
+  return ToTile( pixel - 1 );
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,167 @@
+#ifndef TILECOLLISIONMAP_H
+#define TILECOLLISIONMAP_H
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+// Row bitsets
+#include <vector>
+
+/**
+Tile collision map class
+Solidity of a tile level packed one bit per tile, every row stored as 64-bit words. Moving a box sweeps one axis at a
+time and finds the first blocking tile of a whole row span with a mask and a bit scan, so the cost depends on the
+number of rows and words crossed instead of the number of tiles. Tiles outside the map are empty
+*/
+class TileCollisionMap
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+private:
+
+  static const int      WORD_BITS = 64;   ///< Tiles per word
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Outcome of a move
+  */
+  struct MoveResult
+  {
+    float   mX;       ///< Final position of the box
+    float   mY;
+    bool    mHitX;    ///< The horizontal movement was stopped by a tile
+    bool    mHitY;    ///< The vertical movement was stopped by a tile
+  };
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor. Every tile starts empty
+  @param width Tiles per row
+  @param height Rows
+  @param tileSize Size of a tile in pixels
+  */
+  TileCollisionMap( int width, int height, int tileSize );
+
+  /**
+  Sets the solidity of a tile. Ignored outside the map
+  */
+  void SetSolid( int tileX, int tileY, bool solid );
+
+  /**
+  Returns the solidity of a tile. False outside the map
+  */
+  bool IsSolid( int tileX, int tileY ) const;
+
+  /**
+  Checks whether a box in pixels touches a solid tile
+  @param x Left side of the box
+  @param y Top side of the box
+  @param w Width, the box covers [x, x + w)
+  @param h Height
+  */
+  bool Overlaps( float x, float y, float w, float h ) const;
+
+  /**
+  Moves a box by a displacement, horizontally first and then vertically, stopping each axis against the first solid
+  tile. Tiles the box already overlaps do not block it, so a box stuck in a wall can get out
+  @param x Left side of the box
+  @param y Top side of the box
+  @param w Width of the box
+  @param h Height of the box
+  @param dx Horizontal displacement in pixels
+  @param dy Vertical displacement in pixels
+  @return Final position and blocked axes
+  */
+  MoveResult Move( float x, float y, float w, float h, float dx, float dy ) const;
+
+  /**
+  Getters
+  */
+  inline int GetWidth( void ) const {
+    return mWidth;
+  }
+  inline int GetHeight( void ) const {
+    return mHeight;
+  }
+  inline int GetTileSize( void ) const {
+    return mTileSize;
+  }
+
+private:
+
+  /**
+  First or last column with a solid tile in a span of rows, between two columns. Bounds are included and clamped to
+  the map
+  @return Column of the tile or -1
+  */
+  int FindFirstColumn( int firstRow, int lastRow, int firstColumn, int lastColumn ) const;
+  int FindLastColumn( int firstRow, int lastRow, int firstColumn, int lastColumn ) const;
+
+  /**
+  First or last row with a solid tile in a span of columns, between two rows. Bounds are included and clamped to the
+  map
+  @return Row of the tile or -1
+  */
+  int FindFirstRow( int firstRow, int lastRow, int firstColumn, int lastColumn ) const;
+  int FindLastRow( int firstRow, int lastRow, int firstColumn, int lastColumn ) const;
+
+  /**
+  Checks whether a row has a solid tile in a column span already clamped to the map
+  @param firstMask Columns of the first word in the span
+  @param lastMask Columns of the last word in the span, words between are tested whole
+  */
+  bool RowHasSolid( int row, int firstWord, int lastWord, Uint64 firstMask, Uint64 lastMask ) const;
+
+  /**
+  Clamps a span of tiles to the map
+  @return False if nothing is left
+  */
+  bool ClampSpan( int &firstRow, int &lastRow, int &firstColumn, int &lastColumn ) const;
+
+  /**
+  Tile spans covered by a box on one axis, with [start, start + size) in pixels
+  */
+  int FirstTile( float start ) const;
+  int LastTile( float start, float size ) const;
+
+  /**
+  Tile containing a pixel, rounding down for negative pixels too
+  */
+  inline int ToTile( int pixel ) const {
+    if( mTileShift >= 0 ){
+      return pixel >> mTileShift;
+    }
+    return pixel >= 0 ? pixel / mTileSize : -( ( mTileSize - 1 - pixel ) / mTileSize );
+  }
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  std::vector<Uint64>   mBits;          ///< Solid tiles, row after row. Bit i of word w is column w * 64 + i
+  int                   mWidth;         ///< Tiles per row
+  int                   mHeight;        ///< Rows
+  int                   mWordsPerRow;   ///< Words per row, the last one is padded with empty tiles
+  int                   mTileSize;      ///< Tile size in pixels
+  int                   mTileShift;     ///< Log2 of the tile size, -1 if it is not a power of two
+};
+
+/**********************************************************************************************************************/
+
+#endif
@@ -0,0 +1,259 @@
+#include "TransformHierarchy.h"
+
+// Invalid node checks
+#include "AssertionManager.h"
+
+// Breadth-first sort
+#include <algorithm>
+
+// sin, cos
+#include <cmath>
+
+/**********************************************************************************************************************/
+
+const Uint32 TransformHierarchy::INVALID_TRANSFORM;
+const Uint32 TransformHierarchy::NO_PARENT;
+
+/**********************************************************************************************************************/
+
+TransformHierarchy::TransformHierarchy( void )
+  : mFirstDirty(0), mFrame(0), mLastUpdateCount(0), mOrderDirty(false)
+{
+}
+
+/**********************************************************************************************************************/
+
+TransformHierarchy::TransformId TransformHierarchy::CreateNode( TransformId parent, const Transform2D &local )
+{
+  AssertMessage( parent == INVALID_TRANSFORM || IsValid( parent ), "Creating a transform under an invalid parent" );
+
+  TransformId id;
+  if( !mFreeIds.empty() ){
+    id = mFreeIds.back();
+    mFreeIds.pop_back();
+  }
+  else{
+    id = static_cast<TransformId>( mIdToIndex.size() );
+    mIdToIndex.push_back( INVALID_TRANSFORM );
+  }
+
+  // Appending keeps parents before children, no reorder needed
+  const Uint32 index = static_cast<Uint32>( mLocal.size() );
+  mIdToIndex[id] = index;
+  mParent.push_back( parent == INVALID_TRANSFORM ? NO_PARENT : mIdToIndex[parent] );
+  mLocal.push_back( local );
+  mWorld.push_back( local );
+  mDirty.push_back( 0 );
+  mRemoved.push_back( 0 );
+  mUpdatedFrame.push_back( 0 );
+  mIndexToId.push_back( id );
+
+  MarkDirty( index );
+  return id;
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::DestroyNode( TransformId id )
+{
+  AssertMessage( IsValid( id ), "Destroying an invalid transform" );
+  if( !IsValid( id ) ){
+    return;
+  }
+
+  mRemoved[mIdToIndex[id]] = 1;
+  mOrderDirty = true;
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::SetParent( TransformId id, TransformId parent )
+{
+  AssertMessage( IsValid( id ), "Reparenting an invalid transform" );
+  AssertMessage( parent == INVALID_TRANSFORM || IsValid( parent ), "Reparenting under an invalid transform" );
+
+  const Uint32 index        = mIdToIndex[id];
+  const Uint32 parentIndex  = parent == INVALID_TRANSFORM ? NO_PARENT : mIdToIndex[parent];
+
+  // Reject cycles: the new parent must not be inside the subtree
+  for( Uint32 ancestor = parentIndex; ancestor != NO_PARENT; ancestor = mParent[ancestor] ){
+    AssertMessage( ancestor != index, "Transform parented to its own descendant" );
+    if( ancestor == index ){
+      return;
+    }
+  }
+
+  mParent[index] = parentIndex;
+  MarkDirty( index );
+
+  // A parent after its child breaks the linear pass
+  if( parentIndex != NO_PARENT && parentIndex > index ){
+    mOrderDirty = true;
+  }
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::SetLocal( TransformId id, const Transform2D &local )
+{
+  AssertMessage( IsValid( id ), "Setting an invalid transform" );
+
+  const Uint32 index = mIdToIndex[id];
+  if( mLocal[index] == local ){
+    return;
+  }
+  mLocal[index] = local;
+  MarkDirty( index );
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::SetLocalPosition( TransformId id, float x, float y )
+{
+  AssertMessage( IsValid( id ), "Setting an invalid transform" );
+
+  Transform2D local = mLocal[mIdToIndex[id]];
+  local.mX = x;
+  local.mY = y;
+  SetLocal( id, local );
+}
+
+/**********************************************************************************************************************/
+
+const TransformHierarchy::Transform2D &TransformHierarchy::GetLocal( TransformId id ) const
+{
+  AssertMessage( IsValid( id ), "Getting an invalid transform" );
+  return mLocal[mIdToIndex[id]];
+}
+
+/**********************************************************************************************************************/
+
+const TransformHierarchy::Transform2D &TransformHierarchy::GetWorld( TransformId id ) const
+{
+  AssertMessage( IsValid( id ), "Getting an invalid transform" );
+  return mWorld[mIdToIndex[id]];
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::Update( void )
+{
+  if( mOrderDirty ){
+    Rebuild();
+  }
+
+  ++mFrame;
+  mLastUpdateCount = 0;
+
+  // Nothing changed: static hierarchies cost nothing
+  const Uint32 count = static_cast<Uint32>( mLocal.size() );
+  if( mFirstDirty >= count ){
+    return;
+  }
+
+  // Parents come first, so a child sees whether its parent was recomputed in this same pass
+  for( Uint32 i = mFirstDirty; i < count; ++i ){
+    const Uint32 parent = mParent[i];
+    if( mDirty[i] || ( parent != NO_PARENT && mUpdatedFrame[parent] == mFrame ) ){
+      mWorld[i]         = parent == NO_PARENT ? mLocal[i] : Combine( mWorld[parent], mLocal[i] );
+      mDirty[i]         = 0;
+      mUpdatedFrame[i]  = mFrame;
+      ++mLastUpdateCount;
+    }
+  }
+  mFirstDirty = count;
+}
+
+/**********************************************************************************************************************/
+
+bool TransformHierarchy::IsValid( TransformId id ) const
+{
+  return id < mIdToIndex.size() && mIdToIndex[id] != INVALID_TRANSFORM && !mRemoved[mIdToIndex[id]];
+}
+
+/**********************************************************************************************************************/
+
+void TransformHierarchy::Rebuild( void )
+{
+  const Uint32 count    = static_cast<Uint32>( mLocal.size() );
+  const Uint32 REMOVED  = 0xFFFFFFFF;
+
+  // Depth plus one of every node (0 = not computed). Nodes under a destroyed node are destroyed too
+  std::vector<Uint32> depths( count, 0 );
+  std::vector<Uint32> chain;
+  for( Uint32 i = 0; i < count; ++i ){
+    chain.clear();
+    Uint32 node = i;
+    while( node != NO_PARENT && depths[node] == 0 ){
+      chain.push_back( node );
+      node = mParent[node];
+    }
+
+    Uint32 depth = node == NO_PARENT ? 0 : depths[node];
+    while( !chain.empty() ){
+      node  = chain.back();
+      chain.pop_back();
+      depth = ( depth == REMOVED || mRemoved[node] ) ? REMOVED : depth + 1;
+      depths[node] = depth;
+    }
+  }
+
+  // Breadth-first order: sort alive nodes by depth, keeping current order inside a level
+  std::vector<Uint32> order;
+  order.reserve( count );
+  for( Uint32 i = 0; i < count; ++i ){
+    if( depths[i] != REMOVED ){
+      order.push_back( i );
+    }
+    else{
+      mIdToIndex[mIndexToId[i]] = INVALID_TRANSFORM;
+      mFreeIds.push_back( mIndexToId[i] );
+    }
+  }
+  std::stable_sort( order.begin(), order.end(), [&depths]( Uint32 a, Uint32 b ){ return depths[a] < depths[b]; } );
+
+  std::vector<Uint32> newIndex( count, NO_PARENT );
+  for( Uint32 i = 0; i < order.size(); ++i ){
+    newIndex[order[i]] = i;
+  }
+
+  const Uint32              newCount = static_cast<Uint32>( order.size() );
+  std::vector<Uint32>       parent( newCount );
+  std::vector<Transform2D>  local( newCount );
+  std::vector<Transform2D>  world( newCount );
+  std::vector<TransformId>  indexToId( newCount );
+  for( Uint32 i = 0; i < newCount; ++i ){
+    const Uint32 old = order[i];
+    parent[i]     = mParent[old] == NO_PARENT ? NO_PARENT : newIndex[mParent[old]];
+    local[i]      = mLocal[old];
+    world[i]      = mWorld[old];
+    indexToId[i]  = mIndexToId[old];
+    mIdToIndex[indexToId[i]] = i;
+  }
+
+  mParent.swap( parent );
+  mLocal.swap( local );
+  mWorld.swap( world );
+  mIndexToId.swap( indexToId );
+  mDirty.assign( newCount, 1 );
+  mRemoved.assign( newCount, 0 );
+  mUpdatedFrame.assign( newCount, 0 );
+
+  mFirstDirty = 0;
+  mOrderDirty = false;
+}
+
+/**********************************************************************************************************************/
+
+TransformHierarchy::Transform2D TransformHierarchy::Combine( const Transform2D &parent, const Transform2D &local )
+{
+  const float c = cosf( parent.mRotation ) * parent.mScale;
+  const float s = sinf( parent.mRotation ) * parent.mScale;
+
+  return Transform2D( parent.mX + local.mX * c - local.mY * s,
+                      parent.mY + local.mX * s + local.mY * c,
+                      parent.mRotation + local.mRotation,
+                      parent.mScale * local.mScale );
+}
+
+/**********************************************************************************************************************/
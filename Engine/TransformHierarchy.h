@@ -0,0 +1,169 @@
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+// Fixed size integer types
+#include <SDL_stdinc.h>
+
+// Flat node arrays
+#include <vector>
+
+/**
+Transform hierarchy class
+Parent-relative 2D transforms stored as flat arrays sorted breadth first (every parent before its children). Changing a
+local transform only flags the node; Update then recomputes world transforms of flagged nodes and their descendants in
+one linear pass starting at the first flagged node, and returns immediately when nothing changed
+*/
+class TransformHierarchy
+{
+  /**********************************************************************************************************************/
+  // ASSOCIATIONS
+  /**********************************************************************************************************************/
+
+  /**********************************************************************************************************************/
+  // CONSTANTS
+  /**********************************************************************************************************************/
+
+public:
+
+  static const Uint32 INVALID_TRANSFORM = 0xFFFFFFFF;   ///< Id that never references a node
+
+  /**********************************************************************************************************************/
+  // TYPES
+  /**********************************************************************************************************************/
+
+  typedef Uint32 TransformId;
+
+  /**
+  2D transform: scale, then rotation, then translation
+  */
+  struct Transform2D
+  {
+    float mX;           ///< Translation x
+    float mY;           ///< Translation y
+    float mRotation;    ///< Rotation in radians
+    float mScale;       ///< Uniform scale
+
+    Transform2D( float x = 0.0f, float y = 0.0f, float rotation = 0.0f, float scale = 1.0f )
+      : mX(x), mY(y), mRotation(rotation), mScale(scale) { }
+
+    inline bool operator==( const Transform2D &other ) const {
+      return mX == other.mX && mY == other.mY && mRotation == other.mRotation && mScale == other.mScale;
+    }
+  };
+
+private:
+
+  static const Uint32 NO_PARENT = 0xFFFFFFFF;           ///< Parent index of root nodes
+
+  /**********************************************************************************************************************/
+  // METHODS
+  /**********************************************************************************************************************/
+
+public:
+
+  /**
+  Constructor
+  */
+  TransformHierarchy( void );
+
+  /**
+  Creates a node. Nodes are ordered on the next Update
+  @param parent Parent node or INVALID_TRANSFORM for a root
+  @param local Transform relative to the parent
+  @return Node id
+  */
+  TransformId CreateNode( TransformId parent = INVALID_TRANSFORM, const Transform2D &local = Transform2D() );
+
+  /**
+  Destroys a node and all its descendants. Descendant ids stay valid until the next Update
+  @param id Node to destroy
+  */
+  void DestroyNode( TransformId id );
+
+  /**
+  Moves a node (with its subtree) under another parent. The local transform is kept
+  @param id Node to move
+  @param parent New parent or INVALID_TRANSFORM to make it a root. Must not be a descendant of the node
+  */
+  void SetParent( TransformId id, TransformId parent );
+
+  /**
+  Sets the transform relative to the parent. Nodes set to their current value are not flagged
+  */
+  void SetLocal( TransformId id, const Transform2D &local );
+  void SetLocalPosition( TransformId id, float x, float y );
+
+  /**
+  Transform getters. World transforms are valid after Update
+  */
+  const Transform2D &GetLocal( TransformId id ) const;
+  const Transform2D &GetWorld( TransformId id ) const;
+
+  /**
+  Reorders the arrays if the structure changed and recomputes the world transform of changed subtrees
+  */
+  void Update( void );
+
+  /**
+  Returns true if the node exists
+  */
+  bool IsValid( TransformId id ) const;
+
+  /**
+  Getters. The node count includes destroyed nodes until the next Update
+  */
+  inline size_t GetNodeCount( void ) const {
+    return mLocal.size();
+  }
+  inline Uint32 GetLastUpdateCount( void ) const {
+    return mLastUpdateCount;
+  }
+
+private:
+
+  /**
+  Marks a node for recomputation
+  @param index Node index
+  */
+  inline void MarkDirty( Uint32 index ) {
+    mDirty[index] = 1;
+    if( index < mFirstDirty ){
+      mFirstDirty = index;
+    }
+  }
+
+  /**
+  Sorts nodes breadth first, drops destroyed subtrees and marks everything dirty
+  */
+  void Rebuild( void );
+
+  /**
+  Composes a parent world transform with a local transform
+  */
+  static Transform2D Combine( const Transform2D &parent, const Transform2D &local );
+
+  /**********************************************************************************************************************/
+  // ATTRIBUTES
+  /**********************************************************************************************************************/
+
+  // Node arrays, indexed by position in breadth-first order
+  std::vector<Uint32>       mParent;          ///< Parent index or NO_PARENT
+  std::vector<Transform2D>  mLocal;           ///< Transform relative to the parent
+  std::vector<Transform2D>  mWorld;           ///< Transform relative to the world
+  std::vector<Uint8>        mDirty;           ///< Local transform changed since last Update
+  std::vector<Uint8>        mRemoved;         ///< Destroyed, dropped on next rebuild
+  std::vector<Uint32>       mUpdatedFrame;    ///< Last Update that recomputed the world transform
+  std::vector<TransformId>  mIndexToId;       ///< Id of every node
+
+  std::vector<Uint32>       mIdToIndex;       ///< Node index by id
+  std::vector<TransformId>  mFreeIds;         ///< Ids released by destroyed nodes
+
+  Uint32                    mFirstDirty;      ///< Lowest dirty index or node count if none
+  Uint32                    mFrame;           ///< Update counter
+  Uint32                    mLastUpdateCount; ///< Nodes recomputed by the last Update
+  bool                      mOrderDirty;      ///< Arrays must be reordered
+};
+
+/**********************************************************************************************************************/
+
+#endif
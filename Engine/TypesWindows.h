@@ -0,0 +1,14 @@
+#ifndef TYPESWINDOWS_H
+#define TYPESWINDOWS_H
+
+// Keep windows.h as small as possible and avoid min/max macros clashing with std::min/std::max
+#ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+  #define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#endif
@@ -2,33 +2,94 @@
 #include <SDL.h>
 #include <stdio.h>
 #include <cstdio>  
-#include <map>  
 #include <string>
 
-
-class Sprite {
+// Engine
+#include "../Engine/ActionMap.h"
+#include "../Engine/AssertionManager.h"
+#include "../Engine/AssetArchive.h"
+#include "../Engine/AssetManager.h"
+#include "../Engine/AssetStreamer.h"
+#include "../Engine/Benchmark.h"
+#include "../Engine/ControllerManager.h"
+#include "../Engine/DeterministicSimulation.h"
+#include "../Engine/DynamicAABBTree.h"
+#include "../Engine/EntityWorld.h"
+#include "../Engine/InputRecorder.h"
+#include "../Engine/JobManager.h"
+#include "../Engine/LateLatch.h"
+#include "../Engine/LatencyTracker.h"
+#include "../Engine/Movement.h"
+#include "../Engine/ScaledSpriteCache.h"
+#include "../Engine/SystemScheduler.h"
+#include "../Engine/TextureManager.h"
+#include "../Engine/TransformHierarchy.h"
+
+
+// Steers every moving entity with the move actions. The movement systems integrate the velocity
+class HeroControlSystem : public System {
 
 public:
 
-  int x;
-  int y;
-  Sprite() : x(0), y(0) { }
+  HeroControlSystem(const ActionMap& actions, float speed)
+    : System("HeroControl"), mActions(actions), mSpeed(speed), mFixedSpeed(Fixed::FromFloat(speed)) {
+    Writes<Velocity, FixedVelocity>();
+    mLeft  = actions.FindAction("MoveLeft");
+    mRight = actions.FindAction("MoveRight");
+    mUp    = actions.FindAction("MoveUp");
+    mDown  = actions.FindAction("MoveDown");
+  }
+
+  void Update(EntityWorld& world, float /*deltaTime*/) {
+    // Keys give -1, 0 or 1, sticks anything in between
+    float dx = mActions.GetValue(mRight) - mActions.GetValue(mLeft);
+    float dy = mActions.GetValue(mDown) - mActions.GetValue(mUp);
+
+    float vx = dx * mSpeed;
+    float vy = dy * mSpeed;
+    world.ForEach<Velocity>([vx, vy](Velocity& velocity) {
+      velocity.x = vx;
+      velocity.y = vy;
+    });
+
+    // Deterministic entities read the values quantized by the action map, no float goes into the simulation
+    Fixed fixedDx = mActions.GetFixedValue(mRight) - mActions.GetFixedValue(mLeft);
+    Fixed fixedDy = mActions.GetFixedValue(mDown) - mActions.GetFixedValue(mUp);
+    Fixed fixedVx = fixedDx * mFixedSpeed;
+    Fixed fixedVy = fixedDy * mFixedSpeed;
+    world.ForEach<FixedVelocity>([fixedVx, fixedVy](FixedVelocity& velocity) {
+      velocity.x = fixedVx;
+      velocity.y = fixedVy;
+    });
+  }
+
+private:
 
+  const ActionMap&    mActions;
+  ActionMap::ActionId mLeft;
+  ActionMap::ActionId mRight;
+  ActionMap::ActionId mUp;
+  ActionMap::ActionId mDown;
+  float               mSpeed;
+  Fixed               mFixedSpeed;
 };
 
 class Game {
   // Constants
   static const int          DISPLAY_WIDTH = 480;
   static const int          DISPLAY_HEIGHT = 320;
-  static const int          HERO_SPEED = 2;
+  static const int          HERO_SIZE = 20;
+  static const int          SCRATCH_SIZE = 75;
+  static const int          CURSOR_SIZE = 9;
 
+  static const float        HERO_SPEED;
   static const float        UPDATE_INTERVAL;
 
   static const std::string  MEDIA_PATH;
 
 public:
 
-  Game();
+  Game(bool deterministic, Uint64 seed);
   ~Game();
   void Start();
   void Stop();
@@ -38,7 +99,18 @@ public:
   void FillRect(SDL_Rect* rc, int r, int g, int b);
 
   void Run();
-  void Update();
+  void Update(int elapsedMilliseconds);
+
+  // Input recording and headless replay, deterministic mode only
+  void Record(InputRecorder* recorder);
+  void Replay(InputRecorder& replay);
+  Uint32 GetChecksum() const;
+
+  // Samples the cursor again right before rendering. Off by default
+  void SetLateLatch(bool enabled);
+
+  // Packer tool: archives media files, given relative to the media folder
+  static bool Pack(const char* archivePath, int count, char** paths);
 
   // Time manager
   void FPSChanged(int fps);
@@ -47,21 +119,46 @@ public:
   void EventManagement();
 
   void OnQuit();
-  void OnKeyDown(SDL_Event* event);
-  void OnKeyUp(SDL_Event* event);
+  void Pick(int x, int y);
 
 private:
 
-  std::map<int, int>  mKeys; // No SDLK_LAST. SDL2 migration guide suggests std::map  
+  // Builds mActions before the systems that look actions up by name
+  static ActionMap& BindActions(ActionMap& actions);
+
+  ActionMap           mActions;
+  ActionMap::ActionId mPickAction;
+  ControllerManager   mControllers;  // Filtered controller events into mActions
+  LatencyTracker      mLatency;    // Input event to present, and frame times
+  LateLatch           mLateLatch;  // Render-time input, never seen by the simulation
+  int                 mCursorX;    // Cursor seen by the last Update
+  int                 mCursorY;
   int                 mRunning;
   SDL_Window         *mWindow;
   SDL_Renderer       *mRenderer;
-  Sprite              mHero;
+  EntityWorld         mWorld;
+  Entity              mHero;
+  SystemScheduler     mScheduler;
+  HeroControlSystem   mHeroControl;
+  MovementSystem      mMovement;
+
+  bool                    mDeterministic;  // Fixed ticks and fixed point hero, for replays and regression runs
+  DeterministicSimulation mSimulation;
+  FixedMovementSystem     mFixedMovement;
+  InputRecorder          *mRecorder;       // Records every tick when not NULL
+  InputRecorder          *mReplay;         // Replaces the input of every tick when not NULL
+
+  TransformHierarchy              mTransforms;
+  TransformHierarchy::TransformId mHeroTransform;
+  TransformHierarchy::TransformId mScratchTransforms[2]; // Children of the hero
+
+  DynamicAABBTree                 mPickTree;
+  ProxyId                         mPickProxies[3];       // Hero, then the scratch images
 
   
-  SDL_Surface        *mScreenSurface  = NULL;   // The surface contained by the window
-  SDL_Surface        *mScratchSurface = NULL;   // Surface to use
-  SDL_Texture        *mScratchTexture = NULL;   // Texture to use
+  SDL_Surface                *mScreenSurface  = NULL;                                // The surface contained by the window
+  TextureHandle               mScratchTexture;                                      // Texture to use (loaded asynchronously)
+  ScaledSpriteCache           mScaledSpriteCache;                                   // Pre-scaled copies for the surface path
 
 
 };
@@ -72,12 +169,43 @@ private:
 /*************************************************************************************/
 /*************************************************************************************/
 
+const float         Game::HERO_SPEED = 120.0f; // Pixels per second
 const float         Game::UPDATE_INTERVAL = 1000.0f / 60.0f;
 const std::string   Game::MEDIA_PATH = "../Media/";
 
-Game::Game() :
-  mRunning(0), mWindow(NULL), mRenderer(NULL)
+Game::Game(bool deterministic, Uint64 seed) :
+  mPickAction(BindActions(mActions).FindAction("Pick")), mControllers(mActions),
+  mCursorX(0), mCursorY(0), mRunning(0), mWindow(NULL), mRenderer(NULL),
+  mScheduler(mWorld), mHeroControl(mActions, HERO_SPEED),
+  mDeterministic(deterministic), mSimulation(seed), mFixedMovement(mSimulation.GetTickDuration()), mRecorder(NULL),
+  mReplay(NULL)
 {
+  if (mDeterministic) {
+    FixedPosition fixedPosition = { Fixed(), Fixed() };
+    FixedVelocity fixedVelocity = { Fixed(), Fixed() };
+    mHero = mWorld.CreateEntity(fixedPosition, fixedVelocity);
+  } else {
+    Position      position      = { 0.0f, 0.0f };
+    Velocity      velocity      = { 0.0f, 0.0f };
+    Acceleration  acceleration  = { 0.0f, 0.0f };
+    Damping       damping       = { 0.0f };
+    mHero = mWorld.CreateEntity(position, velocity, acceleration, damping);
+  }
+
+  mScheduler.AddSystem(&mHeroControl);
+  mScheduler.AddSystem(&mMovement);
+  mScheduler.AddSystem(&mFixedMovement);
+
+  // Scratch images follow the hero
+  mHeroTransform        = mTransforms.CreateNode();
+  mScratchTransforms[0] = mTransforms.CreateNode(mHeroTransform, TransformHierarchy::Transform2D(100.0f, 100.0f));
+  mScratchTransforms[1] = mTransforms.CreateNode(mHeroTransform, TransformHierarchy::Transform2D(200.0f, 200.0f));
+
+  // Pickable objects, user data is the index in mPickProxies. Rects are set by Update
+  SDL_Rect empty = { 0, 0, 0, 0 };
+  for (Uint64 i = 0; i < 3; ++i) {
+    mPickProxies[i] = mPickTree.CreateProxy(empty, i);
+  }
 }
 
 Game::~Game()
@@ -85,6 +213,35 @@ Game::~Game()
   Stop();
 }
 
+ActionMap& Game::BindActions(ActionMap& actions)
+{
+  // Gameplay only knows the action names. Rebinding means changing this table and compiling again
+  const ActionMap::ActionId left  = actions.AddAction("MoveLeft");
+  const ActionMap::ActionId right = actions.AddAction("MoveRight");
+  const ActionMap::ActionId up    = actions.AddAction("MoveUp");
+  const ActionMap::ActionId down  = actions.AddAction("MoveDown");
+  const ActionMap::ActionId pick  = actions.AddAction("Pick");
+
+  actions.BindKey(SDL_SCANCODE_LEFT, left);
+  actions.BindKey(SDL_SCANCODE_RIGHT, right);
+  actions.BindKey(SDL_SCANCODE_UP, up);
+  actions.BindKey(SDL_SCANCODE_DOWN, down);
+  actions.BindControllerButton(SDL_CONTROLLER_BUTTON_DPAD_LEFT, left);
+  actions.BindControllerButton(SDL_CONTROLLER_BUTTON_DPAD_RIGHT, right);
+  actions.BindControllerButton(SDL_CONTROLLER_BUTTON_DPAD_UP, up);
+  actions.BindControllerButton(SDL_CONTROLLER_BUTTON_DPAD_DOWN, down);
+  actions.BindControllerAxis(SDL_CONTROLLER_AXIS_LEFTX, false, left);
+  actions.BindControllerAxis(SDL_CONTROLLER_AXIS_LEFTX, true, right);
+  actions.BindControllerAxis(SDL_CONTROLLER_AXIS_LEFTY, false, up);
+  actions.BindControllerAxis(SDL_CONTROLLER_AXIS_LEFTY, true, down);
+
+  actions.BindMouseButton(SDL_BUTTON_LEFT, pick);
+  actions.BindControllerButton(SDL_CONTROLLER_BUTTON_A, pick);
+
+  actions.Compile();
+  return actions;
+}
+
 void Game::Start()
 {
   int flags = SDL_WINDOW_SHOWN;
@@ -102,17 +259,12 @@ void Game::Start()
     return;
   }
 
-  // Load BMP
-  mScratchSurface = SDL_LoadBMP( (Game::MEDIA_PATH + "Scratch.bmp").c_str() );
-  if (mScratchSurface == NULL)
-  {
-    return;
-  }
-
-  mScratchTexture = SDL_CreateTextureFromSurface(mRenderer, mScratchSurface);
-  if (mScratchTexture == NULL) {
-    return;
-  }
+  // Load BMP. Read on an I/O thread, decoded on a worker and uploaded by Draw, so the loop starts without waiting for
+  // it. The collision mask lets picking ignore the transparent pixels
+  TextureManager::GetInstance().SetUploadBudget(TextureManager::DEFAULT_UPLOAD_BUDGET);
+  AssetManager::GetInstance().SetMediaPath(MEDIA_PATH);
+  mScratchTexture = AssetManager::GetInstance().StreamTexture("Scratch.bmp", AssetManager::TEXTURE_FLAG_BUILD_MASK,
+                                                              AssetStreamer::PRIORITY_IMMEDIATE);
 
   mRunning = 1;
   Run();
@@ -120,53 +272,83 @@ void Game::Start()
 
 void Game::Draw()
 {
+  const TransformHierarchy::Transform2D &hero     = mTransforms.GetWorld(mHeroTransform);
+  const TransformHierarchy::Transform2D &scratch  = mTransforms.GetWorld(mScratchTransforms[0]);
+  const TransformHierarchy::Transform2D &scratch2 = mTransforms.GetWorld(mScratchTransforms[1]);
+
   // RENDER USING RENDERER
 
+  // Nearer assets stream first. Files read since last frame start decoding, then textures are created for the images
+  // decoded since last frame
+  AssetStreamer::GetInstance().SetFocus(hero.mX, hero.mY);
+  AssetStreamer::GetInstance().DispatchCompleted();
+  TextureManager::GetInstance().ProcessUploads(mRenderer);
+
+  // The cursor is only drawn, so it can use input newer than the Update
+  int cursorX = mCursorX;
+  int cursorY = mCursorY;
+  if (mLateLatch.Sample()) {
+    cursorX = mLateLatch.GetCursorX();
+    cursorY = mLateLatch.GetCursorY();
+  }
+
   // Clear screen  
   SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
   SDL_RenderClear(mRenderer);
 
   //// Render hero  
   SDL_Rect heroRect;
-  heroRect.x = mHero.x;
-  heroRect.y = mHero.y;
-  heroRect.w = 20;
-  heroRect.h = 20;
+  heroRect.x = static_cast<int>(hero.mX);
+  heroRect.y = static_cast<int>(hero.mY);
+  heroRect.w = HERO_SIZE;
+  heroRect.h = HERO_SIZE;
   FillRect(&heroRect, 255, 0, 0);
 
-  // Render Scratch
-  SDL_Rect scracthRect;
-  scracthRect.x = mHero.x + 100;
-  scracthRect.y = mHero.y + 100;
-  scracthRect.w = 75; // Scale
-  scracthRect.h = 75; // Scale
-  SDL_RenderCopy(mRenderer, mScratchTexture, NULL, &scracthRect);
-
-  SDL_Rect scracthRect2;
-  scracthRect2.x = mHero.x + 200;
-  scracthRect2.y = mHero.y + 200;
-  scracthRect2.w = 75; // Scale
-  scracthRect2.h = 75; // Scale  
-  SDL_RenderCopy(mRenderer, mScratchTexture, NULL, &scracthRect2);
+  // Render Scratch (skipped until its texture has been uploaded)
+  SDL_Texture *scratchTexture = AssetManager::GetInstance().GetTexture(mScratchTexture);
+  if (scratchTexture != NULL) {
+    SDL_Rect scracthRect;
+    scracthRect.x = static_cast<int>(scratch.mX);
+    scracthRect.y = static_cast<int>(scratch.mY);
+    scracthRect.w = SCRATCH_SIZE; // Scale
+    scracthRect.h = SCRATCH_SIZE; // Scale
+    SDL_RenderCopy(mRenderer, scratchTexture, NULL, &scracthRect);
+
+    SDL_Rect scracthRect2;
+    scracthRect2.x = static_cast<int>(scratch2.mX);
+    scracthRect2.y = static_cast<int>(scratch2.mY);
+    scracthRect2.w = SCRATCH_SIZE; // Scale
+    scracthRect2.h = SCRATCH_SIZE; // Scale  
+    SDL_RenderCopy(mRenderer, scratchTexture, NULL, &scracthRect2);
+  }
+
+  // Render cursor, a cross on the pick position
+  SDL_Rect cursorRect = { cursorX - CURSOR_SIZE / 2, cursorY, CURSOR_SIZE, 1 };
+  FillRect(&cursorRect, 0, 0, 0);
+  cursorRect = { cursorX, cursorY - CURSOR_SIZE / 2, 1, CURSOR_SIZE };
+  FillRect(&cursorRect, 0, 0, 0);
 
   SDL_RenderPresent(mRenderer);
+  mLatency.OnPresent();
 
 
 
-  // RENDER USING SURFACES
+  // RENDER USING SURFACES (needs LoadTextureAsync(..., true) to keep the surface)
+  // Scaled blits go through the cache: only the first one resamples, the rest are plain copies
+  //SDL_Surface *scratchSurface = AssetManager::GetInstance().GetSurface(mScratchTexture);
   //SDL_Rect scracthRect;
-  //scracthRect.x = mHero.x + 100;
-  //scracthRect.y = mHero.y + 100;
+  //scracthRect.x = static_cast<int>(scratch.mX);
+  //scracthRect.y = static_cast<int>(scratch.mY);
   //scracthRect.w = 75; // Scale
   //scracthRect.h = 75; // Scale
-  //SDL_BlitScaled(mScratchSurface, NULL, mScreenSurface, &scracthRect);
+  //mScaledSpriteCache.Blit(scratchSurface, mScreenSurface, &scracthRect);
 
   //SDL_Rect scracthRect2;
-  //scracthRect2.x = mHero.x + 200;
-  //scracthRect2.y = mHero.y + 200;
+  //scracthRect2.x = static_cast<int>(scratch2.mX);
+  //scracthRect2.y = static_cast<int>(scratch2.mY);
   //scracthRect2.w = 75; // Scale
   //scracthRect2.h = 75; // Scale
-  //SDL_BlitScaled(mScratchSurface, NULL, mScreenSurface, &scracthRect2);
+  //mScaledSpriteCache.Blit(scratchSurface, mScreenSurface, &scracthRect2);
     
   ////Update the surface
   //SDL_UpdateWindowSurface(mWindow);
@@ -175,6 +357,13 @@ void Game::Draw()
 
 void Game::Stop()
 {
+  // Finish in-flight decodes and free textures while the renderer is still alive
+  JobManager::GetInstance().WaitForAll();
+  mScaledSpriteCache.Clear();
+  AssetManager::GetInstance().ReleaseAll();
+  TextureManager::GetInstance().ReleaseAll();
+  mControllers.CloseAll();
+
   if (NULL != mRenderer) {
     SDL_DestroyRenderer(mRenderer);
     mRenderer = NULL;
@@ -198,6 +387,13 @@ void Game::FPSChanged(int fps)
   std::string title = std::string("Test - FPS = ") + std::to_string(fps);
 
   SDL_SetWindowTitle(mWindow, title.c_str());
+
+  // System timings of the last second (visible with debug log priority)
+  SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "%s", mScheduler.GetReport().c_str());
+  mScheduler.ResetStats();
+
+  // Latencies over the whole session: a second holds too few inputs for percentiles
+  SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "%s", mLatency.GetReport().c_str());
 }
 
 // Input manager
@@ -210,15 +406,17 @@ void Game::EventManagement()
     case SDL_QUIT:
       OnQuit();
       break;
-    case SDL_KEYDOWN:
-      OnKeyDown(&event);
-      break;
-    case SDL_KEYUP:
-      OnKeyUp(&event);
+    case SDL_WINDOWEVENT:
+      // Keys released while the window is not focused never send their key up
+      if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
+        mActions.Reset();
+      }
       break;
-    case SDL_MOUSEBUTTONDOWN:
-    case SDL_MOUSEBUTTONUP:
-    case SDL_MOUSEMOTION:
+    default:
+      // Controllers are opened as SDL reports them, those present at start included
+      if (mControllers.HandleEvent(event) || mActions.HandleEvent(event)) {
+        mLatency.OnInput(event.common.timestamp);
+      }
       break;
     }
   }
@@ -244,7 +442,7 @@ void Game::Run()
     if (timeElapsed >= UPDATE_INTERVAL) {
       past = now;
 
-      Update();
+      Update(timeElapsed);
       Draw();
 
       ++fps;
@@ -259,22 +457,112 @@ void Game::Run()
   }
 }
 
-void Game::Update()
+void Game::Update(int elapsedMilliseconds)
 {
-  if (mKeys[SDLK_LEFT]) {
-    mHero.x -= HERO_SPEED;
+  mLatency.OnUpdate();
+
+  // Actions of this frame, read by the systems and below. A replay sets them tick by tick instead
+  int cursorX = 0;
+  int cursorY = 0;
+  if (mReplay == NULL) {
+    mActions.Update();
+    SDL_GetMouseState(&cursorX, &cursorY);
+    mCursorX = cursorX;
+    mCursorY = cursorY;
+    if (mActions.WasPressed(mPickAction)) {
+      Pick(cursorX, cursorY);
+    }
   }
-  if (mKeys[SDLK_RIGHT]) {
-    mHero.x += HERO_SPEED;
+
+  if (mDeterministic) {
+    // Whole ticks only: the state depends on the number of ticks and the keys seen by each, never on frame timing
+    for (Uint32 ticks = mSimulation.Advance(elapsedMilliseconds); ticks > 0; --ticks) {
+      if (mReplay != NULL) {
+        if (!mReplay->Play(mActions, cursorX, cursorY)) {
+          mRunning = 0;
+          break;
+        }
+        if (mActions.WasPressed(mPickAction)) {
+          Pick(cursorX, cursorY);
+        }
+      } else if (mRecorder != NULL) {
+        mRecorder->Record(mActions, cursorX, cursorY);
+      }
+
+      mScheduler.Run(mSimulation.GetTickSeconds());
+      Uint32 checksum = mSimulation.EndTick(DeterministicSimulation::HashComponents<FixedPosition, FixedVelocity>(mWorld));
+      SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "Tick %u checksum %08X", mSimulation.GetTick(), checksum);
+    }
+
+    const FixedPosition &hero = *mWorld.GetComponent<FixedPosition>(mHero);
+    mTransforms.SetLocalPosition(mHeroTransform, hero.x.ToFloat(), hero.y.ToFloat());
+  } else {
+    // Real elapsed time: movement speed does not depend on the frame rate
+    mScheduler.Run(elapsedMilliseconds / 1000.0f);
+
+    const Position &hero = *mWorld.GetComponent<Position>(mHero);
+    mTransforms.SetLocalPosition(mHeroTransform, hero.x, hero.y);
   }
-  if (mKeys[SDLK_UP]) {
-    mHero.y -= HERO_SPEED;
+
+  // Only the subtrees that moved are recomputed
+  mTransforms.Update();
+
+  // Keep the picking tree on what Draw shows. Small moves stay inside the fat boxes and cost nothing
+  const TransformHierarchy::TransformId pickTransforms[3] = { mHeroTransform, mScratchTransforms[0], mScratchTransforms[1] };
+  for (int i = 0; i < 3; ++i) {
+    const TransformHierarchy::Transform2D &world = mTransforms.GetWorld(pickTransforms[i]);
+    const int size = i == 0 ? HERO_SIZE : SCRATCH_SIZE;
+    SDL_Rect rect = { static_cast<int>(world.mX), static_cast<int>(world.mY), size, size };
+    mPickTree.MoveProxy(mPickProxies[i], rect);
   }
-  if (mKeys[SDLK_DOWN]) {
-    mHero.y += HERO_SPEED;
+}
+
+void Game::Record(InputRecorder* recorder)
+{
+  mRecorder = recorder;
+  if (mRecorder != NULL) {
+    mRecorder->Begin(mSimulation.GetSeed(), mSimulation.GetTickRate(), mActions.GetActionCount());
   }
 }
 
+void Game::Replay(InputRecorder& replay)
+{
+  if (!mDeterministic || replay.GetTickRate() != mSimulation.GetTickRate()) {
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Replays need the deterministic mode at %u ticks per second",
+                 replay.GetTickRate());
+    return;
+  }
+
+  // No window and no waiting: every Update runs as many recorded ticks as Advance allows in one frame
+  mReplay = &replay;
+  mReplay->Rewind();
+  mRunning = 1;
+  Uint64 start = SDL_GetPerformanceCounter();
+  while (mRunning) {
+    Update(1000);
+  }
+  double milliseconds = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+  mReplay = NULL;
+
+  Uint32 checksum = GetChecksum();
+  SDL_Log("Replayed %u ticks in %.1f ms, checksum %08X %s", mSimulation.GetTick(), milliseconds, checksum,
+          checksum == replay.GetChecksum() ? "matches the recording" : "differs from the recording");
+}
+
+Uint32 Game::GetChecksum() const
+{
+  return mSimulation.GetTick() > 0 ? mSimulation.GetChecksums().back() : 0;
+}
+
+bool Game::Pack(const char* archivePath, int count, char** paths)
+{
+  return AssetArchive::Pack(archivePath, MEDIA_PATH, std::vector<std::string>(paths, paths + count));
+}
+
+void Game::SetLateLatch(bool enabled)
+{
+  mLateLatch.SetEnabled(enabled);
+}
 
 // Event or input
 void Game::OnQuit()
@@ -282,14 +570,24 @@ void Game::OnQuit()
   mRunning = 0;
 }
 
-// Input Manager
-void Game::OnKeyDown(SDL_Event* evt)
+void Game::Pick(int x, int y)
 {
-  mKeys[evt->key.keysym.sym] = 1;
-}
-void Game::OnKeyUp(SDL_Event* evt)
-{
-  mKeys[evt->key.keysym.sym] = 0;
+  static const char* PICK_NAMES[3] = { "Hero", "Scratch", "Scratch2" };
+
+  SDL_Rect cursor = { x, y, 1, 1 };
+  ProxyId picked[3];
+  Uint32 count = mPickTree.Query(cursor, picked, 3);
+  const CollisionMask *mask = AssetManager::GetInstance().GetCollisionMask(mScratchTexture);
+  for (Uint32 i = 0; i < count && i < 3; ++i) {
+    // Scratch images are drawn scaled, the cursor is mapped back to mask pixels
+    Uint64 index = mPickTree.GetUserData(picked[i]);
+    const SDL_Rect &rect = mPickTree.GetRect(picked[i]);
+    if (index > 0 && mask != NULL &&
+        !mask->TestPoint((cursor.x - rect.x) * mask->GetWidth() / rect.w, (cursor.y - rect.y) * mask->GetHeight() / rect.h)) {
+      continue;
+    }
+    SDL_Log("Picked %s", PICK_NAMES[index]);
+  }
 }
 
 
@@ -298,9 +596,83 @@ void Game::OnKeyUp(SDL_Event* evt)
 // MAIN
 int main(int argc, char** argv)
 {
-  Game game;
-  game.Start();
-  return 0;
+  AssertionManager::CreateSingleton();
+  JobManager::CreateSingleton();
+  TextureManager::CreateSingleton();
+  AssetStreamer::CreateSingleton();
+  AssetManager::CreateSingleton();
+
+  // -deterministic [seed] runs the simulation on fixed ticks in fixed point and logs a checksum per tick
+  // -record file plays deterministically and saves the input of every tick, -replay file runs it again without window
+  // -latelatch samples the cursor again right before rendering
+  // -archive file loads the media packed in the archive from it, -pack file media... builds the archive and exits
+  // -bench name runs a benchmark (or all of them) and exits
+  bool        deterministic = false;
+  Uint64      seed = 0;
+  const char* recordPath = NULL;
+  const char* replayPath = NULL;
+  bool        lateLatch = false;
+  const char* archivePath = NULL;
+  int         packIndex = 0;
+  const char* benchName = NULL;
+  for (int i = 1; i < argc && packIndex == 0; ++i) {
+    if (SDL_strcmp(argv[i], "-deterministic") == 0) {
+      deterministic = true;
+      if (i + 1 < argc && SDL_isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+        seed = SDL_strtoull(argv[++i], NULL, 10);
+      }
+    } else if (SDL_strcmp(argv[i], "-record") == 0 && i + 1 < argc) {
+      deterministic = true;
+      recordPath = argv[++i];
+    } else if (SDL_strcmp(argv[i], "-replay") == 0 && i + 1 < argc) {
+      replayPath = argv[++i];
+    } else if (SDL_strcmp(argv[i], "-latelatch") == 0) {
+      lateLatch = true;
+    } else if (SDL_strcmp(argv[i], "-archive") == 0 && i + 1 < argc) {
+      archivePath = argv[++i];
+    } else if (SDL_strcmp(argv[i], "-pack") == 0 && i + 1 < argc) {
+      packIndex = i + 1;
+    } else if (SDL_strcmp(argv[i], "-bench") == 0 && i + 1 < argc) {
+      benchName = argv[++i];
+    }
+  }
+
+  if (archivePath != NULL) {
+    AssetManager::GetInstance().MountArchive(archivePath);
+  }
+
+  int result = 0;
+  if (packIndex != 0) {
+    result = Game::Pack(argv[packIndex], argc - packIndex - 1, argv + packIndex + 1) ? 0 : 1;
+  } else if (benchName != NULL) {
+    result = Benchmark::Run(benchName) ? 0 : 1;
+  } else if (replayPath != NULL) {
+    InputRecorder replay;
+    if (replay.Load(replayPath)) {
+      Game game(true, replay.GetSeed());
+      game.Replay(replay);
+    }
+  } else {
+    InputRecorder recorder;
+    Game game(deterministic, seed);
+    game.SetLateLatch(lateLatch);
+    if (recordPath != NULL) {
+      game.Record(&recorder);
+    }
+    game.Start();
+    if (recordPath != NULL) {
+      recorder.End(game.GetChecksum());
+      recorder.Save(recordPath);
+      SDL_Log("Recorded %u ticks in %u bytes", recorder.GetTickCount(), static_cast<Uint32>(recorder.GetDataSize()));
+    }
+  }
+
+  AssetManager::DestroySingleton();
+  AssetStreamer::DestroySingleton();
+  TextureManager::DestroySingleton();
+  JobManager::DestroySingleton();
+  AssertionManager::DestroySingleton();
+  return result;
 }
 
 